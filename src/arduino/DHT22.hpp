@@ -3,7 +3,7 @@
  * @author Daniel Starke
  * @copyright Copyright 2019 Daniel Starke
  * @date 2019-08-07
- * @version 2023-04-11
+ * @version 2026-10-14
  *
  * DHT22 sensor library.
  */
@@ -23,6 +23,9 @@
  */
 class DHT22 {
 public:
+	/** Minimal time between two requests in milliseconds to get an up-to-date value. */
+	static const unsigned long INTERVAL_MIN = 1100;
+
 	/** Possible error codes returned when reading the value. */
 	enum ErrorCode {
 		SUCCESS      = 0,
@@ -155,6 +158,17 @@ public:
 				if ( ! DHT22::wait(pin, LOW, 50) ) return Result(static_cast<uint8_t>(TIMING_ERROR));
 			}
 		}
+		return DHT22::decode(buf);
+	}
+
+	/**
+	 * Checks and converts the given raw sensor data.
+	 *
+	 * @param[in,out] buf - 40 received data bits in transmission order
+	 * @return result
+	 * @remarks The returned values are only valid if Result::res == ErrorCode::SUCCESS.
+	 */
+	static Result decode(uint8_t * buf) {
 		/* mask valid bits to reduce bit errors */
 		buf[0] &= 0x7F;
 		/* check parity */
@@ -0,0 +1,188 @@
+/**
+ * @file DHTAsync.hpp
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Non-blocking DHT11/DHT22 sensor library.
+ */
+#ifndef __DHTASYNC_HPP__
+#define __DHTASYNC_HPP__
+
+#include "Arduino.h"
+
+
+/**
+ * Class for reading a DHT11 or DHT22 sensor module without blocking.
+ *
+ * A reading is started with start() and advanced with poll() until ready() returns true. The
+ * falling edges of the sensor signal are timestamped by an external interrupt and decoded into
+ * bits while the caller is free to do other work. The time between two falling edges is about
+ * 78 us for a 0 bit and 120 us for a 1 bit.
+ *
+ * @tparam DHT - sensor class (DHT11 or DHT22)
+ * @remarks Only one reading per sensor class can be in progress at a time. The sensor pin needs
+ * to support external interrupts (see digitalPinToInterrupt()).
+ */
+template <typename DHT>
+class DHTAsync {
+public:
+	/**
+	 * Starts reading the DHT sensor connected to the given pin. The start impulse is sent while
+	 * poll() is called.
+	 *
+	 * @param[in] pin - pin to read from
+	 * @param[in] impulse - impulse duration in milliseconds (optional)
+	 * @return true on success, false if a reading is in progress or the pin has no external interrupt
+	 */
+	static bool start(const uint8_t pin, const uint8_t impulse = 25) {
+		State & s = state();
+		const int irq = digitalPinToInterrupt(pin);
+		if (s.phase == START || s.phase == RECEIVE || irq == NOT_AN_INTERRUPT) return false;
+		s.pin = pin;
+		s.impulse = impulse;
+		s.phase = START;
+		s.since = millis();
+		pinMode(pin, OUTPUT);
+		digitalWrite(pin, LOW);
+		/* attached during the impulse to discard the edge caused by it */
+		attachInterrupt(irq, DHTAsync::onEdge, FALLING);
+		return true;
+	}
+
+	/**
+	 * Advances the reading in progress. The start impulse ends with the first call after its
+	 * duration elapsed.
+	 *
+	 * @return true if the result is ready, else false
+	 */
+	static bool poll() {
+		State & s = state();
+		switch (s.phase) {
+		case START:
+			if ((millis() - s.since) < static_cast<unsigned long>(s.impulse)) return false;
+			memset(const_cast<uint8_t *>(s.buf), 0, sizeof(s.buf));
+			s.edges = 0;
+			s.error = static_cast<uint8_t>(DHT::SUCCESS);
+			s.since = micros();
+			s.phase = RECEIVE;
+			/* release the bus to let the sensor respond */
+			digitalWrite(s.pin, HIGH);
+			pinMode(s.pin, INPUT);
+			return false;
+		case RECEIVE:
+			if (s.edges < EDGES && (micros() - s.since) < TIMEOUT) return false;
+			detachInterrupt(digitalPinToInterrupt(s.pin));
+			s.phase = DONE;
+			if (s.edges < 1) {
+				s.res = typename DHT::Result(static_cast<uint8_t>(DHT::TIMEOUT));
+			} else if (s.edges < 2) {
+				s.res = typename DHT::Result(static_cast<uint8_t>(DHT::NOT_READY));
+			} else if (s.error != static_cast<uint8_t>(DHT::SUCCESS)) {
+				s.res = typename DHT::Result(s.error);
+			} else if (s.edges < EDGES) {
+				s.res = typename DHT::Result(static_cast<uint8_t>(DHT::TIMING_ERROR));
+			} else {
+				uint8_t buf[5];
+				for (uint8_t i = 0; i < 5; i++) buf[i] = s.buf[i];
+				s.res = DHT::decode(buf);
+			}
+			return true;
+		case DONE:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	/**
+	 * Checks if the result of the last reading is ready.
+	 *
+	 * @return true if ready, else false
+	 */
+	static bool ready() {
+		return state().phase == DONE;
+	}
+
+	/**
+	 * Returns the result of the last reading. A new reading can be started afterwards.
+	 *
+	 * @return result
+	 * @remarks The returned values are only valid if Result::res == ErrorCode::SUCCESS.
+	 */
+	static typename DHT::Result result() {
+		State & s = state();
+		s.phase = IDLE;
+		return s.res;
+	}
+private:
+	/** Number of falling edges of a complete transmission (response and 40 bits). */
+	static const uint8_t EDGES = 42;
+
+	/** Time between two falling edges above which a 1 bit was received in microseconds. */
+	static const unsigned long BIT_THRESHOLD = 100;
+
+	/** Minimal time between two falling edges in microseconds. */
+	static const unsigned long EDGE_MIN = 60;
+
+	/** Maximal time between two falling edges in microseconds (response is about 160 us). */
+	static const unsigned long EDGE_MAX = 200;
+
+	/** Maximal duration of a transmission in microseconds (about 5 ms). */
+	static const unsigned long TIMEOUT = 10000;
+
+	/** Possible reading phases. */
+	enum Phase {
+		IDLE,
+		START,
+		RECEIVE,
+		DONE
+	};
+
+	/** Reading state shared with the interrupt handler. */
+	struct State {
+		volatile uint8_t phase; /**< Phase value */
+		volatile uint8_t edges; /**< number of received falling edges */
+		volatile uint8_t error; /**< first ErrorCode value detected by the interrupt handler */
+		volatile uint8_t buf[5]; /**< received data bits */
+		volatile unsigned long last; /**< micros() value of the last falling edge */
+		unsigned long since; /**< start time of the current phase */
+		uint8_t pin; /**< sensor pin */
+		uint8_t impulse; /**< impulse duration in milliseconds */
+		typename DHT::Result res; /**< result of the last reading */
+	};
+
+	/**
+	 * Returns the reading state.
+	 *
+	 * @return state
+	 */
+	static State & state() {
+		static State s;
+		return s;
+	}
+
+	/** Interrupt handler for each falling edge of the sensor signal. */
+	static void onEdge() {
+		State & s = state();
+		if (s.phase != RECEIVE || s.edges >= EDGES) return;
+		const unsigned long now = micros();
+		if (s.edges > 0) {
+			const unsigned long diff = now - s.last;
+			if ((diff < EDGE_MIN || diff > EDGE_MAX) && s.error == static_cast<uint8_t>(DHT::SUCCESS)) {
+				s.error = static_cast<uint8_t>((s.edges < 2) ? DHT::NOT_READY : DHT::TIMING_ERROR);
+			}
+			/* the edges 2 to 41 end the data bits */
+			if (s.edges >= 2 && diff > BIT_THRESHOLD) {
+				const uint8_t i = static_cast<uint8_t>(s.edges - 2);
+				s.buf[i >> 3] = static_cast<uint8_t>(s.buf[i >> 3] | (0x80 >> (i & 7)));
+			}
+		}
+		s.last = now;
+		s.edges = static_cast<uint8_t>(s.edges + 1);
+	}
+};
+
+
+#endif /* __DHTASYNC_HPP__ */
@@ -0,0 +1,117 @@
+/**
+ * @file DHTFast.hpp
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * DHT11/DHT22 sensor library for a pin known at compile time.
+ */
+#ifndef __DHTFAST_HPP__
+#define __DHTFAST_HPP__
+
+#include "Arduino.h"
+#include "DHT11.hpp"
+#include "DHT22.hpp"
+#include "FastPin.hpp"
+
+
+/**
+ * Class for reading a DHT11 or DHT22 sensor module connected to a fixed pin. The pin is accessed
+ * via its port register if known (see FastPin), which takes a fraction of a microsecond instead
+ * of several microseconds with digitalRead(). The sampling point of each bit is hit more
+ * precisely this way.
+ *
+ * @tparam DHT - sensor class (DHT11 or DHT22)
+ * @tparam PIN - pin connected to the sensor
+ * @remarks See DHT11 and DHT22 for the allowed request rate.
+ */
+template <typename DHT, uint8_t PIN>
+class DHTFast : public DHT {
+public:
+	typedef typename DHT::Result Result;
+	typedef FastPin<PIN> Pin;
+
+	/**
+	 * Initializes the pin to read DHT sensor data.
+	 */
+	static void begin() {
+		pinMode(PIN, OUTPUT);
+		digitalWrite(PIN, HIGH);
+	}
+
+	/**
+	 * Reads the last sensor value from the DHT sensor and stores the result in the given
+	 * variable.
+	 *
+	 * @param[out] out - result variable to set
+	 * @param[in] impulse - impulse duration in milliseconds (optional)
+	 * @return true on success, else false on error
+	 * @remarks The returned values are only valid if the function returns true.
+	 */
+	static bool read(Result & out, const uint8_t impulse = 25) {
+		out = read(impulse);
+		return out.res == DHT::SUCCESS;
+	}
+
+	/**
+	 * Reads the last sensor value from the DHT sensor and returns the result.
+	 *
+	 * @param[in] impulse - impulse duration in milliseconds (optional)
+	 * @return result
+	 * @remarks The returned values are only valid if Result::res == ErrorCode::SUCCESS.
+	 */
+	static Result read(const uint8_t impulse = 25) {
+		/* send start impulse */
+		Pin::output();
+		Pin::low();
+		delay(static_cast<unsigned long>(impulse));
+		Pin::high();
+		/* wait for response */
+		Pin::input();
+		if ( ! DHTFast::wait(false, 50) ) return Result(static_cast<uint8_t>(DHT::TIMEOUT));
+		/* read response */
+		delayMicroseconds(40);
+		if ( Pin::read() ) return Result(static_cast<uint8_t>(DHT::NOT_READY));
+		delayMicroseconds(60);
+		if ( ! Pin::read() ) return Result(static_cast<uint8_t>(DHT::NOT_READY));
+		if ( ! DHTFast::wait(false, 100) ) return Result(static_cast<uint8_t>(DHT::TIMING_ERROR));
+		/* read data */
+		uint8_t buf[5] = {0};
+		for (uint8_t i = 0; i < 40; i++) {
+			if ( ! DHTFast::wait(true, 80) ) return Result(static_cast<uint8_t>(DHT::TIMING_ERROR));
+			delayMicroseconds(35); /* wait longer than a 0 bit high signal */
+			if ( Pin::read() ) {
+				buf[i >> 3] = static_cast<uint8_t>(buf[i >> 3] | (0x80 >> (i & 7)));
+				if ( ! DHTFast::wait(false, 50) ) return Result(static_cast<uint8_t>(DHT::TIMING_ERROR));
+			}
+		}
+		return DHT::decode(buf);
+	}
+private:
+	/**
+	 * Helper function which waits for the pin to change its state as given or times out.
+	 *
+	 * @param[in] state - wait for this state
+	 * @param[in] timeout - timeout in microseconds
+	 * @return true if the state was reached, else false on timeout
+	 */
+	static bool wait(const bool state, const unsigned long timeout) {
+		const unsigned long start = micros();
+		while (Pin::read() != state) {
+			if ((micros() - start) >= timeout) return Pin::read() == state;
+		}
+		return true;
+	}
+};
+
+
+/** DHT11 sensor on a pin known at compile time. */
+template <uint8_t PIN> using DHT11T = DHTFast<DHT11, PIN>;
+
+
+/** DHT22 sensor on a pin known at compile time. */
+template <uint8_t PIN> using DHT22T = DHTFast<DHT22, PIN>;
+
+
+#endif /* __DHTFAST_HPP__ */
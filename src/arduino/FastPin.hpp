@@ -0,0 +1,158 @@
+/**
+ * @file FastPin.hpp
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Digital pin access with the port register and bit mask resolved at compile time.
+ */
+#ifndef __FASTPIN_HPP__
+#define __FASTPIN_HPP__
+
+#include "Arduino.h"
+#include "Meta.hpp"
+
+
+namespace {
+
+
+/**
+ * Maps an Arduino pin number to its port registers and bit mask. Derives from true_type for pins
+ * with direct port access, else from false_type.
+ *
+ * @tparam PIN - Arduino pin number
+ */
+template <uint8_t PIN>
+struct FastPinMap : false_type {};
+
+
+/**
+ * Defines the port registers and bit mask of the given Arduino pin.
+ *
+ * @param pin - Arduino pin number
+ * @param port - port letter (e.g. B for PINB, DDRB and PORTB)
+ * @param bit - bit number within the port
+ */
+#define FASTPIN_MAP(pin, port, bit) \
+	template <> \
+	struct FastPinMap<pin> : true_type { \
+		static const uint8_t mask = static_cast<uint8_t>(1 << (bit)); \
+		static volatile uint8_t & in() { return PIN##port; } \
+		static volatile uint8_t & ddr() { return DDR##port; } \
+		static volatile uint8_t & out() { return PORT##port; } \
+	};
+
+
+#if defined(__AVR_ATmega32U4__)
+/* Arduino Leonardo and Micro */
+FASTPIN_MAP( 0, D, 2)
+FASTPIN_MAP( 1, D, 3)
+FASTPIN_MAP( 2, D, 1)
+FASTPIN_MAP( 3, D, 0)
+FASTPIN_MAP( 4, D, 4)
+FASTPIN_MAP( 5, C, 6)
+FASTPIN_MAP( 6, D, 7)
+FASTPIN_MAP( 7, E, 6)
+FASTPIN_MAP( 8, B, 4)
+FASTPIN_MAP( 9, B, 5)
+FASTPIN_MAP(10, B, 6)
+FASTPIN_MAP(11, B, 7)
+FASTPIN_MAP(12, D, 6)
+FASTPIN_MAP(13, C, 7)
+FASTPIN_MAP(14, B, 3)
+FASTPIN_MAP(15, B, 1)
+FASTPIN_MAP(16, B, 2)
+FASTPIN_MAP(17, B, 0)
+FASTPIN_MAP(18, F, 7)
+FASTPIN_MAP(19, F, 6)
+FASTPIN_MAP(20, F, 5)
+FASTPIN_MAP(21, F, 4)
+FASTPIN_MAP(22, F, 1)
+FASTPIN_MAP(23, F, 0)
+#elif defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) || defined(__AVR_ATmega168__)
+/* Arduino Uno, Nano and Pro Mini */
+FASTPIN_MAP( 0, D, 0)
+FASTPIN_MAP( 1, D, 1)
+FASTPIN_MAP( 2, D, 2)
+FASTPIN_MAP( 3, D, 3)
+FASTPIN_MAP( 4, D, 4)
+FASTPIN_MAP( 5, D, 5)
+FASTPIN_MAP( 6, D, 6)
+FASTPIN_MAP( 7, D, 7)
+FASTPIN_MAP( 8, B, 0)
+FASTPIN_MAP( 9, B, 1)
+FASTPIN_MAP(10, B, 2)
+FASTPIN_MAP(11, B, 3)
+FASTPIN_MAP(12, B, 4)
+FASTPIN_MAP(13, B, 5)
+FASTPIN_MAP(14, C, 0)
+FASTPIN_MAP(15, C, 1)
+FASTPIN_MAP(16, C, 2)
+FASTPIN_MAP(17, C, 3)
+FASTPIN_MAP(18, C, 4)
+FASTPIN_MAP(19, C, 5)
+#endif
+
+
+#undef FASTPIN_MAP
+
+
+/**
+ * Digital pin access via the Arduino API for pins without known port registers.
+ *
+ * @tparam PIN - Arduino pin number
+ * @tparam Enable - selects the implementation
+ */
+template <uint8_t PIN, typename Enable = void>
+struct FastPin {
+	/** Configures the pin as input without pull-up. */
+	static void input() { pinMode(PIN, INPUT); }
+	/** Configures the pin as output. */
+	static void output() { pinMode(PIN, OUTPUT); }
+	/** Sets the output to high. */
+	static void high() { digitalWrite(PIN, HIGH); }
+	/** Sets the output to low. */
+	static void low() { digitalWrite(PIN, LOW); }
+	/**
+	 * Returns the input state.
+	 *
+	 * @return true if high, else false
+	 */
+	static bool read() { return digitalRead(PIN) != LOW; }
+};
+
+
+/**
+ * Digital pin access via the port registers. Each operation compiles to a single instruction.
+ *
+ * @tparam PIN - Arduino pin number
+ * @remarks The pin needs to be configured once with pinMode() to disable a timer output on it.
+ */
+template <uint8_t PIN>
+struct FastPin<PIN, typename enable_if<FastPinMap<PIN>::value>::type> {
+	typedef FastPinMap<PIN> Map;
+	/** Configures the pin as input without pull-up. */
+	static void input() {
+		Map::ddr() &= static_cast<uint8_t>(~Map::mask);
+		Map::out() &= static_cast<uint8_t>(~Map::mask);
+	}
+	/** Configures the pin as output. */
+	static void output() { Map::ddr() |= Map::mask; }
+	/** Sets the output to high. */
+	static void high() { Map::out() |= Map::mask; }
+	/** Sets the output to low. */
+	static void low() { Map::out() &= static_cast<uint8_t>(~Map::mask); }
+	/**
+	 * Returns the input state.
+	 *
+	 * @return true if high, else false
+	 */
+	static bool read() { return (Map::in() & Map::mask) != 0; }
+};
+
+
+} /* anonymous namespace */
+
+
+#endif /* __FASTPIN_HPP__ */
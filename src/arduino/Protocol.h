@@ -0,0 +1,158 @@
+/**
+ * @file Protocol.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Definitions of the binary protocol between thlog and the device firmware.
+ * This file is shared by the firmware (C++) and the host application (C99).
+ *
+ * The device sends the line PROTO_CMD_READY once the host connected and whenever it receives the
+ * same line from the host. The host waits for it before sending further commands.
+ *
+ * The host requests the binary protocol by sending the command line PROTO_CMD_BINARY. The device
+ * acknowledges this by sending the same line and starts to output binary frames instead of ASCII
+ * lines afterwards. The device falls back to ASCII lines if the host disconnects. Devices without
+ * support for the binary protocol ignore the command and keep sending ASCII lines.
+ *
+ * The host requests a different serial interface speed by sending PROTO_CMD_BAUD followed by a
+ * space and the speed in baud as decimal number. The device acknowledges this by sending the same
+ * line at the current speed and switches to the new speed afterwards. The device returns to its
+ * default speed if the host disconnects.
+ *
+ * The host requests on-device aggregation by sending PROTO_CMD_AGGREGATE followed by a space and
+ * the interval in seconds as decimal number. The device acknowledges this by sending the same line.
+ * Once the binary protocol is active, the device sends a single PROTO_FRAME_SUMMARY frame per
+ * interval instead of one PROTO_FRAME_SAMPLE frame per reading.
+ *
+ * A device with several sensors multiplexes their values into the same stream. Each ASCII line
+ * of sensor 1 and above starts with the channel number followed by a colon (e.g. "1:Err:3").
+ * Binary frames carry the channel number in the frame type byte (see PROTO_FRAME_TYPE and
+ * PROTO_FRAME_CHANNEL). Sensor 0 uses the lines and frames of single sensor devices.
+ *
+ * Each frame has the following layout (multi-byte values are little endian):
+ * | Offset | Size | Content
+ * |-------:|-----:|----------------------------------------------------------
+ * |      0 |    1 | PROTO_SYNC
+ * |      1 |    1 | frame type (PROTO_FRAME_*) and channel number
+ * |      2 |    1 | sequence number (incremented for each frame)
+ * |      3 |    1 | status code (0 on success, else the DHT error code)
+ * |      4 |  2*N | N fixed-point int16 values in tenths of their unit
+ * |  4+2*N |    1 | CRC-8 over the bytes from offset 1 to 3+2*N
+ */
+#ifndef __PROTOCOL_H__
+#define __PROTOCOL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/** Readiness signal of the device and command line sent by the host to request it. */
+#define PROTO_CMD_READY "#ready"
+
+
+/** Command line sent by the host to request the binary protocol. */
+#define PROTO_CMD_BINARY "#bin"
+
+
+/** Command line sent by the host to request the ASCII protocol. */
+#define PROTO_CMD_ASCII "#ascii"
+
+
+/** Command line prefix sent by the host to request a different serial interface speed. */
+#define PROTO_CMD_BAUD "#baud"
+
+
+/** Command line prefix sent by the host to request on-device aggregation. */
+#define PROTO_CMD_AGGREGATE "#aggr"
+
+
+/** Start byte of each frame. Never used within ASCII lines. */
+#define PROTO_SYNC 0xA5
+
+
+/** Sensor sample frame with temperature in 0.1 degrees Celsius and RH in 0.1 percent. */
+#define PROTO_FRAME_SAMPLE 0x01
+
+
+/** Number of values in a PROTO_FRAME_SAMPLE frame. */
+#define PROTO_SAMPLE_VALUES 2
+
+
+/**
+ * Summary frame of all readings within an aggregation interval. The status code is the last DHT
+ * error code if no reading succeeded. Temperature and RH values are given in the same fixed-point
+ * format as in PROTO_FRAME_SAMPLE.
+ */
+#define PROTO_FRAME_SUMMARY 0x02
+
+
+/** Value indices of a PROTO_FRAME_SUMMARY frame. */
+#define PROTO_SUMMARY_COUNT    0 /**< number of readings (unsigned) */
+#define PROTO_SUMMARY_TEMP     1 /**< mean temperature */
+#define PROTO_SUMMARY_TEMP_MIN 2 /**< minimal temperature */
+#define PROTO_SUMMARY_TEMP_MAX 3 /**< maximal temperature */
+#define PROTO_SUMMARY_RH       4 /**< mean relative humidity */
+#define PROTO_SUMMARY_RH_MIN   5 /**< minimal relative humidity */
+#define PROTO_SUMMARY_RH_MAX   6 /**< maximal relative humidity */
+#define PROTO_SUMMARY_TEMP_SD  7 /**< sample standard deviation of the temperature */
+#define PROTO_SUMMARY_RH_SD    8 /**< sample standard deviation of the relative humidity */
+
+
+/** Number of values in a PROTO_FRAME_SUMMARY frame. */
+#define PROTO_SUMMARY_VALUES 9
+
+
+/** Maximum number of sensor channels per device. */
+#define PROTO_MAX_CHANNELS 8
+
+
+/** Returns the frame type (PROTO_FRAME_*) of the given frame type byte. */
+#define PROTO_FRAME_TYPE(t) ((uint8_t)((t) & 0x0F))
+
+
+/** Returns the channel number of the given frame type byte. */
+#define PROTO_FRAME_CHANNEL(t) ((uint8_t)(((t) >> 4) & 0x07))
+
+
+/** Returns the frame type byte for the given frame type (PROTO_FRAME_*) and channel number. */
+#define PROTO_FRAME_TYPE_BYTE(t, c) ((uint8_t)((t) | (((c) & 0x07) << 4)))
+
+
+/** Maximal aggregation interval in seconds. */
+#define PROTO_AGGREGATE_MAX 86400
+
+
+/** Size of the header (sync, type, sequence number and status code) in bytes. */
+#define PROTO_HEADER_SIZE 4
+
+
+/** Maximum number of values in a single frame. */
+#define PROTO_MAX_VALUES 10
+
+
+/** Returns the total frame size in bytes for the given number of values. */
+#define PROTO_FRAME_SIZE(n) (PROTO_HEADER_SIZE + (2 * (n)) + 1)
+
+
+/**
+ * Calculates the CRC-8 (polynomial 0x07, initial value 0x00) of the given data.
+ *
+ * @param[in] buf - data buffer
+ * @param[in] len - number of bytes in buf
+ * @return CRC-8 value
+ */
+static inline uint8_t protoCrc8(const uint8_t * buf, const size_t len) {
+	uint8_t crc = 0;
+	for (size_t i = 0; i < len; i++) {
+		crc = (uint8_t)(crc ^ buf[i]);
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			crc = (uint8_t)(((crc & 0x80) != 0) ? ((crc << 1) ^ 0x07) : (crc << 1));
+		}
+	}
+	return crc;
+}
+
+
+#endif /* __PROTOCOL_H__ */
@@ -3,31 +3,47 @@
  * @author Daniel Starke
  * @copyright Copyright 2019 Daniel Starke
  * @date 2019-06-01
- * @version 2019-08-31
+ * @version 2026-10-14
  */
 /** Set to the used DHT type (11 or 22). */
 #define DHT_TYPE 11
 
 
-#if DHT_TYPE == 11
-#include "DHT11.hpp"
-#define DHT DHT11
-#elif DHT_TYPE == 22
-#include "DHT22.hpp"
-#define DHT DHT22
-#else
+#if DHT_TYPE != 11 && DHT_TYPE != 22
 #error Invalid value defined for DHT_TYPE.
 #endif
+#include "DHT11.hpp"
+#include "DHT22.hpp"
+#include "DHTAsync.hpp"
+#include "DHTFast.hpp"
 #include "Meta.hpp"
+#include "Protocol.h"
 #ifdef __AVR__
+#include <avr/interrupt.h>
 #include <avr/power.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
 #endif /* __AVR__ */
 
 
-/** Defines the PIN DHT11/DHT22 is connected to. */
+/**
+ * Defines the PIN DHT11/DHT22 is connected to. The sensor is read without blocking if the pin
+ * supports external interrupts (e.g. 0, 1, 2, 3 or 7 on the Leonardo), else with busy waiting
+ * via direct port access (see FastPin.hpp).
+ */
 #define DHT_PIN 20
 
 
+/**
+ * Lists the connected sensors as DHT_SENSOR(type, pin) entries with the DHT type 11 or 22. The
+ * entries are separated by commas and the channel number of each sensor equals its position in
+ * the list. Each sensor is read as described for DHT_PIN. Sensors of the same type can share
+ * their pin only if they are never read in parallel, which is guaranteed by the read schedule.
+ * Example: DHT_SENSOR(22, 2), DHT_SENSOR(22, 3), DHT_SENSOR(11, 20)
+ */
+#define DHT_SENSORS DHT_SENSOR(DHT_TYPE, DHT_PIN)
+
+
 /** Defines the 1st order calibration value for temperature (max resolution is 0.1f). */
 #define DHT_TEMP_CAL 0.0f
 
@@ -36,14 +52,178 @@
 #define DHT_RH_CAL 0.0f
 
 
-/** Update interval in milliseconds. Should be greater than or equal 1100. */
+/**
+ * Update interval in milliseconds. Should be greater than or equal 1100. The sensors are read one
+ * after another with an equal distance within this interval.
+ */
 #define UPDATE_INTERVAL 2000UL
 
 
+/** Default serial interface speed in baud. Needs to match the thlog option --baud. */
+#define SERIAL_SPEED 9600UL
+
+
+/** Serial interface framing. Needs to match the thlog option --framing. */
+#define SERIAL_FRAMING SERIAL_8N1
+
+
+/** Lowest serial interface speed in baud which can be requested by the host. */
+#define SERIAL_SPEED_MIN 1200UL
+
+
+/** Highest serial interface speed in baud which can be requested by the host. */
+#define SERIAL_SPEED_MAX 2000000UL
+
+
+/**
+ * Defines how to wait between two sensor readings:
+ * 0 - busy waiting
+ * 1 - idle sleep; the CPU stops until the next interrupt (e.g. timer tick, USB or serial data)
+ * 2 - like 1, but power-down sleep with watchdog wakeups while on-device aggregation is active
+ *     on devices without native USB; serial data received during power-down sleep is lost
+ * Only AVR devices support sleep modes. Native USB needs to stay alive, which prevents the
+ * power-down sleep on these devices (e.g. Leonardo and Micro).
+ */
+#define SLEEP_MODE 1
+
+
+/** Maximum length of a command line received from the host. */
+#define COMMAND_SIZE 16
+
+
 /** Last update time value of millis(). */
 unsigned long last;
 
 
+/** Command line received from the host. */
+char command[COMMAND_SIZE];
+
+
+/** Number of characters in command. */
+uint8_t commandLen;
+
+
+/** True if binary frames are sent instead of ASCII lines. */
+bool binaryMode;
+
+
+/** Sequence number of the next binary frame. */
+uint8_t sequence;
+
+
+/** Current serial interface speed in baud. */
+unsigned long serialSpeed;
+
+
+/** True if the host was connected during the last loop. */
+bool hostConnected;
+
+
+/** True if a non-blocking sensor reading is in progress. */
+bool reading;
+
+
+/** Channel number of the sensor which is read without blocking. */
+uint8_t readChannel;
+
+
+/** Channel number of the next sensor to read. */
+uint8_t nextChannel;
+
+
+/** Aggregation interval in milliseconds or 0 to send each reading. */
+unsigned long aggrInterval;
+
+
+/** Start time value of millis() of the current aggregation interval. */
+unsigned long aggrStart;
+
+
+/** Aggregated readings of the current interval. */
+struct Summary {
+	int32_t tempSum; /**< sum of all temperature values */
+	int32_t rhSum; /**< sum of all RH values */
+	int64_t tempSqSum; /**< sum of all squared temperature values */
+	int64_t rhSqSum; /**< sum of all squared RH values */
+	int16_t tempMin; /**< minimal temperature value */
+	int16_t tempMax; /**< maximal temperature value */
+	int16_t rhMin; /**< minimal RH value */
+	int16_t rhMax; /**< maximal RH value */
+	uint16_t count; /**< number of readings */
+	uint8_t lastError; /**< last DHT error code */
+};
+
+
+/** Sensor reading independent of the DHT type. */
+struct Reading {
+	uint8_t res; /**< DHT error code (0 on success) */
+	float temp; /**< temperature in degrees Celsius */
+	float rh; /**< relative humidity in percent */
+};
+
+
+/** Functions to read a single sensor. */
+struct Sensor {
+	void (* begin)(void); /**< initializes the sensor pin */
+	bool (* start)(void); /**< starts a non-blocking reading; returns false if not possible */
+	bool (* poll)(Reading & out); /**< advances the non-blocking reading; returns true once out is set */
+	void (* read)(Reading & out); /**< reads the sensor with busy waiting */
+};
+
+
+/**
+ * Implements the Sensor functions for the given DHT type and pin.
+ *
+ * @tparam TYPE - DHT type (11 or 22)
+ * @tparam PIN - pin connected to the sensor
+ */
+template <uint8_t TYPE, uint8_t PIN>
+struct SensorImpl {
+	static_assert(TYPE == 11 || TYPE == 22, "Invalid DHT type in DHT_SENSORS.");
+	typedef typename conditional<TYPE == 22, DHT22, DHT11>::type DHT;
+	static_assert(UPDATE_INTERVAL >= DHT::INTERVAL_MIN, "UPDATE_INTERVAL is too short for the sensor type.");
+
+	static void begin(void) {
+		DHTFast<DHT, PIN>::begin();
+	}
+
+	static bool start(void) {
+		return DHTAsync<DHT>::start(PIN);
+	}
+
+	static bool poll(Reading & out) {
+		if ( ! DHTAsync<DHT>::poll() ) return false;
+		convert(out, DHTAsync<DHT>::result());
+		return true;
+	}
+
+	static void read(Reading & out) {
+		convert(out, DHTFast<DHT, PIN>::read());
+	}
+
+	static void convert(Reading & out, const typename DHT::Result & val) {
+		out.res = val.res;
+		out.temp = (val.res == DHT::SUCCESS) ? val.getTemp() : 0.0f;
+		out.rh = (val.res == DHT::SUCCESS) ? val.getRH() : 0.0f;
+	}
+};
+
+
+#define DHT_SENSOR(type, pin) {SensorImpl<type, pin>::begin, SensorImpl<type, pin>::start, SensorImpl<type, pin>::poll, SensorImpl<type, pin>::read}
+/** Connected sensors in channel order. */
+const Sensor sensors[] = {DHT_SENSORS};
+#undef DHT_SENSOR
+
+
+/** Number of connected sensors. */
+#define SENSOR_COUNT static_cast<uint8_t>(sizeof(sensors) / sizeof(*sensors))
+static_assert((sizeof(sensors) / sizeof(*sensors)) <= PROTO_MAX_CHANNELS, "Too many sensors in DHT_SENSORS.");
+
+
+/** Aggregated readings of the current interval for each sensor. */
+Summary summary[sizeof(sensors) / sizeof(*sensors)];
+
+
 DEF_HAS_MEMBER(dtr)
 DEF_HAS_MEMBER(getDTR)
 template <typename T> typename enable_if<!has_member_dtr<T>::value, bool>::type serialDtr(T & ser) { return bool(ser); }
@@ -79,6 +259,316 @@ static float correctRH(const float RH, const float T0, const float T1) {
 }
 
 
+/**
+ * Converts the given value to a fixed-point value in tenths of its unit.
+ *
+ * @param[in] val - value to convert
+ * @return rounded fixed-point value
+ */
+static int16_t toFixed(const float val) {
+	return static_cast<int16_t>((val < 0.0f) ? ((val * 10.0f) - 0.5f) : ((val * 10.0f) + 0.5f));
+}
+
+
+/**
+ * Sends a binary frame with the given content to the host.
+ *
+ * @param[in] type - frame type byte (see PROTO_FRAME_TYPE_BYTE())
+ * @param[in] status - status code
+ * @param[in] values - fixed-point values
+ * @param[in] count - number of values
+ */
+static void sendFrame(const uint8_t type, const uint8_t status, const int16_t * values, const uint8_t count) {
+	uint8_t frame[PROTO_FRAME_SIZE(PROTO_MAX_VALUES)];
+	uint8_t len = 0;
+	frame[len++] = PROTO_SYNC;
+	frame[len++] = type;
+	frame[len++] = sequence++;
+	frame[len++] = status;
+	for (uint8_t i = 0; i < count; i++) {
+		const uint16_t val = static_cast<uint16_t>(values[i]);
+		frame[len++] = static_cast<uint8_t>(val & 0xFF);
+		frame[len++] = static_cast<uint8_t>(val >> 8);
+	}
+	frame[len] = protoCrc8(frame + 1, static_cast<size_t>(len - 1));
+	len++;
+	Serial.write(frame, len);
+}
+
+
+/**
+ * Divides the given sum by the passed count with rounding to the nearest integer.
+ *
+ * @param[in] sum - sum of fixed-point values
+ * @param[in] count - number of values (greater than zero)
+ * @return rounded mean value
+ */
+static int16_t roundedMean(const int32_t sum, const uint16_t count) {
+	const int32_t half = static_cast<int32_t>(count / 2);
+	return static_cast<int16_t>(((sum < 0) ? (sum - half) : (sum + half)) / static_cast<int32_t>(count));
+}
+
+
+/**
+ * Returns the sample standard deviation from the given sums with rounding to the nearest integer.
+ *
+ * @param[in] sum - sum of fixed-point values
+ * @param[in] sqSum - sum of squared fixed-point values
+ * @param[in] count - number of values (greater than zero)
+ * @return rounded standard deviation
+ */
+static int16_t roundedSd(const int32_t sum, const int64_t sqSum, const uint16_t count) {
+	if (count < 2) return 0;
+	const float n = static_cast<float>(count);
+	const float mean = static_cast<float>(sum) / n;
+	const float var = (static_cast<float>(sqSum) - (mean * static_cast<float>(sum))) / (n - 1.0f);
+	return (var > 0.0f) ? static_cast<int16_t>(sqrtf(var) + 0.5f) : 0;
+}
+
+
+/** Starts a new aggregation interval. */
+static void resetSummary(void) {
+	memset(summary, 0, sizeof(summary));
+	aggrStart = millis();
+}
+
+
+/**
+ * Adds the given reading to the current aggregation interval of the passed sensor.
+ *
+ * @param[in,out] sum - summary of the sensor
+ * @param[in] temp - temperature as fixed-point value
+ * @param[in] rh - RH as fixed-point value
+ */
+static void addSummary(Summary & sum, const int16_t temp, const int16_t rh) {
+	if (sum.count >= 0xFFFF) return;
+	if (sum.count == 0 || temp < sum.tempMin) sum.tempMin = temp;
+	if (sum.count == 0 || temp > sum.tempMax) sum.tempMax = temp;
+	if (sum.count == 0 || rh < sum.rhMin) sum.rhMin = rh;
+	if (sum.count == 0 || rh > sum.rhMax) sum.rhMax = rh;
+	sum.tempSum += temp;
+	sum.rhSum += rh;
+	sum.tempSqSum += static_cast<int32_t>(temp) * temp;
+	sum.rhSqSum += static_cast<int32_t>(rh) * rh;
+	sum.count++;
+}
+
+
+/** Sends the summary frames of the current aggregation interval and starts the next one. */
+static void sendSummary(void) {
+	for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+		const Summary & sum = summary[i];
+		int16_t values[PROTO_SUMMARY_VALUES] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+		uint8_t status = 0;
+		if (sum.count > 0) {
+			values[PROTO_SUMMARY_COUNT]    = static_cast<int16_t>(sum.count);
+			values[PROTO_SUMMARY_TEMP]     = roundedMean(sum.tempSum, sum.count);
+			values[PROTO_SUMMARY_TEMP_MIN] = sum.tempMin;
+			values[PROTO_SUMMARY_TEMP_MAX] = sum.tempMax;
+			values[PROTO_SUMMARY_RH]       = roundedMean(sum.rhSum, sum.count);
+			values[PROTO_SUMMARY_RH_MIN]   = sum.rhMin;
+			values[PROTO_SUMMARY_RH_MAX]   = sum.rhMax;
+			values[PROTO_SUMMARY_TEMP_SD]  = roundedSd(sum.tempSum, sum.tempSqSum, sum.count);
+			values[PROTO_SUMMARY_RH_SD]    = roundedSd(sum.rhSum, sum.rhSqSum, sum.count);
+		} else {
+			status = sum.lastError;
+		}
+		sendFrame(PROTO_FRAME_TYPE_BYTE(PROTO_FRAME_SUMMARY, i), status, values, PROTO_SUMMARY_VALUES);
+	}
+	unsigned long start = aggrStart + aggrInterval;
+	/* skip missed intervals */
+	if ((millis() - start) >= aggrInterval) start = millis();
+	memset(summary, 0, sizeof(summary));
+	aggrStart = start;
+}
+
+
+#if defined(__AVR__) && SLEEP_MODE > 1 && !defined(USBCON)
+#define SLEEP_POWER_DOWN
+/* incremented by the timer 0 interrupt of the Arduino core for millis() */
+extern "C" volatile unsigned long timer0_millis;
+
+
+/* the watchdog interrupt only wakes up the CPU */
+EMPTY_INTERRUPT(WDT_vect)
+
+
+/**
+ * Stops all clocks for the longest watchdog period (16 ms to 8 s) not exceeding the given time.
+ * The elapsed time is added to millis() as timer 0 is stopped during power-down sleep.
+ *
+ * @param[in] ms - maximal sleep time in milliseconds (at least 16)
+ */
+static void powerDown(const unsigned long ms) {
+	uint8_t wdp = 0;
+	unsigned long period = 16;
+	while (wdp < 9 && (period * 2) <= ms) {
+		wdp++;
+		period *= 2;
+	}
+	/* the serial interface stops with its clock */
+	Serial.flush();
+	cli();
+	wdt_reset();
+	MCUSR = static_cast<uint8_t>(MCUSR & ~_BV(WDRF));
+	WDTCSR = static_cast<uint8_t>(_BV(WDCE) | _BV(WDE));
+	WDTCSR = static_cast<uint8_t>(_BV(WDIE) | (wdp & 0x07) | (((wdp & 0x08) != 0) ? _BV(WDP3) : 0));
+	set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+	sleep_enable();
+	sei();
+	sleep_cpu();
+	sleep_disable();
+	wdt_disable();
+	cli();
+	timer0_millis += period;
+	sei();
+}
+#endif /* SLEEP_POWER_DOWN */
+
+
+/**
+ * Waits with reduced power consumption according to SLEEP_MODE. The function returns after at
+ * most the given time but may return earlier.
+ *
+ * @param[in] ms - time until the next scheduled operation in milliseconds
+ */
+static void waitFor(const unsigned long ms) {
+#if defined(__AVR__) && SLEEP_MODE > 0
+#ifdef SLEEP_POWER_DOWN
+	/* no output and no timing critical reading is expected until the next deadline */
+	if (ms >= 16 && binaryMode && aggrInterval > 0 && ! reading) {
+		powerDown(ms);
+		return;
+	}
+#endif /* SLEEP_POWER_DOWN */
+	(void)ms;
+	/* the timer 0 interrupt of millis() wakes up the CPU at least once per millisecond */
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	sleep_enable();
+	sleep_cpu();
+	sleep_disable();
+#else /* no sleep mode */
+	(void)ms;
+	delay(1);
+#endif
+}
+
+
+/**
+ * Changes the serial interface speed.
+ *
+ * @param[in] speed - new speed in baud
+ */
+static void setSpeed(const unsigned long speed) {
+	if (speed == serialSpeed) return;
+	Serial.end();
+	Serial.begin(speed, SERIAL_FRAMING);
+	serialSpeed = speed;
+}
+
+
+/**
+ * Executes the given command line received from the host. Unknown commands are ignored.
+ *
+ * @param[in] cmd - null-terminated command line
+ */
+static void executeCommand(const char * cmd) {
+	static const size_t baudLen = sizeof(PROTO_CMD_BAUD) - 1;
+	static const size_t aggrLen = sizeof(PROTO_CMD_AGGREGATE) - 1;
+	if (strncmp(cmd, PROTO_CMD_BAUD, baudLen) == 0 && cmd[baudLen] == ' ') {
+		char * end;
+		const unsigned long speed = strtoul(cmd + baudLen + 1, &end, 10);
+		if (*end != 0 || speed < SERIAL_SPEED_MIN || speed > SERIAL_SPEED_MAX) return;
+		/* acknowledge at the current speed before switching */
+		Serial.println(cmd);
+		Serial.flush();
+		setSpeed(speed);
+	} else if (strncmp(cmd, PROTO_CMD_AGGREGATE, aggrLen) == 0 && cmd[aggrLen] == ' ') {
+		char * end;
+		const unsigned long interval = strtoul(cmd + aggrLen + 1, &end, 10);
+		if (*end != 0 || interval > PROTO_AGGREGATE_MAX) return;
+		Serial.println(cmd);
+		aggrInterval = interval * 1000UL;
+		resetSummary();
+	} else if (strcmp(cmd, PROTO_CMD_READY) == 0) {
+		Serial.println(F(PROTO_CMD_READY));
+	} else if (strcmp(cmd, PROTO_CMD_BINARY) == 0) {
+		/* acknowledge with the last ASCII line */
+		Serial.println(F(PROTO_CMD_BINARY));
+		binaryMode = true;
+		sequence = 0;
+		resetSummary();
+	} else if (strcmp(cmd, PROTO_CMD_ASCII) == 0) {
+		binaryMode = false;
+	}
+}
+
+
+/** Reads and executes command lines received from the host. */
+static void handleCommands(void) {
+	while (Serial.available() > 0) {
+		const int c = Serial.read();
+		if (c == '\r' || c == '\n') {
+			if (commandLen > 0 && commandLen < COMMAND_SIZE) {
+				command[commandLen] = 0;
+				executeCommand(command);
+			}
+			commandLen = 0;
+		} else if (commandLen < COMMAND_SIZE) {
+			/* a too long command line is discarded */
+			command[commandLen++] = static_cast<char>(c);
+		}
+	}
+}
+
+
+/**
+ * Sends the given sensor reading to the host.
+ *
+ * @param[in] channel - channel number of the sensor
+ * @param[in] val - sensor reading
+ */
+static void sendReading(const uint8_t channel, const Reading & val) {
+	if ( ! isSerialConnected(Serial) ) return;
+	if ( binaryMode ) {
+		int16_t values[PROTO_SAMPLE_VALUES] = {0, 0};
+		if (val.res == 0) {
+			const float temp = val.temp + DHT_TEMP_CAL;
+			values[0] = toFixed(temp);
+			values[1] = toFixed(correctRH(val.rh, val.temp, temp) + DHT_RH_CAL);
+		}
+		if (aggrInterval > 0) {
+			/* aggregate on the device and send a summary once per interval */
+			if (val.res == 0) {
+				addSummary(summary[channel], values[0], values[1]);
+			} else {
+				summary[channel].lastError = val.res;
+			}
+		} else {
+			sendFrame(PROTO_FRAME_TYPE_BYTE(PROTO_FRAME_SAMPLE, channel), val.res, values, PROTO_SAMPLE_VALUES);
+		}
+		return;
+	}
+	if (channel > 0) {
+		Serial.print(channel, DEC);
+		Serial.print(':');
+	}
+	if (val.res == 0) {
+		const float temp = val.temp + DHT_TEMP_CAL;
+		const float rh   = correctRH(val.rh, val.temp, temp) + DHT_RH_CAL;
+		const float sum  = temp + rh; /* checksum */
+		Serial.print(temp, 1);
+		Serial.print('\t');
+		Serial.print(rh, 1);
+		Serial.print('\t');
+		Serial.println(sum, 1);
+	} else {
+		Serial.print(F("Err:"));
+		Serial.println(val.res, DEC);
+	}
+}
+
+
 /** Setup environment. */
 void setup(void) {
 #ifdef __AVR__
@@ -98,45 +588,80 @@ void setup(void) {
 #ifdef LED_BUILTIN_TX
 	pinMode(LED_BUILTIN_TX, INPUT);
 #endif /* LED_BUILTIN_TX */
-	DHT::begin(DHT_PIN);
-	Serial.begin(9600);
+	for (uint8_t i = 0; i < SENSOR_COUNT; i++) sensors[i].begin();
+	Serial.begin(SERIAL_SPEED, SERIAL_FRAMING);
+	serialSpeed = SERIAL_SPEED;
 	/* wait for serial connection */
 	while ( ! isSerialConnected(Serial) );
 	last = millis();
+	commandLen = 0;
+	binaryMode = false;
+	sequence = 0;
+	hostConnected = false;
+	reading = false;
+	readChannel = 0;
+	nextChannel = 0;
+	aggrInterval = 0;
+	resetSummary();
 }
 
 
 /** Output temperature and humidity once every UPDATE_INTERVAL. */
 void loop(void) {
+	/* handle commands from the host */
+	if ( isSerialConnected(Serial) ) {
+		if ( ! hostConnected ) {
+			/* signal readiness to the new host */
+			Serial.println(F(PROTO_CMD_READY));
+			hostConnected = true;
+		}
+		handleCommands();
+	} else if ( hostConnected ) {
+		/* fall back to ASCII lines and the default speed for the next host */
+		commandLen = 0;
+		binaryMode = false;
+		setSpeed(SERIAL_SPEED);
+		hostConnected = false;
+		aggrInterval = 0;
+	}
+	/* complete the non-blocking sensor reading */
+	Reading val;
+	if (reading && sensors[readChannel].poll(val)) {
+		reading = false;
+		sendReading(readChannel, val);
+	}
+	/* send the summary of the passed aggregation interval */
+	if (binaryMode && aggrInterval > 0 && (millis() - aggrStart) >= aggrInterval) sendSummary();
 	/* check update interval deadline */
 	const unsigned long now = millis();
 	const unsigned long diff = now - last;
-	if (diff < UPDATE_INTERVAL) {
-		delay(1);
+	if (diff < (UPDATE_INTERVAL / SENSOR_COUNT)) {
+		unsigned long remaining = (UPDATE_INTERVAL / SENSOR_COUNT) - diff;
+		if (binaryMode && aggrInterval > 0) {
+			/* wake up for the next summary */
+			const unsigned long aggrPassed = now - aggrStart;
+			if (aggrPassed < aggrInterval && (aggrInterval - aggrPassed) < remaining) remaining = aggrInterval - aggrPassed;
+		}
+		waitFor(remaining);
 		return;
 	}
 	if (diff > 0x7FFFFFFFUL) {
 		last = now;
 	} else {
-		last += UPDATE_INTERVAL;
+		last += UPDATE_INTERVAL / SENSOR_COUNT;
 	}
+	/* read the sensors one after another to keep the distance between their readings */
+	const uint8_t channel = nextChannel;
+	nextChannel = static_cast<uint8_t>((channel + 1) % SENSOR_COUNT);
 	/* wait for serial connection */
 	if ( ! isSerialConnected(Serial) ) return;
 	/* retrieve and print sensor values */
-	const DHT::Result val = DHT::read(DHT_PIN);
-	if ( ! isSerialConnected(Serial) ) return;
-	if (val.res == DHT::SUCCESS) {
-		const float rawTemp = val.getTemp();
-		const float temp = rawTemp + DHT_TEMP_CAL;
-		const float rh   = correctRH(val.getRH(), rawTemp, temp) + DHT_RH_CAL;
-		const float sum  = temp + rh; /* checksum */
-		Serial.print(temp, 1);
-		Serial.print('\t');
-		Serial.print(rh, 1);
-		Serial.print('\t');
-		Serial.println(sum, 1);
+	if ( reading ) return; /* previous reading still in progress */
+	if ( sensors[channel].start() ) {
+		reading = true;
+		readChannel = channel;
 	} else {
-		Serial.print(F("Err:"));
-		Serial.println(val.res, DEC);
+		sensors[channel].read(val);
+		sendReading(channel, val);
 	}
 }
@@ -0,0 +1,583 @@
+/**
+ * @file bench.c
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Benchmark of the input processing and output formatting paths of thlog.
+ * A serial capture is replayed from memory through processData() by replacing the serial interface
+ * functions. The application source is included to access its internal functions.
+ */
+#include "../utility/mingw-unicode.h"
+#undef _tmain
+#define _tmain thlogMain
+#include "../thlog.c"
+#undef _tmain
+#if defined(PCF_IS_WIN) && defined(_UNICODE)
+#define _tmain wmain
+#else /* not PCF_IS_WIN or not _UNICODE */
+#define _tmain main
+#endif /* not PCF_IS_WIN or not _UNICODE */
+
+
+/** Defines the size of each generated capture in bytes. */
+#define BENCH_CAPTURE_SIZE 262144
+
+
+/** Defines the default number of passes over each capture. */
+#define BENCH_PASSES 32
+
+
+/** Defines the number of lines output by the format benchmark. */
+#define BENCH_FORMAT_LINES 1000000
+
+
+/** Defines the time between two lines of the format benchmark in milliseconds. */
+#define BENCH_FORMAT_STEP 250
+
+
+/** Defines the output buffer size in bytes. */
+#define BENCH_SINK_SIZE 65536
+
+
+/** Defines the output device which discards all data. */
+#if defined(PCF_IS_WIN)
+#define BENCH_NULL_DEVICE _T("NUL")
+#else /* not PCF_IS_WIN */
+#define BENCH_NULL_DEVICE _T("/dev/null")
+#endif /* not PCF_IS_WIN */
+
+
+/** Replayed serial interface. */
+struct tSerial {
+	const uint8_t * data; /**< captured data */
+	size_t size; /**< number of bytes in data */
+	size_t pos; /**< read position within data */
+	size_t passes; /**< number of remaining passes over data */
+};
+
+
+/** Unused wake-up object. */
+struct tSerWakeup {
+	int dummy;
+};
+
+
+/** Serial capture to replay. */
+typedef struct tCapture {
+	const char * name; /**< capture name */
+	uint8_t * data; /**< captured data */
+	size_t size; /**< number of bytes in data */
+} tCapture;
+
+
+/** Output format to benchmark. */
+typedef struct tFormat {
+	const char * name; /**< format name */
+	const TCHAR * fmt; /**< format string */
+} tFormat;
+
+
+/** Result of a single benchmark run. */
+typedef struct tResult {
+	double seconds; /**< elapsed time */
+	size_t bytes; /**< number of processed input bytes */
+	size_t samples; /**< number of processed samples */
+	size_t lines; /**< number of output lines */
+} tResult;
+
+
+static const tFormat formats[] = {
+	{"default", DEFAULT_FORMAT},
+	{"values",  _T("%.1vC\\t%.1vH\\n")},
+	{"stats",   _T("%Y-%m-%dT%H:%M:%S %.2vC %.2vCmin %.2vCmax %.3vCsd %.2vCmed %.0vN %.2vF %.2vH\\n")},
+	{"time",    _T("%Y-%m-%d %H:%M:%S\\n")},
+	{"iso",     _T("%FT%T.%f %.1vC %.1vH\\n")},
+	{"locale",  _T("%a %b %e %H:%M:%S %Z %.1vC\\n")},
+	{"derived", _T("%.1vC %.1vH %.1vD %.2vA %.1vX\\n")}
+};
+
+
+static tSerWakeup benchWakeup;
+static uint32_t seed = 1;
+
+
+static void printBenchHelp(void);
+static int loadCapture(tCapture * cap, const TCHAR * path);
+static int generateCapture(tCapture * cap, const int binary);
+static size_t appendSample(uint8_t * buf, const int binary, uint8_t * seq);
+static uint32_t nextRandom(void);
+static int runReplay(const tCapture * cap, const tFormat * format, const size_t passes, tResult * res);
+static int runFormat(const tFormat * format, tResult * res);
+static void printResult(const char * capture, const char * format, const tResult * res);
+static double getTimeSec(void);
+
+
+/**
+ * Main entry point.
+ */
+int _tmain(int argc, TCHAR ** argv) {
+	int ret = EXIT_FAILURE;
+	tCapture caps[2];
+	size_t capCount = 0;
+	size_t passes = BENCH_PASSES;
+	const TCHAR * path = NULL;
+	tResult res;
+	size_t i, j;
+
+	fin  = stdin;
+	fout = stdout;
+	ferr = stderr;
+	verbose = 0;
+	wakeup = &benchWakeup;
+	memset(caps, 0, sizeof(caps));
+
+	for (int n = 1; n < argc; n++) {
+		if (_tcscmp(argv[n], _T("-n")) == 0 && (n + 1) < argc) {
+			TCHAR * strNum;
+			const long val = _tcstol(argv[++n], &strNum, 10);
+			if (*strNum != 0 || val < 1) {
+				printBenchHelp();
+				goto onError;
+			}
+			passes = (size_t)val;
+		} else if (argv[n][0] != _T('-') && path == NULL) {
+			path = argv[n];
+		} else {
+			printBenchHelp();
+			goto onError;
+		}
+	}
+
+	/* prepare the captures */
+	if (path != NULL) {
+		if (loadCapture(caps, path) == 0) {
+			_ftprintf(ferr, _T("Error: Failed to read capture file '%s'.\n"), path);
+			goto onError;
+		}
+		capCount = 1;
+	} else {
+		for (capCount = 0; capCount < 2; capCount++) {
+			if (generateCapture(caps + capCount, (int)capCount) == 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
+				goto onError;
+			}
+		}
+	}
+
+	printf("%-8s %-8s %14s %14s %14s\n", "capture", "format", "bytes/s", "samples/s", "lines/s");
+	/* replay each capture through processData() */
+	for (i = 0; i < capCount; i++) {
+		for (j = 0; j < (sizeof(formats) / sizeof(*formats)); j++) {
+			if (runReplay(caps + i, formats + j, passes, &res) == 0) goto onError;
+			printResult(caps[i].name, formats[j].name, &res);
+		}
+	}
+	/* output formatting only */
+	for (j = 0; j < (sizeof(formats) / sizeof(*formats)); j++) {
+		if (runFormat(formats + j, &res) == 0) goto onError;
+		printResult("-", formats[j].name, &res);
+	}
+
+	ret = EXIT_SUCCESS;
+onError:
+	for (i = 0; i < capCount; i++) free(caps[i].data);
+	return ret;
+}
+
+
+/**
+ * Write the help for this benchmark to standard out.
+ */
+static void printBenchHelp(void) {
+	printf(
+	"thlog-bench [-n <passes>] [<capture>]\n"
+	"\n"
+	"Replays the given serial capture or generated ASCII and binary captures\n"
+	"through the input processing of thlog and reports the throughput for several\n"
+	"output formats. Each capture is replayed <passes> times (default: %u).\n",
+	(unsigned)BENCH_PASSES
+	);
+}
+
+
+/**
+ * Loads the given capture file into memory. Raw capture files (see --raw-tee) are reduced to the
+ * recorded data. Other files are used as they are.
+ *
+ * @param[out] cap - loaded capture
+ * @param[in] path - capture file path
+ * @return 1 on success, else 0
+ */
+static int loadCapture(tCapture * cap, const TCHAR * path) {
+	tCapReader * reader = capOpenReader(path);
+	if (reader != NULL) {
+		tCapRecord rec;
+		size_t size = 0;
+		int res;
+		cap->name = "raw";
+		cap->size = 0;
+		while ((res = capRead(reader, &rec)) > 0) {
+			if ((cap->size + rec.size) > size) {
+				size = PCF_MAX(2 * size, cap->size + rec.size);
+				uint8_t * data = (uint8_t *)realloc(cap->data, size);
+				if (data == NULL) break;
+				cap->data = data;
+			}
+			memcpy(cap->data + cap->size, rec.data, rec.size);
+			cap->size += rec.size;
+		}
+		capCloseReader(reader);
+		if (res == 0 && cap->size > 0) return 1;
+		free(cap->data);
+		cap->data = NULL;
+		return 0;
+	}
+	FILE * fd = _tfopen(path, _T("rb"));
+	long size;
+	if (fd == NULL) return 0;
+	if (fseek(fd, 0, SEEK_END) != 0 || (size = ftell(fd)) <= 0 || fseek(fd, 0, SEEK_SET) != 0) goto onError;
+	cap->name = "file";
+	cap->size = (size_t)size;
+	cap->data = (uint8_t *)malloc(cap->size);
+	if (cap->data == NULL || fread(cap->data, 1, cap->size, fd) != cap->size) goto onError;
+	fclose(fd);
+	return 1;
+onError:
+	fclose(fd);
+	free(cap->data);
+	cap->data = NULL;
+	return 0;
+}
+
+
+/**
+ * Generates a capture of the remote device output. About 1 in 16 readings is an error code,
+ * has a wrong checksum or is followed by garbage.
+ *
+ * @param[out] cap - generated capture
+ * @param[in] binary - non-zero to generate binary frames instead of ASCII lines
+ * @return 1 on success, else 0
+ */
+static int generateCapture(tCapture * cap, const int binary) {
+	static const char binCmd[] = PROTO_CMD_BINARY "\r\n";
+	uint8_t seq = 0;
+	size_t len = 0;
+	cap->name = (binary != 0) ? "binary" : "ascii";
+	cap->data = (uint8_t *)malloc(BENCH_CAPTURE_SIZE);
+	if (cap->data == NULL) return 0;
+	if (binary != 0) {
+		/* acknowledgement which switches the device to binary frames */
+		memcpy(cap->data, binCmd, sizeof(binCmd) - 1);
+		len = sizeof(binCmd) - 1;
+	}
+	/* each sample produces at most 64 bytes */
+	while ((len + 64) <= BENCH_CAPTURE_SIZE) {
+		len += appendSample(cap->data + len, binary, &seq);
+	}
+	cap->size = len;
+	return 1;
+}
+
+
+/**
+ * Appends a single random reading of the remote device to the given buffer.
+ *
+ * @param[out] buf - output buffer with at least 64 bytes space
+ * @param[in] binary - non-zero to output a binary frame instead of an ASCII line
+ * @param[in,out] seq - sequence number of the next frame
+ * @return number of bytes written
+ */
+static size_t appendSample(uint8_t * buf, const int binary, uint8_t * seq) {
+	const uint32_t r = nextRandom();
+	const int temp = (int)(r % 600) - 100;
+	const int rh = (int)((r >> 10) % 1000);
+	const unsigned kind = (unsigned)((r >> 20) & 0x0F);
+	size_t len = 0;
+	if (binary != 0) {
+		const int16_t values[PROTO_SAMPLE_VALUES] = {(int16_t)temp, (int16_t)rh};
+		buf[len++] = PROTO_SYNC;
+		buf[len++] = PROTO_FRAME_SAMPLE;
+		buf[len++] = (*seq)++;
+		buf[len++] = (uint8_t)((kind == 1) ? 3 : 0);
+		for (size_t i = 0; i < PROTO_SAMPLE_VALUES; i++) {
+			buf[len++] = (uint8_t)((uint16_t)(values[i]) & 0xFF);
+			buf[len++] = (uint8_t)((uint16_t)(values[i]) >> 8);
+		}
+		buf[len] = protoCrc8(buf + 1, len - 1);
+		if (kind == 2) buf[len] = (uint8_t)(buf[len] ^ 0x5A);
+		len++;
+	} else if (kind == 1) {
+		len = (size_t)sprintf((char *)buf, "Err:%u\r\n", (unsigned)((r >> 24) % 4));
+	} else {
+		const int sum = temp + rh + ((kind == 2) ? 10 : 0);
+		len = (size_t)sprintf(
+			(char *)buf,
+			"%s%d.%d\t%d.%d\t%s%d.%d\r\n",
+			(temp < 0) ? "-" : "", abs(temp) / 10, abs(temp) % 10,
+			rh / 10, rh % 10,
+			(sum < 0) ? "-" : "", abs(sum) / 10, abs(sum) % 10
+		);
+	}
+	if (kind == 3) {
+		/* garbage */
+		for (unsigned i = (unsigned)((r >> 24) & 0x0F); i > 0; i--) buf[len++] = (uint8_t)(nextRandom() >> 24);
+	}
+	return len;
+}
+
+
+/**
+ * Returns the next pseudo random number. The sequence is the same for each program run.
+ *
+ * @return pseudo random number
+ */
+static uint32_t nextRandom(void) {
+	/* xorshift32 */
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+
+/**
+ * Replays the given capture through processData() with an update interval of 0 seconds, i.e. with
+ * one output line per read chunk which contains valid samples.
+ *
+ * @param[in] cap - capture to replay
+ * @param[in] format - output format
+ * @param[in] passes - number of passes over the capture
+ * @param[out] res - benchmark result
+ * @return 1 on success, else 0
+ */
+static int runReplay(const tCapture * cap, const tFormat * format, const size_t passes, tResult * res) {
+	uint8_t inBuf[INPUT_BUFFER_SIZE];
+	tRing in;
+	tSerial ser = {cap->data, cap->size, 0, passes};
+	tOutput out;
+	tDevice dev;
+	int result = 0;
+	memset(&out, 0, sizeof(out));
+	out.path = BENCH_NULL_DEVICE;
+	out.format = OF_TEXT;
+	memset(&dev, 0, sizeof(dev));
+	dev.name = (char *)cap->name;
+	dev.ser = &ser;
+	dev.out = &out;
+	dev.cfg.intvl = 0;
+	dev.cfg.fmt = format->fmt;
+	if (compileFormat(&(dev.cfg)) == 0) return 0;
+	out.sink = sinkOpen(out.path, 1, 0, SF_BYTES, BENCH_SINK_SIZE, 0);
+	if (out.sink == NULL) {
+		_ftprintf(ferr, MSGT(MSGT_ERR_FILE_OPEN), out.path);
+		goto onError;
+	}
+	initDevice(&dev);
+	signalReceived = 0;
+	const double start = getTimeSec();
+	ring_init(&in, inBuf, sizeof(inBuf));
+	if (processData(&dev, 1, &in) != EXIT_SUCCESS) goto onError;
+	res->seconds = getTimeSec() - start;
+	res->bytes = cap->size * passes;
+	res->samples = dev.sampleCount;
+	res->lines = dev.lineCount;
+	result = 1;
+onError:
+	sinkClose(out.sink);
+	fmtDelete(dev.cfg.prog);
+	return result;
+}
+
+
+/**
+ * Outputs a fixed set of statistics with the given format repeatedly.
+ *
+ * @param[in] format - output format
+ * @param[out] res - benchmark result
+ * @return 1 on success, else 0
+ */
+static int runFormat(const tFormat * format, tResult * res) {
+	static const double values[] = {21.5, 22.0, -1.5, 21.7, 22.1, 21.9};
+	tConfig cfg;
+	tStats temp, rh;
+	tSink * sink = NULL;
+	int result = 0;
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.fmt = format->fmt;
+	if (compileFormat(&cfg) == 0) return 0;
+	sink = sinkOpen(BENCH_NULL_DEVICE, 1, 0, SF_BYTES, BENCH_SINK_SIZE, 0);
+	if (sink == NULL) {
+		_ftprintf(ferr, MSGT(MSGT_ERR_FILE_OPEN), BENCH_NULL_DEVICE);
+		goto onError;
+	}
+	statsReset(&temp);
+	statsReset(&rh);
+	for (size_t i = 0; i < (sizeof(values) / sizeof(*values)); i++) {
+		statsAdd(&temp, values[i]);
+		statsAdd(&rh, values[i] + 30.0);
+	}
+	/* one line every BENCH_FORMAT_STEP ms */
+	const int64_t now = (int64_t)time(NULL) * 1000;
+	const double start = getTimeSec();
+	for (size_t i = 0; i < BENCH_FORMAT_LINES; i++) {
+		if (printData(sink, cfg.prog, now + ((int64_t)i * BENCH_FORMAT_STEP), 0, 0, &temp, &rh) < 0) {
+			_ftprintf(ferr, MSGT(MSGT_ERR_FMT_WRITE));
+			goto onError;
+		}
+	}
+	if (sinkFlush(sink) == 0) {
+		_ftprintf(ferr, MSGT(MSGT_ERR_FMT_WRITE));
+		goto onError;
+	}
+	res->seconds = getTimeSec() - start;
+	res->bytes = 0;
+	res->samples = 0;
+	res->lines = BENCH_FORMAT_LINES;
+	result = 1;
+onError:
+	sinkClose(sink);
+	fmtDelete(cfg.prog);
+	return result;
+}
+
+
+/**
+ * Outputs the given benchmark result as table row.
+ *
+ * @param[in] capture - capture name
+ * @param[in] format - format name
+ * @param[in] res - benchmark result
+ */
+static void printResult(const char * capture, const char * format, const tResult * res) {
+	const double sec = (res->seconds > 0.0) ? res->seconds : 1e-9;
+	printf(
+		"%-8s %-8s %14.0f %14.0f %14.0f\n",
+		capture,
+		format,
+		(double)(res->bytes) / sec,
+		(double)(res->samples) / sec,
+		(double)(res->lines) / sec
+	);
+}
+
+
+/**
+ * Returns a monotonic time stamp in seconds.
+ *
+ * @return time in seconds
+ */
+static double getTimeSec(void) {
+#if defined(PCF_IS_WIN)
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)(count.QuadPart) / (double)(freq.QuadPart);
+#else /* not PCF_IS_WIN */
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)(ts.tv_sec) + ((double)(ts.tv_nsec) / 1e9);
+#endif /* not PCF_IS_WIN */
+}
+
+
+/* Serial interface functions replaying the capture of the device. */
+
+
+tSerial * ser_create(const char * device, const size_t speed, const tSerFraming framing, const tSerFlowCtrl flow) {
+	PCF_UNUSED(device);
+	PCF_UNUSED(speed);
+	PCF_UNUSED(framing);
+	PCF_UNUSED(flow);
+	errno = ENOENT;
+	return NULL;
+}
+
+
+int ser_setConfig(tSerial * ser, const size_t speed, const tSerFraming framing, const tSerFlowCtrl flow) {
+	PCF_UNUSED(speed);
+	PCF_UNUSED(framing);
+	PCF_UNUSED(flow);
+	return (ser != NULL) ? 1 : 0;
+}
+
+
+ssize_t ser_readRing(tSerial * ser, tRing * ring, const size_t timeout) {
+	uint8_t * ptr;
+	size_t space;
+	ssize_t total = 0;
+	PCF_UNUSED(timeout);
+	if (ser == NULL || ring == NULL) return -1;
+	while ((space = ring_space(ring, &ptr)) > 0) {
+		if (ser->pos >= ser->size) {
+			if (ser->passes <= 1) break;
+			ser->passes--;
+			ser->pos = 0;
+		}
+		const size_t len = PCF_MIN(space, ser->size - ser->pos);
+		memcpy(ptr, ser->data + ser->pos, len);
+		ring_commit(ring, len);
+		ser->pos += len;
+		total += (ssize_t)len;
+	}
+	return total;
+}
+
+
+int ser_wait(tSerial ** ser, const size_t count, uint8_t * ready, tSerWakeup * wk, const size_t timeout) {
+	int res = 0;
+	PCF_UNUSED(wk);
+	PCF_UNUSED(timeout);
+	for (size_t i = 0; i < count; i++) {
+		ready[i] = (uint8_t)((ser[i]->pos < ser[i]->size || ser[i]->passes > 1) ? 1 : 0);
+		res += ready[i];
+	}
+	/* end of capture */
+	if (res == 0) signalReceived = 1;
+	return res;
+}
+
+
+ssize_t ser_write(tSerial * ser, const uint8_t * buf, const size_t size, const size_t timeout) {
+	PCF_UNUSED(timeout);
+	if (ser == NULL || buf == NULL) return -1;
+	return (ssize_t)size;
+}
+
+
+int ser_clear(tSerial * ser) {
+	return (ser != NULL) ? 1 : 0;
+}
+
+
+void ser_delete(tSerial * ser) {
+	PCF_UNUSED(ser);
+}
+
+
+tSerWakeup * ser_createWakeup(void) {
+	return &benchWakeup;
+}
+
+
+int ser_wakeup(tSerWakeup * wk) {
+	return (wk != NULL) ? 1 : 0;
+}
+
+
+void ser_deleteWakeup(tSerWakeup * wk) {
+	PCF_UNUSED(wk);
+}
+
+
+int ser_watchHotplug(tSerWakeup * wk) {
+	PCF_UNUSED(wk);
+	return 0;
+}
+
+
+int ser_hotplugPending(tSerWakeup * wk) {
+	PCF_UNUSED(wk);
+	return 0;
+}
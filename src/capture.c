@@ -0,0 +1,188 @@
+/**
+ * @file capture.c
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "capture.h"
+
+
+/** Size of the read buffer in bytes. Needs to hold at least one complete record. */
+#define CAP_READ_SIZE 1048576
+
+
+/**
+ * Internal raw capture file reader.
+ */
+struct tCapReader {
+	FILE * fd; /**< input file */
+	uint8_t * buf; /**< read buffer */
+	size_t pos; /**< position of the next record in buf */
+	size_t len; /**< number of valid bytes in buf */
+};
+
+
+/**
+ * Internal raw capture file writer.
+ */
+struct tCapWriter {
+	FILE * fd; /**< output file */
+};
+
+
+/**
+ * Reads more data into the buffer of the given reader until it holds at least the passed number
+ * of bytes after the current position or the end of the file was reached.
+ *
+ * @param[in,out] reader - raw capture file reader
+ * @param[in] need - number of needed bytes
+ * @return 1 on success, 0 at the end of the file or -1 on error
+ */
+static int fillBuf(tCapReader * reader, const size_t need) {
+	if ((reader->len - reader->pos) >= need) return 1;
+	/* move the remaining bytes to the start of the buffer */
+	reader->len -= reader->pos;
+	memmove(reader->buf, reader->buf + reader->pos, reader->len);
+	reader->pos = 0;
+	while (reader->len < need) {
+		const size_t res = fread(reader->buf + reader->len, 1, CAP_READ_SIZE - reader->len, reader->fd);
+		if (res == 0) return (ferror(reader->fd) != 0) ? -1 : 0;
+		reader->len += res;
+	}
+	return 1;
+}
+
+
+/**
+ * Opens the given raw capture file for reading.
+ *
+ * @param[in] path - raw capture file path
+ * @return Handle on success, else NULL.
+ */
+tCapReader * capOpenReader(const TCHAR * path) {
+	tCapReader * reader;
+	if (path == NULL) return NULL;
+	reader = (tCapReader *)calloc(1, sizeof(tCapReader));
+	if (reader == NULL) return NULL;
+	reader->buf = (uint8_t *)malloc(CAP_READ_SIZE);
+	if (reader->buf == NULL) goto onError;
+	reader->fd = _tfopen(path, _T("rb"));
+	if (reader->fd == NULL) goto onError;
+	/* check the file signature */
+	if (fillBuf(reader, sizeof(CAP_MAGIC) - 1) <= 0 || memcmp(reader->buf, CAP_MAGIC, sizeof(CAP_MAGIC) - 1) != 0) {
+		errno = EINVAL;
+		goto onError;
+	}
+	reader->pos = sizeof(CAP_MAGIC) - 1;
+	return reader;
+onError:
+	capCloseReader(reader);
+	return NULL;
+}
+
+
+/**
+ * Reads the next record from the given raw capture file. An incomplete record at the end of the
+ * file is ignored.
+ *
+ * @param[in,out] reader - raw capture file reader
+ * @param[out] rec - read record; the data is only valid until the next call
+ * @return 1 on success, 0 at the end of the file or -1 on error
+ */
+int capRead(tCapReader * reader, tCapRecord * rec) {
+	uint64_t time = 0;
+	uint32_t size = 0;
+	int res;
+	if (reader == NULL || rec == NULL) return -1;
+	res = fillBuf(reader, CAP_HEADER_SIZE);
+	if (res <= 0) return res;
+	const uint8_t * ptr = reader->buf + reader->pos;
+	for (size_t i = 8; i > 0; i--) time = (time << 8) | ptr[i - 1];
+	for (size_t i = 12; i > 8; i--) size = (size << 8) | ptr[i - 1];
+	if (size > CAP_RECORD_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+	res = fillBuf(reader, CAP_HEADER_SIZE + (size_t)size);
+	if (res <= 0) return res;
+	rec->time = (int64_t)time;
+	rec->data = reader->buf + reader->pos + CAP_HEADER_SIZE;
+	rec->size = (size_t)size;
+	reader->pos += CAP_HEADER_SIZE + (size_t)size;
+	return 1;
+}
+
+
+/**
+ * Closes the given raw capture file reader.
+ *
+ * @param[in,out] reader - raw capture file reader
+ */
+void capCloseReader(tCapReader * reader) {
+	if (reader == NULL) return;
+	if (reader->fd != NULL) fclose(reader->fd);
+	if (reader->buf != NULL) free(reader->buf);
+	free(reader);
+}
+
+
+/**
+ * Opens the given raw capture file for writing. The file is created if it does not exist and
+ * written in append mode.
+ *
+ * @param[in] path - raw capture file path
+ * @return Handle on success, else NULL.
+ */
+tCapWriter * capOpenWriter(const TCHAR * path) {
+	tCapWriter * writer;
+	if (path == NULL) return NULL;
+	writer = (tCapWriter *)calloc(1, sizeof(tCapWriter));
+	if (writer == NULL) return NULL;
+	writer->fd = _tfopen(path, _T("ab"));
+	if (writer->fd == NULL || fseek(writer->fd, 0, SEEK_END) != 0) goto onError;
+	/* new files start with the file signature */
+	const long pos = ftell(writer->fd);
+	if (pos < 0) goto onError;
+	if (pos == 0 && fwrite(CAP_MAGIC, sizeof(CAP_MAGIC) - 1, 1, writer->fd) != 1) goto onError;
+	return writer;
+onError:
+	capCloseWriter(writer);
+	return NULL;
+}
+
+
+/**
+ * Appends a record with the given data to the raw capture file.
+ *
+ * @param[in,out] writer - raw capture file writer
+ * @param[in] time - reception time in milliseconds since the epoch
+ * @param[in] data - received bytes
+ * @param[in] size - number of bytes in data (at most CAP_RECORD_MAX)
+ * @return 1 on success, else 0
+ */
+int capWrite(tCapWriter * writer, const int64_t time, const uint8_t * data, const size_t size) {
+	uint8_t header[CAP_HEADER_SIZE];
+	if (writer == NULL || data == NULL || size > CAP_RECORD_MAX) return 0;
+	for (size_t i = 0; i < 8; i++) header[i] = (uint8_t)(((uint64_t)time >> (8 * i)) & 0xFF);
+	for (size_t i = 0; i < 4; i++) header[8 + i] = (uint8_t)((size >> (8 * i)) & 0xFF);
+	if (fwrite(header, sizeof(header), 1, writer->fd) != 1) return 0;
+	if (size > 0 && fwrite(data, size, 1, writer->fd) != 1) return 0;
+	return 1;
+}
+
+
+/**
+ * Closes the given raw capture file writer. Buffered records are written before.
+ *
+ * @param[in,out] writer - raw capture file writer
+ */
+void capCloseWriter(tCapWriter * writer) {
+	if (writer == NULL) return;
+	if (writer->fd != NULL) fclose(writer->fd);
+	free(writer);
+}
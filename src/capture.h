@@ -0,0 +1,65 @@
+/**
+ * @file capture.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Raw capture files hold the exact bytes received from a remote device with their reception time.
+ * The file starts with CAP_MAGIC followed by records with the following layout (multi-byte values
+ * are little endian):
+ * | Offset | Size | Content
+ * |-------:|-----:|----------------------------------------------------------
+ * |      0 |    8 | reception time in milliseconds since the epoch (signed)
+ * |      8 |    4 | N as number of received bytes
+ * |     12 |    N | received bytes
+ */
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "utility/tchar.h"
+
+
+/** File signature of raw capture files. */
+#define CAP_MAGIC "thlograw"
+
+
+/** Size of the record header in bytes. */
+#define CAP_HEADER_SIZE 12
+
+
+/** Maximum number of bytes in a single record. */
+#define CAP_RECORD_MAX 65536
+
+
+/** Single record of a raw capture file. */
+typedef struct tCapRecord {
+	int64_t time; /**< reception time in milliseconds since the epoch */
+	const uint8_t * data; /**< received bytes */
+	size_t size; /**< number of bytes in data */
+} tCapRecord;
+
+
+/**
+ * @internal raw capture file reader
+ */
+typedef struct tCapReader tCapReader;
+
+
+/**
+ * @internal raw capture file writer
+ */
+typedef struct tCapWriter tCapWriter;
+
+
+tCapReader * capOpenReader(const TCHAR * path);
+int capRead(tCapReader * reader, tCapRecord * rec);
+void capCloseReader(tCapReader * reader);
+tCapWriter * capOpenWriter(const TCHAR * path);
+int capWrite(tCapWriter * writer, const int64_t time, const uint8_t * data, const size_t size);
+void capCloseWriter(tCapWriter * writer);
+
+
+#endif /* __CAPTURE_H__ */
@@ -0,0 +1,666 @@
+/**
+ * @file format.c
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utility/cvutf8.h"
+#include "utility/target.h"
+#include "format.h"
+#include "parse.h"
+#include "psychro.h"
+
+
+/** Initial output buffer size in number of bytes. */
+#define FMT_OUT_SIZE 128
+
+
+/** Upper limit for the output buffer size in number of bytes. */
+#define FMT_OUT_LIMIT 0x100000
+
+
+/** Maximum output size of a single strftime() format code in number of bytes. */
+#define FMT_TIME_SIZE 256
+
+
+/** Maximum output size of a single time field in number of bytes. */
+#define FMT_FIELD_SIZE 32
+
+
+/** Time format codes which are formatted without strftime(). */
+#define FMT_TIME_FIELDS "FHMSTYdfms"
+
+
+/** strftime() format codes whose output changes every second. */
+#define FMT_TIME_SECONDS "EOSTXcr"
+
+
+/** Value types which only output the mean and have no statistic suffix. */
+#define FMT_VALUE_MEAN_ONLY "ADINX"
+
+
+/** Value types with integral values which default to a precision of zero. */
+#define FMT_VALUE_INTEGRAL "IN"
+
+
+/** Time changes since the last fmtRun() call. */
+#define FMT_TIME_SAME   0 /**< same second */
+#define FMT_TIME_SECOND 1 /**< only the second changed */
+#define FMT_TIME_MINUTE 2 /**< broken-down time was recalculated */
+
+
+/** Statistic suffixes of the sensor value format codes. */
+static const struct {
+	const char * suffix;
+	tFmtStat stat;
+} fmtStatSuffix[] = {
+	{"min", FST_MIN},
+	{"max", FST_MAX},
+	{"sd",  FST_SD},
+	{"med", FST_MEDIAN}
+};
+
+
+/**
+ * Appends the given string to the string literal at the end of the operation list. A new string
+ * literal operation is created if the last operation is not a string literal.
+ *
+ * @param[in,out] prog - format program
+ * @param[in,out] poolLen - used pool size in number of bytes
+ * @param[in] str - string to append
+ * @param[in] len - string length in number of bytes
+ */
+static void addLiteral(tFmtProg * prog, size_t * poolLen, const char * str, const size_t len) {
+	if (len == 0) return;
+	if (prog->count == 0 || prog->op[prog->count - 1].type != FOT_LITERAL) {
+		tFmtOp * op = prog->op + prog->count;
+		op->type = FOT_LITERAL;
+		op->subType = 0;
+		op->stat = FST_MEAN;
+		op->width = 0;
+		op->offset = *poolLen;
+		op->length = 0;
+		op->cacheOffset = 0;
+		op->cacheLength = 0;
+		prog->count++;
+	}
+	memcpy(prog->pool + *poolLen, str, len);
+	prog->op[prog->count - 1].length += len;
+	*poolLen += len;
+}
+
+
+/**
+ * Checks whether the given printf() format code sets a precision.
+ *
+ * @param[in] str - format code
+ * @param[in] len - format code length in number of bytes
+ * @return 1 if a precision is given, else 0
+ */
+static int hasPrecision(const char * str, const size_t len) {
+	for (size_t i = 0; i < len; i++) {
+		if (str[i] == '.') return 1;
+	}
+	return 0;
+}
+
+
+/**
+ * Adds a new operation with the given format code. The format code is stored null-terminated.
+ *
+ * @param[in,out] prog - format program
+ * @param[in,out] poolLen - used pool size in number of bytes
+ * @param[in] type - operation type
+ * @param[in] subType - value type for FOT_VALUE
+ * @param[in] str - format code
+ * @param[in] len - format code length in number of bytes
+ * @return added operation
+ */
+static tFmtOp * addCode(tFmtProg * prog, size_t * poolLen, const tFmtOpType type, const int subType, const char * str, const size_t len) {
+	tFmtOp * op = prog->op + prog->count;
+	op->type = type;
+	op->subType = subType;
+	op->stat = FST_MEAN;
+	op->width = 0;
+	op->offset = *poolLen;
+	op->length = len;
+	op->cacheOffset = 0;
+	op->cacheLength = 0;
+	memcpy(prog->pool + *poolLen, str, len);
+	prog->pool[*poolLen + len] = 0;
+	*poolLen += len + 1;
+	prog->count++;
+	return op;
+}
+
+
+/**
+ * Ensures that the output buffer can hold the given number of bytes beyond its current
+ * length.
+ *
+ * @param[in,out] prog - format program
+ * @param[in] len - current output length in number of bytes
+ * @param[in] extra - additional number of bytes needed including the null-terminator
+ * @return 1 on success, else 0
+ */
+static int reserveOut(tFmtProg * prog, const size_t len, const size_t extra) {
+	size_t newSize = prog->outSize;
+	if ((len + extra) <= newSize) return 1;
+	if ((len + extra) > FMT_OUT_LIMIT) return 0;
+	while (newSize < (len + extra)) newSize *= 2;
+	char * newOut = (char *)realloc(prog->out, newSize);
+	if (newOut == NULL) return 0;
+	prog->out = newOut;
+	prog->outSize = newSize;
+	return 1;
+}
+
+
+/**
+ * Formats the given broken-down time according to the passed strftime() format code.
+ *
+ * @param[out] out - output buffer
+ * @param[in] size - size of out in bytes
+ * @param[in] code - strftime() format code
+ * @param[in] tm - broken-down time
+ * @return number of bytes written without null-terminator or 0 on error
+ */
+static size_t formatTime(char * out, const size_t size, const char * code, const struct tm * tm) {
+#if defined(UNICODE) && defined(PCF_IS_WIN)
+	/* strftime() outputs names like the time zone in the ANSI code page */
+	wchar_t wCode[8];
+	wchar_t wOut[FMT_TIME_SIZE];
+	size_t i;
+	for (i = 0; code[i] != 0; i++) {
+		if (i >= ((sizeof(wCode) / sizeof(*wCode)) - 1)) return 0;
+		wCode[i] = (wchar_t)(unsigned char)(code[i]);
+	}
+	wCode[i] = 0;
+	const size_t wLen = wcsftime(wOut, sizeof(wOut) / sizeof(*wOut), wCode, tm);
+	if (wLen == 0) return 0;
+	char * res = cvutf8_fromUtf16N(wOut, wLen);
+	if (res == NULL) return 0;
+	const size_t len = strlen(res);
+	if (len >= size) {
+		free(res);
+		return 0;
+	}
+	memcpy(out, res, len + 1);
+	free(res);
+	return len;
+#else /* !UNICODE or PCF_IS_LINUX */
+	return strftime(out, size, code, tm);
+#endif
+}
+
+
+/**
+ * Returns the number of characters of the native format string which correspond to the given
+ * number of bytes of its UTF-8 copy.
+ *
+ * @param[in] str - UTF-8 copy of the format string
+ * @param[in] len - number of bytes
+ * @return number of characters
+ */
+static size_t getCharPos(const char * str, const size_t len) {
+#ifdef UNICODE
+	size_t pos = 0;
+	for (size_t i = 0; i < len; i++) {
+		const unsigned char c = (unsigned char)(str[i]);
+		/* one UTF-16 code unit per lead byte and a surrogate pair for 4 byte sequences */
+		if ((c & 0xC0) != 0x80) pos++;
+		if (c >= 0xF0) pos++;
+	}
+	return pos;
+#else /* !UNICODE */
+	(void)str;
+	return len;
+#endif /* UNICODE */
+}
+
+
+/**
+ * Compiles the given output format string into a list of operations which can be executed
+ * efficiently via fmtRun() for each output record. Escape sequences and string literals are
+ * resolved and all format codes are validated here. The time format codes %F, %H, %M, %S, %T, %Y,
+ * %d, %m and %s are formatted without strftime(). %f outputs the fractional seconds with 1 to 3
+ * digits (e.g. %2f; default: 3). The output of all other time format codes is cached between
+ * calls if the time did not change enough to affect it. The format string is converted to UTF-8
+ * once here. Hence, the program outputs UTF-8 encoded records on all targets. File paths are
+ * compiled with FMTM_PATH which keeps backslashes as path separators and rejects sensor value
+ * format codes with FMTE_VALUE.
+ *
+ * @param[in] fmt - output format string
+ * @param[in] mode - compiler mode
+ * @param[out] err - set to the error code on failure (optional)
+ * @param[out] errPos - set to the number of processed characters on failure (optional)
+ * @return compiled format program or NULL on error
+ * @remarks see strftime() for valid time related format codes
+ */
+tFmtProg * fmtCompile(const TCHAR * fmt, const tFmtMode mode, tFmtError * err, size_t * errPos) {
+	tFmtError error = FMTE_NO_MEM;
+	tFmtProg * prog = NULL;
+	char * utf8 = NULL;
+	const char * start, * ptr;
+	size_t len, poolLen, timeCount;
+	int last, esc;
+	tPFmtCtx pFmt;
+	const struct tm * nowInfo;
+	struct tm sample;
+	time_t now;
+
+	ptr = NULL;
+	if (fmt == NULL) {
+		error = FMTE_SYNTAX;
+		goto onError;
+	}
+	/* the program works on UTF-8 to output records without any further conversion */
+	utf8 = _ttoUtf8(fmt);
+	if (utf8 == NULL) goto onError;
+	ptr = utf8;
+	len = strlen(utf8);
+	prog = (tFmtProg *)calloc(1, sizeof(tFmtProg));
+	if (prog == NULL) goto onError;
+	/* each byte creates at most one operation and two pool bytes */
+	prog->op = (tFmtOp *)malloc(sizeof(tFmtOp) * (len + 1));
+	prog->pool = (char *)malloc((2 * len) + 1);
+	prog->out = (char *)malloc(FMT_OUT_SIZE);
+	if (prog->op == NULL || prog->pool == NULL || prog->out == NULL) goto onError;
+	prog->outSize = FMT_OUT_SIZE;
+	prog->out[0] = 0;
+
+	/* sample time reference to validate strftime() format codes with */
+	time(&now);
+	nowInfo = localtime(&now);
+	if (nowInfo != NULL) {
+		memcpy(&sample, nowInfo, sizeof(sample));
+	} else {
+		memset(&sample, 0, sizeof(sample));
+		sample.tm_mday = 1;
+	}
+
+	poolLen = 0;
+	timeCount = 0;
+	start = utf8;
+	last = 0;
+	esc = 0;
+	memset(&pFmt, 0, sizeof(pFmt));
+
+	for (; *ptr != 0; ptr++) {
+		const int c = (unsigned char)(*ptr);
+		/* process character escape codes */
+		if (esc != 0) {
+			last = c;
+			esc = 0;
+			switch (c) {
+			case '\\': esc = '\\'; break;
+			case 'a': esc = 0x07; break;
+			case 'b': esc = 0x08; break;
+			case 'e': esc = 0x1B; break;
+			case 'f': esc = 0x0C; break;
+			case 'n': esc = 0x0A; break;
+			case 'r': esc = 0x0D; break;
+			case 't': esc = 0x09; break;
+			default: break;
+			}
+			if (esc != 0) {
+				const char ch = (char)esc;
+				addLiteral(prog, &poolLen, &ch, 1);
+				start = ptr + 1;
+				esc = 0;
+				continue;
+			}
+		}
+		/* process codes and literals */
+		if (pFmt.state == PFMTS_START) {
+			if (c == '%') {
+				/* format code start */
+				addLiteral(prog, &poolLen, start, (size_t)(ptr - start));
+				start = ptr;
+			} else if (c == '\\' && mode == FMTM_RECORD) {
+				/* escape code start */
+				addLiteral(prog, &poolLen, start, (size_t)(ptr - start));
+				start = ptr;
+				esc = 1;
+				continue;
+			} else {
+				/* string literal part */
+				last = c;
+				continue;
+			}
+		}
+		/* process format codes */
+		if (parseFmt(&pFmt, c) != 1 && pFmt.state != PFMTS_STOP) {
+			/* invalid format code syntax */
+			error = (pFmt.state == PFMTS_ERROR_OVERFLOW) ? FMTE_OVERFLOW : FMTE_SYNTAX;
+			goto onError;
+		} else if (pFmt.state == PFMTS_STOP) {
+			if (pFmt.type == 'v' && mode != FMTM_RECORD) {
+				/* sensor values are only available for output records */
+				error = FMTE_VALUE;
+				goto onError;
+			} else if (pFmt.type == 'v') {
+				/* sensor value; replace "v" and the sub-type by the printf() type "f" */
+				const size_t codeLen = (size_t)(ptr - start - 1);
+				tFmtOp * op = addCode(prog, &poolLen, FOT_VALUE, pFmt.subType, start, codeLen + 1);
+				prog->pool[op->offset + codeLen] = 'f';
+				if (strchr(FMT_VALUE_INTEGRAL, (char)(pFmt.subType)) != NULL && hasPrecision(start, codeLen) == 0) {
+					/* integral values are output without fractional digits by default */
+					char * code = prog->pool + op->offset + codeLen;
+					code[0] = '.';
+					code[1] = '0';
+					code[2] = 'f';
+					code[3] = 0;
+					op->length += 2;
+					poolLen += 2;
+				}
+				/* optional statistic suffix */
+				if (strchr(FMT_VALUE_MEAN_ONLY, (char)(pFmt.subType)) == NULL) {
+					for (size_t i = 0; i < (sizeof(fmtStatSuffix) / sizeof(*fmtStatSuffix)); i++) {
+						const size_t suffixLen = strlen(fmtStatSuffix[i].suffix);
+						if (strncmp(ptr + 1, fmtStatSuffix[i].suffix, suffixLen) == 0) {
+							op->stat = fmtStatSuffix[i].stat;
+							ptr += suffixLen;
+							break;
+						}
+					}
+				}
+			} else if (pFmt.type == '%' && last == '%') {
+				/* escaped % */
+				addLiteral(prog, &poolLen, ptr, 1);
+			} else if (pFmt.type == 'f') {
+				/* fractional seconds with an optional number of digits */
+				const size_t codeLen = (size_t)(ptr - start);
+				if (codeLen > 2 || (codeLen == 2 && (start[1] < '1' || start[1] > '3'))) {
+					error = FMTE_SYNTAX;
+					goto onError;
+				}
+				tFmtOp * op = addCode(prog, &poolLen, FOT_TIME_FIELD, 'f', start, codeLen + 1);
+				op->width = (codeLen == 2) ? (unsigned int)(start[1] - '0') : 3;
+			} else if (last == '%' && strchr(FMT_TIME_FIELDS, c) != NULL) {
+				/* time field */
+				addCode(prog, &poolLen, FOT_TIME_FIELD, c, start, (size_t)(ptr + 1 - start));
+			} else if (last == '%' || last == '#') {
+				/* time value */
+				char buf[FMT_TIME_SIZE];
+				const int subType = (strchr(FMT_TIME_SECONDS, c) != NULL) ? 'S' : 'M';
+				tFmtOp * op = addCode(prog, &poolLen, FOT_TIME, subType, start, (size_t)(ptr + 1 - start));
+				if (formatTime(buf, sizeof(buf), prog->pool + op->offset, &sample) <= 0) {
+					/* error reported by API */
+					error = FMTE_API;
+					goto onError;
+				}
+				op->cacheOffset = timeCount * FMT_TIME_SIZE;
+				timeCount++;
+			} else {
+				/* invalid format code syntax */
+				error = FMTE_SYNTAX;
+				goto onError;
+			}
+			start = ptr + 1;
+			memset(&pFmt, 0, sizeof(pFmt));
+		}
+		last = c;
+	}
+	if (pFmt.state != PFMTS_START) {
+		/* incomplete format code at the end */
+		error = FMTE_SYNTAX;
+		ptr--;
+		goto onError;
+	}
+	/* remaining string literal (i.e. string part without any format codes) */
+	addLiteral(prog, &poolLen, start, (size_t)(ptr - start));
+	if (timeCount > 0) {
+		prog->cache = (char *)malloc(FMT_TIME_SIZE * timeCount);
+		if (prog->cache == NULL) {
+			error = FMTE_NO_MEM;
+			goto onError;
+		}
+	}
+	free(utf8);
+	if (err != NULL) *err = FMTE_SUCCESS;
+	return prog;
+onError:
+	if (err != NULL) *err = error;
+	if (errPos != NULL) *errPos = (ptr != NULL) ? getCharPos(utf8, (size_t)(ptr + 1 - utf8)) : 0;
+	if (utf8 != NULL) free(utf8);
+	fmtDelete(prog);
+	return NULL;
+}
+
+
+/**
+ * Returns the given statistic of the passed value series.
+ *
+ * @param[in] stats - value series
+ * @param[in] stat - statistic to return
+ * @return statistic value
+ */
+static double getStat(const tStats * stats, const tFmtStat stat) {
+	switch (stat) {
+	case FST_MEAN: return statsMean(stats);
+	case FST_MIN: return (stats->count > 0) ? stats->min : (double)NAN;
+	case FST_MAX: return (stats->count > 0) ? stats->max : (double)NAN;
+	case FST_SD: return statsSd(stats);
+	case FST_MEDIAN: return statsMedian(stats);
+	}
+	return (double)NAN;
+}
+
+
+/**
+ * Writes the given value as decimal number with at least the passed number of digits. Missing
+ * digits are filled with leading zeros.
+ *
+ * @param[out] out - output buffer
+ * @param[in] value - value to write
+ * @param[in] digits - minimal number of digits
+ * @return number of bytes written
+ */
+static size_t putDec(char * out, const int64_t value, const size_t digits) {
+	char buf[24];
+	size_t n = 0, len = 0;
+	uint64_t rem = (value < 0) ? (uint64_t)(-(value + 1)) + 1 : (uint64_t)value;
+	do {
+		buf[n++] = (char)('0' + (rem % 10));
+		rem /= 10;
+	} while (rem > 0);
+	while (n < digits) buf[n++] = '0';
+	if (value < 0) out[len++] = '-';
+	while (n > 0) out[len++] = buf[--n];
+	return len;
+}
+
+
+/**
+ * Writes the given time field without strftime().
+ *
+ * @param[out] out - output buffer with space for at least FMT_FIELD_SIZE bytes
+ * @param[in] op - time field operation
+ * @param[in] tm - broken-down time
+ * @param[in] sec - time in seconds since the epoch
+ * @param[in] ms - milliseconds within the second
+ * @return number of bytes written
+ */
+static size_t putField(char * out, const tFmtOp * op, const struct tm * tm, const int64_t sec, const int ms) {
+	size_t len = 0;
+	switch (op->subType) {
+	case 'F':
+		len += putDec(out, (int64_t)(tm->tm_year) + 1900, 4);
+		out[len++] = '-';
+		len += putDec(out + len, tm->tm_mon + 1, 2);
+		out[len++] = '-';
+		len += putDec(out + len, tm->tm_mday, 2);
+		break;
+	case 'T':
+		len += putDec(out, tm->tm_hour, 2);
+		out[len++] = ':';
+		len += putDec(out + len, tm->tm_min, 2);
+		out[len++] = ':';
+		len += putDec(out + len, tm->tm_sec, 2);
+		break;
+	case 'Y': len = putDec(out, (int64_t)(tm->tm_year) + 1900, 1); break;
+	case 'm': len = putDec(out, tm->tm_mon + 1, 2); break;
+	case 'd': len = putDec(out, tm->tm_mday, 2); break;
+	case 'H': len = putDec(out, tm->tm_hour, 2); break;
+	case 'M': len = putDec(out, tm->tm_min, 2); break;
+	case 'S': len = putDec(out, tm->tm_sec, 2); break;
+	case 's': len = putDec(out, sec, 1); break;
+	case 'f':
+		switch (op->width) {
+		case 1: len = putDec(out, ms / 100, 1); break;
+		case 2: len = putDec(out, ms / 10, 2); break;
+		default: len = putDec(out, ms, 3); break;
+		}
+		break;
+	default:
+		break;
+	}
+	return len;
+}
+
+
+/**
+ * Updates the broken-down time of the given format program. The local time or UTC conversion is
+ * only performed if the minute changed as only the second needs to be updated otherwise.
+ *
+ * @param[in,out] prog - format program
+ * @param[in] sec - time in seconds since the epoch
+ * @param[in] utc - non-zero for UTC, zero for local time
+ * @return FMT_TIME_SAME, FMT_TIME_SECOND, FMT_TIME_MINUTE or -1 on error
+ */
+static int updateTime(tFmtProg * prog, const int64_t sec, const int utc) {
+	if (prog->cacheValid != 0 && prog->utc == utc) {
+		const int64_t diff = sec - (int64_t)(prog->time);
+		if (diff == 0) return FMT_TIME_SAME;
+		const int64_t newSec = (int64_t)(prog->timeInfo.tm_sec) + diff;
+		if (newSec >= 0 && newSec < 60) {
+			prog->timeInfo.tm_sec = (int)newSec;
+			prog->time = (time_t)sec;
+			return FMT_TIME_SECOND;
+		}
+	}
+	const time_t now = (time_t)sec;
+	const struct tm * timeInfo = (utc != 0) ? gmtime(&now) : localtime(&now);
+	if (timeInfo == NULL) {
+		prog->cacheValid = 0;
+		return -1;
+	}
+	memcpy(&(prog->timeInfo), timeInfo, sizeof(prog->timeInfo));
+	prog->time = now;
+	prog->utc = utc;
+	prog->cacheValid = 1;
+	return FMT_TIME_MINUTE;
+}
+
+
+/**
+ * Executes the given format program with the passed sensor data. The result is stored
+ * null-terminated in prog->out.
+ *
+ * @param[in,out] prog - format program
+ * @param[in] timeMs - time reference in milliseconds since the epoch
+ * @param[in] utc - non-zero to output the time in UTC, zero for local time
+ * @param[in] channel - sensor channel number
+ * @param[in] temp - temperature values in degrees Celsius
+ * @param[in] rh - relative humidity values in percent
+ * @return number of bytes in prog->out or -1 on error
+ */
+int fmtRun(tFmtProg * prog, const int64_t timeMs, const int utc, const unsigned int channel, const tStats * temp, const tStats * rh) {
+	if (prog == NULL || temp == NULL || rh == NULL) return -1;
+	tFmtOp * op = prog->op;
+	const tFmtOp * const end = prog->op + prog->count;
+	size_t len = 0;
+	tPsychro derived = {0.0, 0.0, 0.0};
+	int derivedValid = 0;
+	/* split into seconds and milliseconds rounded towards negative infinity */
+	int64_t sec = timeMs / 1000;
+	int ms = (int)(timeMs % 1000);
+	if (ms < 0) {
+		sec--;
+		ms += 1000;
+	}
+	const int changed = updateTime(prog, sec, utc);
+	if (changed < 0) return -1;
+
+	for (; op != end; op++) {
+		const char * code = prog->pool + op->offset;
+		switch (op->type) {
+		case FOT_LITERAL:
+			if (reserveOut(prog, len, op->length + 1) == 0) return -1;
+			memcpy(prog->out + len, code, op->length);
+			len += op->length;
+			break;
+		case FOT_TIME:
+			if (changed == FMT_TIME_MINUTE || (changed == FMT_TIME_SECOND && op->subType == 'S')) {
+				/* zero is either an empty output or an overflow; both result in an empty output */
+				op->cacheLength = formatTime(prog->cache + op->cacheOffset, FMT_TIME_SIZE, code, &(prog->timeInfo));
+			}
+			if (reserveOut(prog, len, op->cacheLength + 1) == 0) return -1;
+			memcpy(prog->out + len, prog->cache + op->cacheOffset, op->cacheLength);
+			len += op->cacheLength;
+			break;
+		case FOT_TIME_FIELD:
+			if (reserveOut(prog, len, FMT_FIELD_SIZE) == 0) return -1;
+			len += putField(prog->out + len, op, &(prog->timeInfo), sec, ms);
+			break;
+		case FOT_VALUE:
+			for (;;) {
+				const size_t rem = (size_t)(prog->outSize - len);
+				double value;
+				switch (op->subType) {
+				case 'C': value = getStat(temp, op->stat); break;
+				case 'F':
+					value = getStat(temp, op->stat) * 1.8;
+					if (op->stat != FST_SD) value += 32.0;
+					break;
+				case 'H': value = getStat(rh, op->stat); break;
+				case 'A':
+				case 'D':
+				case 'X':
+					/* computed once per run from the mean values */
+					if (derivedValid == 0) {
+						psychroCompute(&derived, statsMean(temp), statsMean(rh));
+						derivedValid = 1;
+					}
+					value = (op->subType == 'A') ? derived.absHumidity : (op->subType == 'D') ? derived.dewPoint : derived.heatIndex;
+					break;
+				case 'I': value = (double)channel; break;
+				case 'N': value = (double)(temp->count); break;
+				default: return -1;
+				}
+				const int written = snprintf(prog->out + len, rem, code, value);
+				if (written >= 0 && (size_t)written < rem) {
+					len += (size_t)written;
+					break;
+				}
+				/* some implementations return -1 if the output was truncated */
+				if (reserveOut(prog, len, (written >= 0) ? (size_t)written + 1 : 2 * rem) == 0) return -1;
+			}
+			break;
+		}
+	}
+	if (reserveOut(prog, len, 1) == 0) return -1;
+	prog->out[len] = 0;
+	return (int)len;
+}
+
+
+/**
+ * Frees the given format program. The program is invalid after this call.
+ *
+ * @param[in,out] prog - format program to free
+ */
+void fmtDelete(tFmtProg * prog) {
+	if (prog == NULL) return;
+	if (prog->op != NULL) free(prog->op);
+	if (prog->pool != NULL) free(prog->pool);
+	if (prog->out != NULL) free(prog->out);
+	if (prog->cache != NULL) free(prog->cache);
+	free(prog);
+}
@@ -0,0 +1,92 @@
+/**
+ * @file format.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#ifndef __FORMAT_H__
+#define __FORMAT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "utility/tchar.h"
+#include "stats.h"
+
+
+/** Output format program operation types. */
+typedef enum tFmtOpType {
+	FOT_LITERAL = 0, /**< string literal with resolved escape sequences */
+	FOT_TIME,        /**< single strftime() format code with cached output */
+	FOT_TIME_FIELD,  /**< time field which is formatted without strftime() */
+	FOT_VALUE        /**< sensor value with printf() %f modifiers */
+} tFmtOpType;
+
+
+/** Statistics which can be output for a sensor value. */
+typedef enum tFmtStat {
+	FST_MEAN = 0, /**< arithmetic mean (no suffix) */
+	FST_MIN,      /**< minimum (suffix "min") */
+	FST_MAX,      /**< maximum (suffix "max") */
+	FST_SD,       /**< sample standard deviation (suffix "sd") */
+	FST_MEDIAN    /**< approximated median (suffix "med") */
+} tFmtStat;
+
+
+/** Output format program compiler error codes. */
+typedef enum tFmtError {
+	FMTE_SUCCESS = 0,
+	FMTE_NO_MEM,
+	FMTE_OVERFLOW,
+	FMTE_SYNTAX,
+	FMTE_API,
+	FMTE_VALUE
+} tFmtError;
+
+
+/** Output format program compiler modes. */
+typedef enum tFmtMode {
+	FMTM_RECORD = 0, /**< output record with escape sequences, time and sensor value format codes */
+	FMTM_PATH        /**< file path with time format codes only; backslashes are kept as is */
+} tFmtMode;
+
+
+/** Single output format program operation. */
+typedef struct tFmtOp {
+	tFmtOpType type;
+	/**
+	 * value type (A, C, D, F, H, I, N or X) for FOT_VALUE, format code for FOT_TIME_FIELD or S for FOT_TIME if
+	 * the output changes every second (else M)
+	 */
+	int subType;
+	tFmtStat stat; /**< statistic of the value for FOT_VALUE */
+	unsigned int width; /**< number of fractional second digits for FOT_TIME_FIELD */
+	size_t offset; /**< string offset in tFmtProg::pool */
+	size_t length; /**< string length in number of bytes */
+	size_t cacheOffset; /**< output offset in tFmtProg::cache for FOT_TIME */
+	size_t cacheLength; /**< cached output length in number of bytes for FOT_TIME */
+} tFmtOp;
+
+
+/** Compiled output format string. */
+typedef struct tFmtProg {
+	tFmtOp * op; /**< list of operations */
+	size_t count; /**< number of operations */
+	char * pool; /**< UTF-8 literals and null-terminated strftime()/printf() format codes */
+	char * out; /**< null-terminated UTF-8 output of the last fmtRun() call */
+	size_t outSize; /**< capacity of out in number of bytes */
+	char * cache; /**< output of the FOT_TIME operations of the last fmtRun() call */
+	int cacheValid; /**< non-zero if timeInfo and cache are valid */
+	int utc; /**< non-zero if timeInfo is given in UTC */
+	time_t time; /**< time of the last fmtRun() call in seconds since the epoch */
+	struct tm timeInfo; /**< broken-down time of the last fmtRun() call */
+} tFmtProg;
+
+
+tFmtProg * fmtCompile(const TCHAR * fmt, const tFmtMode mode, tFmtError * err, size_t * errPos);
+int fmtRun(tFmtProg * prog, const int64_t timeMs, const int utc, const unsigned int channel, const tStats * temp, const tStats * rh);
+void fmtDelete(tFmtProg * prog);
+
+
+#endif /* __FORMAT_H__ */
@@ -0,0 +1,237 @@
+/**
+ * @file metrics.c
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "utility/target.h"
+#include "metrics.h"
+
+
+#if defined(PCF_IS_WIN)
+#include <windows.h>
+#elif !defined(PCF_IS_LINUX)
+#error Unsupported target OS.
+#endif
+
+
+/** Atomically loads the counter at p. */
+#define MET_GET(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+
+
+/** Describes a counter of tMetrics. */
+typedef struct tMetCounter {
+	const char * name; /**< metric name */
+	const char * help; /**< metric description */
+	size_t offset; /**< offset of the counter within tMetrics */
+} tMetCounter;
+
+
+/** Describes a histogram of tMetrics. */
+typedef struct tMetHistogram {
+	const char * name; /**< metric name */
+	const char * help; /**< metric description */
+	size_t offset; /**< offset of the histogram within tMetrics */
+} tMetHistogram;
+
+
+static const tMetCounter counters[] = {
+	{"thlog_read_bytes_total", "Number of bytes read from the device.", offsetof(tMetrics, bytes)},
+	{"thlog_lines_parsed_total", "Number of ASCII lines parsed.", offsetof(tMetrics, lines)},
+	{"thlog_frames_parsed_total", "Number of binary frames parsed.", offsetof(tMetrics, frames)},
+	{"thlog_samples_accepted_total", "Number of accepted samples.", offsetof(tMetrics, samples)},
+	{"thlog_checksum_failures_total", "Number of lines and frames with invalid checksum.", offsetof(tMetrics, checksumErrors)},
+	{"thlog_frames_lost_total", "Number of frames lost according to the sequence number.", offsetof(tMetrics, lostFrames)},
+	{"thlog_reconnects_total", "Number of successful reconnections to the device.", offsetof(tMetrics, reconnects)},
+	{"thlog_outputs_total", "Number of output lines and records.", offsetof(tMetrics, outputs)}
+};
+
+
+static const tMetHistogram histograms[] = {
+	{"thlog_read_duration_seconds", "Time to read and parse a chunk of received data.", offsetof(tMetrics, readTime)},
+	{"thlog_write_duration_seconds", "Time to format and write a line or record.", offsetof(tMetrics, writeTime)}
+};
+
+
+/** Label values of the device error code counters by index. */
+static const char * errorCodes[MET_DEVICE_ERRORS] = {
+	"other",
+	"timeout",
+	"not_ready",
+	"timing_error",
+	"parity_error"
+};
+
+
+/**
+ * Writes the given string as label value with escaped backslashes, double quotes and line feeds.
+ *
+ * @param[in,out] fd - output file
+ * @param[in] str - null-terminated UTF-8 string
+ */
+static void writeLabel(FILE * fd, const char * str) {
+	fputc('"', fd);
+	for (const char * ptr = (str != NULL) ? str : ""; *ptr != 0; ptr++) {
+		switch (*ptr) {
+		case '\\': fputs("\\\\", fd); break;
+		case '"': fputs("\\\"", fd); break;
+		case '\n': fputs("\\n", fd); break;
+		default: fputc(*ptr, fd); break;
+		}
+	}
+	fputc('"', fd);
+}
+
+
+/**
+ * Returns the current time of a monotonic clock in microseconds. The clock is only useful to
+ * measure time differences.
+ *
+ * @return current monotonic time in microseconds
+ */
+uint64_t metClockUs(void) {
+#if defined(PCF_IS_WIN)
+	static LARGE_INTEGER freq = {0};
+	LARGE_INTEGER count;
+	if (freq.QuadPart == 0 && QueryPerformanceFrequency(&freq) == 0) return (uint64_t)GetTickCount64() * 1000;
+	QueryPerformanceCounter(&count);
+	return (uint64_t)((count.QuadPart / freq.QuadPart) * 1000000 + ((count.QuadPart % freq.QuadPart) * 1000000) / freq.QuadPart);
+#elif defined(PCF_IS_LINUX)
+	struct timespec ts;
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) return 0;
+	return ((uint64_t)(ts.tv_sec) * 1000000) + (uint64_t)(ts.tv_nsec / 1000);
+#endif
+}
+
+
+/**
+ * Adds the given value to the passed histogram.
+ *
+ * @param[in,out] hist - histogram to update
+ * @param[in] us - value in microseconds
+ */
+void metHistAdd(tMetHist * hist, const uint64_t us) {
+	if (hist == NULL) return;
+	size_t i = 0;
+	while (i < (MET_HIST_BUCKETS - 1) && (UINT64_C(1) << i) < us) i++;
+	MET_INC(hist->bucket + i);
+	MET_ADD(&(hist->sum), us);
+}
+
+
+/**
+ * Counts the given error code reported by the device.
+ *
+ * @param[in,out] met - device counters
+ * @param[in] code - error code
+ */
+void metDeviceError(tMetrics * met, const unsigned code) {
+	if (met == NULL) return;
+	MET_INC(met->deviceErrors + ((code < MET_DEVICE_ERRORS) ? code : 0));
+}
+
+
+/**
+ * Writes the given counters in the Prometheus text exposition format. Each device is labeled
+ * with its name.
+ *
+ * @param[in,out] fd - output file
+ * @param[in] met - list of device counters
+ * @param[in] count - number of entries in met
+ * @param[in] loops - event loop counters
+ * @return 1 on success, else 0
+ */
+int metWrite(FILE * fd, const tMetrics * const * met, const size_t count, const tMetLoops * loops) {
+	size_t i, j, k;
+	if (fd == NULL || (met == NULL && count > 0) || loops == NULL) return 0;
+	for (i = 0; i < (sizeof(counters) / sizeof(*counters)); i++) {
+		fprintf(fd, "# HELP %s %s\n# TYPE %s counter\n", counters[i].name, counters[i].help, counters[i].name);
+		for (j = 0; j < count; j++) {
+			const size_t * value = (const size_t *)((const char *)(met[j]) + counters[i].offset);
+			fprintf(fd, "%s{device=", counters[i].name);
+			writeLabel(fd, met[j]->name);
+			fprintf(fd, "} %lu\n", (unsigned long)MET_GET(value));
+		}
+	}
+	fputs("# HELP thlog_device_errors_total Number of errors reported by the device by error code.\n# TYPE thlog_device_errors_total counter\n", fd);
+	for (j = 0; j < count; j++) {
+		for (k = 0; k < MET_DEVICE_ERRORS; k++) {
+			fputs("thlog_device_errors_total{device=", fd);
+			writeLabel(fd, met[j]->name);
+			fprintf(fd, ",code=\"%s\"} %lu\n", errorCodes[k], (unsigned long)MET_GET(met[j]->deviceErrors + k));
+		}
+	}
+	for (i = 0; i < (sizeof(histograms) / sizeof(*histograms)); i++) {
+		fprintf(fd, "# HELP %s %s\n# TYPE %s histogram\n", histograms[i].name, histograms[i].help, histograms[i].name);
+		for (j = 0; j < count; j++) {
+			const tMetHist * hist = (const tMetHist *)((const char *)(met[j]) + histograms[i].offset);
+			size_t total = 0;
+			for (k = 0; k < MET_HIST_BUCKETS; k++) {
+				total += MET_GET(hist->bucket + k);
+				fprintf(fd, "%s_bucket{device=", histograms[i].name);
+				writeLabel(fd, met[j]->name);
+				if (k < (MET_HIST_BUCKETS - 1)) {
+					fprintf(fd, ",le=\"%.6f\"} %lu\n", (double)(UINT64_C(1) << k) / 1000000.0, (unsigned long)total);
+				} else {
+					fprintf(fd, ",le=\"+Inf\"} %lu\n", (unsigned long)total);
+				}
+			}
+			fprintf(fd, "%s_sum{device=", histograms[i].name);
+			writeLabel(fd, met[j]->name);
+			fprintf(fd, "} %.6f\n", (double)MET_GET(&(hist->sum)) / 1000000.0);
+			fprintf(fd, "%s_count{device=", histograms[i].name);
+			writeLabel(fd, met[j]->name);
+			fprintf(fd, "} %lu\n", (unsigned long)total);
+		}
+	}
+	fprintf(fd,
+		"# HELP thlog_wakeups_total Number of event loop wakeups.\n"
+		"# TYPE thlog_wakeups_total counter\n"
+		"thlog_wakeups_total{loop=\"input\"} %lu\n"
+		"thlog_wakeups_total{loop=\"output\"} %lu\n",
+		(unsigned long)MET_GET(&(loops->inputWakeups)),
+		(unsigned long)MET_GET(&(loops->outputWakeups))
+	);
+	return (ferror(fd) == 0) ? 1 : 0;
+}
+
+
+/**
+ * Writes the given counters in the Prometheus text exposition format to the passed file. The
+ * content is written to a temporary file next to it first, which then replaces the file. Readers
+ * like the textfile collector of the node exporter never see a partially written file this way.
+ *
+ * @param[in] path - output file path
+ * @param[in] met - list of device counters
+ * @param[in] count - number of entries in met
+ * @param[in] loops - event loop counters
+ * @return 1 on success, else 0
+ */
+int metWriteFile(const TCHAR * path, const tMetrics * const * met, const size_t count, const tMetLoops * loops) {
+	static const TCHAR suffix[] = _T(".tmp");
+	if (path == NULL) return 0;
+	const size_t len = _tcslen(path);
+	TCHAR * tmp = (TCHAR *)malloc((len + (sizeof(suffix) / sizeof(*suffix))) * sizeof(TCHAR));
+	if (tmp == NULL) return 0;
+	memcpy(tmp, path, len * sizeof(TCHAR));
+	memcpy(tmp + len, suffix, sizeof(suffix));
+	int res = 0;
+	FILE * fd = _tfopen(tmp, _T("wb"));
+	if (fd != NULL) {
+		res = metWrite(fd, met, count, loops);
+		if (fclose(fd) != 0) res = 0;
+#if defined(PCF_IS_WIN)
+		if (res != 0 && MoveFileEx(tmp, path, MOVEFILE_REPLACE_EXISTING) == 0) res = 0;
+		if (res == 0) DeleteFile(tmp);
+#elif defined(PCF_IS_LINUX)
+		if (res != 0 && rename(tmp, path) != 0) res = 0;
+		if (res == 0) remove(tmp);
+#endif
+	}
+	free(tmp);
+	return res;
+}
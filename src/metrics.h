@@ -0,0 +1,81 @@
+/**
+ * @file metrics.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Cheap operational counters of the input processing and output. The counters are updated with
+ * relaxed atomic operations and may be read from another thread at any time. They are exported
+ * in the Prometheus text exposition format.
+ */
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "utility/tchar.h"
+
+
+/**
+ * Number of buckets of a latency histogram. Bucket i counts the values up to 2^i microseconds.
+ * The last bucket counts all larger values.
+ */
+#define MET_HIST_BUCKETS 20
+
+
+/**
+ * Number of device error code counters. Index 1 to 4 count the DHT error codes (see
+ * arduino/DHT11.hpp and arduino/DHT22.hpp), index 0 all other codes.
+ */
+#define MET_DEVICE_ERRORS 5
+
+
+/** Latency histogram with logarithmic buckets. */
+typedef struct tMetHist {
+	size_t bucket[MET_HIST_BUCKETS]; /**< number of values per bucket (not cumulative) */
+	uint64_t sum; /**< sum of all values in microseconds */
+} tMetHist;
+
+
+/** Counters of a single device. */
+typedef struct tMetrics {
+	const char * name; /**< UTF-8 encoded device name used as label value */
+	size_t bytes; /**< number of bytes read */
+	size_t lines; /**< number of ASCII lines parsed */
+	size_t frames; /**< number of binary frames parsed */
+	size_t samples; /**< number of accepted samples (summaries count as their number of samples) */
+	size_t checksumErrors; /**< number of lines and frames with invalid checksum */
+	size_t lostFrames; /**< number of frames lost according to the sequence number */
+	size_t deviceErrors[MET_DEVICE_ERRORS]; /**< number of reported device errors by error code */
+	size_t reconnects; /**< number of successful reconnections */
+	size_t outputs; /**< number of output lines and records */
+	tMetHist readTime; /**< time to read and parse a chunk of received data */
+	tMetHist writeTime; /**< time to format and write a line or record */
+} tMetrics;
+
+
+/** Counters of the event loops. */
+typedef struct tMetLoops {
+	size_t inputWakeups; /**< number of times the input loop woke up */
+	size_t outputWakeups; /**< number of times the output loop woke up */
+} tMetLoops;
+
+
+/** Atomically adds v to the counter at p. */
+#define MET_ADD(p, v) ((void)__atomic_add_fetch((p), (v), __ATOMIC_RELAXED))
+
+
+/** Atomically increments the counter at p. */
+#define MET_INC(p) MET_ADD((p), 1)
+
+
+uint64_t metClockUs(void);
+void metHistAdd(tMetHist * hist, const uint64_t us);
+void metDeviceError(tMetrics * met, const unsigned code);
+int metWrite(FILE * fd, const tMetrics * const * met, const size_t count, const tMetLoops * loops);
+int metWriteFile(const TCHAR * path, const tMetrics * const * met, const size_t count, const tMetLoops * loops);
+
+
+#endif /* __METRICS_H__ */
@@ -3,173 +3,254 @@
  * @author Daniel Starke
  * @copyright Copyright 2019 Daniel Starke
  * @date 2019-06-03
- * @version 2023-04-10
+ * @version 2026-10-14
  */
 #include <limits.h>
-#include <math.h>
 #include <stddef.h>
+#include <string.h>
 #include "parse.h"
 
 
+/** Returns non-zero if the given character is a decimal digit. */
+#define IS_DIGIT(x) (((unsigned)(x) - (unsigned)'0') < 10u)
+
+
+/** Returns non-zero if the given character separates two sensor values. */
+#define IS_BLANK(x) ((x) == ' ' || (x) == '\t')
+
+
 /**
- * Passive float parser. Supports sign, integral and fraction part separated by a dot. No other
- * forms are supported. Initialize ctx to zero (e.g. with memset) before calling this function the
- * first time. PFS_STOP is returned if the character provided signaled the end of the float. The
- * float can be retrieved from ctx->result.
+ * Integral part of a sensor value above which no further digit is accepted. This keeps the value in
+ * tenths including the rounding well within int32_t.
+ */
+#define PLINE_VALUE_MAX (INT32_MAX / 1000)
+
+
+/**
+ * Converts the decimal number at the given position to fixed-point tenths. Supports sign,
+ * integral and fraction part separated by a dot. Additional fraction digits round the result.
  *
- * @param[in,out] ctx - float parser context
- * @param[in] c - character to process
- * @return  1 - success
- * @return  0 - failed (check ctx->state for more details)
- * @return -1 - error
+ * @param[in] ptr - start of the number
+ * @param[in] end - end of the line
+ * @param[out] value - converted number in tenths
+ * @return pointer to the first character after the number or NULL on error
  */
-int parseFloat(tPFloatCtx * ctx, const int c) {
-	if (ctx == NULL) return -1;
-	switch (ctx->state) {
-	case PFS_START:
-		ctx->result = nanf("");
-		ctx->integral = 0;
-		ctx->fraction = 0;
-		ctx->digits = 0;
-		if (c == '-') {
-			ctx->state = PFS_INTEGRAL;
-			ctx->sign = -1.0f;
-		} else if (c >= '0' && c <= '9') {
-			ctx->state = PFS_INTEGRAL;
-			ctx->sign = 1.0f;
-			goto onIntegral;
-		} else if (c == '.') {
-			ctx->state = PFS_FRACTION;
-		} else {
-			ctx->state = PFS_ERROR_TOKEN;
-			return 0;
+static const char * parseTenths(const char * ptr, const char * end, int32_t * value) {
+	int32_t sign = 1;
+	int32_t result = 0;
+	int digits = 0;
+	if (ptr < end && *ptr == '-') {
+		sign = -1;
+		ptr++;
+	}
+	for (; ptr < end && IS_DIGIT(*ptr); ptr++, digits++) {
+		if (result > PLINE_VALUE_MAX) return NULL;
+		result = (result * 10) + (int32_t)(*ptr - '0');
+	}
+	result *= 10;
+	if (ptr < end && *ptr == '.') {
+		ptr++;
+		if (ptr < end && IS_DIGIT(*ptr)) {
+			result += (int32_t)(*ptr - '0');
+			ptr++;
+			digits++;
+			if (ptr < end && *ptr >= '5' && *ptr <= '9') result++;
+			while (ptr < end && IS_DIGIT(*ptr)) ptr++;
 		}
-		break;
-	case PFS_STOP:
-	case PFS_ERROR_TOKEN:
-	case PFS_ERROR_OVERFLOW:
-		return 0;
-	case PFS_INTEGRAL:
-onIntegral:
-		if (c >= '0' && c <= '9') {
-			const unsigned long old = ctx->integral;
-			ctx->integral = (ctx->integral * 10) + (unsigned long)(c - '0');
-			if (ctx->integral < old) {
-				ctx->state = PFS_ERROR_OVERFLOW;
-				return 0;
-			}
-		} else if (c == '.') {
-			ctx->state = PFS_FRACTION;
-		} else {
-			ctx->state = PFS_STOP;
-			ctx->result = ctx->sign * (float)(ctx->integral);
-			return 0;
+	}
+	if (digits == 0) return NULL;
+	*value = sign * result;
+	return ptr;
+}
+
+
+/**
+ * Decodes the given sensor value line into the passed context.
+ *
+ * @param[in,out] ctx - line parser context
+ * @param[in] line - line without line termination
+ * @param[in] length - number of characters in line
+ */
+static void decodeLine(tPLineCtx * ctx, const char * line, size_t length) {
+	static const char errPrefix[] = "Err:";
+	int32_t value[3];
+	size_t i;
+	if (length > 0 && line[length - 1] == '\r') length--;
+	const char * ptr = line;
+	const char * end = line + length;
+	ctx->type = PLT_NONE;
+	ctx->channel = 0;
+	ctx->line = line;
+	ctx->length = length;
+	if (length == 0) return;
+	if (IS_DIGIT(*ptr) && (ptr + 1) < end && ptr[1] == ':') {
+		/* channel number prefix: digit ':' */
+		if ((unsigned)(*ptr - '0') >= PROTO_MAX_CHANNELS) return;
+		ctx->channel = (uint8_t)(*ptr - '0');
+		ptr += 2;
+		if (ptr >= end || *ptr == '#') return;
+	}
+	if (*ptr == '#') {
+		ctx->type = PLT_CONTROL;
+	} else if (*ptr == 'E') {
+		/* error number: "Err:" [blanks] digits */
+		if ((size_t)(end - ptr) < (sizeof(errPrefix) - 1) || memcmp(ptr, errPrefix, sizeof(errPrefix) - 1) != 0) return;
+		for (ptr += sizeof(errPrefix) - 1; ptr < end && IS_BLANK(*ptr); ptr++);
+		if (ptr >= end || IS_DIGIT(*ptr) == 0) return;
+		unsigned int result = 0;
+		for (; ptr < end && IS_DIGIT(*ptr); ptr++) {
+			if (result > ((UINT_MAX - 9) / 10)) return;
+			result = (result * 10) + (unsigned int)(*ptr - '0');
 		}
-		break;
-	case PFS_FRACTION:
-		if (c >= '0' && c <= '9') {
-			const unsigned long old = ctx->fraction;
-			ctx->fraction = (ctx->fraction * 10) + (unsigned long)(c - '0');
-			if (ctx->fraction < old) {
-				ctx->state = PFS_REMAINING;
-				ctx->fraction = old;
-			} else {
-				ctx->digits++;
+		ctx->type = PLT_ERROR;
+		ctx->error = result;
+	} else {
+		/* sensor values: temperature, relative humidity and their sum separated by blanks */
+		for (i = 0; i < 3; i++) {
+			if (i > 0) {
+				if (ptr >= end || IS_BLANK(*ptr) == 0) return;
+				while (ptr < end && IS_BLANK(*ptr)) ptr++;
 			}
-		} else {
-			goto onEnd;
-		}
-		break;
-	case PFS_REMAINING:
-		if (c < '0' || c > '9') {
-onEnd:
-			ctx->state = PFS_STOP;
-			ctx->result = ctx->sign * (
-				(float)(ctx->integral) + ((float)(ctx->fraction) / powf(10.0f, (float)(ctx->digits)))
-			);
-			return 0;
+			ptr = parseTenths(ptr, end, value + i);
+			if (ptr == NULL) return;
 		}
-		break;
+		while (ptr < end && IS_BLANK(*ptr)) ptr++;
+		if (ptr != end) return;
+		ctx->type = (((int64_t)value[0] + (int64_t)value[1]) == (int64_t)value[2]) ? PLT_SAMPLE : PLT_CHECKSUM;
+		ctx->temp = value[0];
+		ctx->rh = value[1];
 	}
+}
+
+
+/**
+ * Appends the given characters to the incomplete line of the passed context.
+ *
+ * @param[in,out] ctx - line parser context
+ * @param[in] str - characters to append
+ * @param[in] len - number of characters in str
+ */
+static void appendLine(tPLineCtx * ctx, const char * str, const size_t len) {
+	if (ctx->overflow != 0) return;
+	if (len > (PLINE_SIZE - ctx->len)) {
+		ctx->overflow = 1;
+		return;
+	}
+	memcpy(ctx->buf + ctx->len, str, len);
+	ctx->len += len;
+}
+
+
+/**
+ * Sensor value line parser. Decodes the next line of the given chunk in a single pass. Supports
+ * lines with temperature, relative humidity and their sum (e.g. "21.5\t45.2\t66.7"), error numbers
+ * in the format "Err:#" with # as an unsigned integer and control lines starting with '#'. Sensor
+ * value and error lines may start with a channel number prefix (e.g. "1:Err:3"). Lines
+ * are terminated by '\n' with an optional preceding '\r' and may be split across chunks.
+ * Initialize ctx to zero (e.g. with memset) before calling this function the first time.
+ * The decoded line can be retrieved from ctx->type, ctx->channel, ctx->temp, ctx->rh, ctx->error,
+ * ctx->line and ctx->length. ctx->line is only valid until the next call.
+ *
+ * @param[in,out] ctx - line parser context
+ * @param[in,out] buf - chunk to parse; set to the first character after the decoded line
+ * @param[in,out] len - number of bytes in buf; set to the number of remaining bytes
+ * @return  1 - a line was decoded
+ * @return  0 - all bytes were consumed without completing a line
+ * @return -1 - error
+ */
+int parseLine(tPLineCtx * ctx, const uint8_t ** buf, size_t * len) {
+	if (ctx == NULL || buf == NULL || *buf == NULL || len == NULL) return -1;
+	const char * ptr = (const char *)(*buf);
+	const char * eol = (const char *)memchr(ptr, '\n', *len);
+	if (eol == NULL) {
+		/* keep the incomplete line for the next chunk */
+		appendLine(ctx, ptr, *len);
+		*buf += *len;
+		*len = 0;
+		return 0;
+	}
+	const size_t length = (size_t)(eol - ptr);
+	*buf += length + 1;
+	*len -= length + 1;
+	if (ctx->len == 0 && ctx->overflow == 0) {
+		/* complete line within the chunk */
+		decodeLine(ctx, ptr, length);
+		return 1;
+	}
+	appendLine(ctx, ptr, length);
+	decodeLine(ctx, ctx->buf, (ctx->overflow != 0) ? 0 : ctx->len);
+	ctx->len = 0;
+	ctx->overflow = 0;
 	return 1;
 }
 
 
 /**
- * Passive error number parser. Supports error numbers in the format "Err:#" with # as an unsigned
- * integer. No other forms are supported. The parser is case sensitive. Initialize ctx to zero
- * (e.g. with memset) before calling this function the first time. PES_STOP is returned if the
- * character provided signaled the end of the number. The number can be retrieved from ctx->result.
+ * Passive binary frame parser. Supports the frames defined in arduino/Protocol.h. Initialize ctx
+ * to zero (e.g. with memset) before calling this function the first time. PFRS_STOP is returned if
+ * the character provided completed a frame with a valid checksum. The frame content can be
+ * retrieved from ctx->type, ctx->channel, ctx->seq, ctx->status, ctx->count and ctx->value.
  *
- * @param[in,out] ctx - err parser context
+ * @param[in,out] ctx - binary frame parser context
  * @param[in] c - character to process
  * @return  1 - success
  * @return  0 - failed (check ctx->state for more details)
  * @return -1 - error
  */
-int parseErr(tPErrCtx * ctx, const int c) {
+int parseFrame(tPFrameCtx * ctx, const int c) {
 	if (ctx == NULL) return -1;
 	switch (ctx->state) {
-	case PES_START:
-		ctx->result = 0;
-		if (c == 'E') {
-			ctx->state = PES_E__;
+	case PFRS_START:
+		if (c == PROTO_SYNC) {
+			ctx->state = PFRS_TYPE;
+			ctx->buf[0] = (uint8_t)c;
+			ctx->len = 1;
 		} else {
-			ctx->state = PES_ERROR_TOKEN;
+			ctx->state = PFRS_ERROR_TOKEN;
 			return 0;
 		}
 		break;
-	case PES_STOP:
-	case PES_ERROR_TOKEN:
-	case PES_ERROR_OVERFLOW:
+	case PFRS_STOP:
+	case PFRS_ERROR_TOKEN:
+	case PFRS_ERROR_CHECKSUM:
 		return 0;
-	case PES_E__:
-		if (c == 'r') {
-			ctx->state = PES_ER_;
-		} else {
-			ctx->state = PES_ERROR_TOKEN;
+	case PFRS_TYPE:
+		if ((c & 0x80) != 0) {
+			ctx->state = PFRS_ERROR_TOKEN;
 			return 0;
 		}
-		break;
-	case PES_ER_:
-		if (c == 'r') {
-			ctx->state = PES_ERR;
-		} else {
-			ctx->state = PES_ERROR_TOKEN;
-			return 0;
-		}
-		break;
-	case PES_ERR:
-		if (c == ':') {
-			ctx->state = PES_INTEGRAL_START;
-		} else {
-			ctx->state = PES_ERROR_TOKEN;
+		switch (PROTO_FRAME_TYPE(c)) {
+		case PROTO_FRAME_SAMPLE:
+			ctx->count = PROTO_SAMPLE_VALUES;
+			break;
+		case PROTO_FRAME_SUMMARY:
+			ctx->count = PROTO_SUMMARY_VALUES;
+			break;
+		default:
+			ctx->state = PFRS_ERROR_TOKEN;
 			return 0;
 		}
+		ctx->state = PFRS_DATA;
+		ctx->buf[ctx->len++] = (uint8_t)c;
+		ctx->size = PROTO_FRAME_SIZE(ctx->count);
 		break;
-	case PES_INTEGRAL_START:
-		if (c >= '0' && c <= '9') {
-			ctx->state = PES_INTEGRAL;
-			ctx->result = (unsigned int)(c - '0');
-		} else if (c != ' ' && c != '\t') {
-			ctx->state = PES_ERROR_TOKEN;
+	case PFRS_DATA:
+		ctx->buf[ctx->len++] = (uint8_t)c;
+		if (ctx->len < ctx->size) break;
+		if (protoCrc8(ctx->buf + 1, ctx->size - 2) != ctx->buf[ctx->size - 1]) {
+			ctx->state = PFRS_ERROR_CHECKSUM;
 			return 0;
 		}
-		break;
-	case PES_INTEGRAL:
-		if (c >= '0' && c <= '9') {
-			const unsigned int old = ctx->result;
-			ctx->result = (ctx->result * 10) + (unsigned int)(c - '0');
-			if (ctx->result < old) {
-				ctx->state = PES_ERROR_OVERFLOW;
-				ctx->result = UINT_MAX;
-				return 0;
-			}
-		} else {
-			ctx->state = PES_STOP;
-			return 0;
+		ctx->state = PFRS_STOP;
+		ctx->type = PROTO_FRAME_TYPE(ctx->buf[1]);
+		ctx->channel = PROTO_FRAME_CHANNEL(ctx->buf[1]);
+		ctx->seq = ctx->buf[2];
+		ctx->status = ctx->buf[3];
+		for (size_t i = 0; i < ctx->count; i++) {
+			const uint8_t * ptr = ctx->buf + PROTO_HEADER_SIZE + (2 * i);
+			ctx->value[i] = (int16_t)((uint16_t)((uint16_t)ptr[0] | ((uint16_t)ptr[1] << 8)));
 		}
-		break;
+		return 0;
 	}
 	return 1;
 }
@@ -281,6 +362,7 @@ onType:
 		case 'e':
 		case 'E':
 		case 'F':
+		case 'f':
 		case 'g':
 		case 'G':
 		case 'h':
@@ -327,9 +409,14 @@ onType:
 		break;
 	case PFMTS_SUBTYPE:
 		switch (c) {
+		case 'A':
 		case 'C':
+		case 'D':
 		case 'F':
 		case 'H':
+		case 'I':
+		case 'N':
+		case 'X':
 			ctx->state = PFMTS_STOP;
 			ctx->subType = c;
 			return 0;
@@ -3,36 +3,39 @@
  * @author Daniel Starke
  * @copyright Copyright 2019 Daniel Starke
  * @date 2019-06-03
- * @version 2019-06-22
+ * @version 2026-10-14
  */
 #ifndef __PARSE_H__
 #define __PARSE_H__
 
+#include <stddef.h>
+#include <stdint.h>
+#include "arduino/Protocol.h"
 
-/** Float parser states. */
-typedef enum tPFloatState {
-	PFS_START = 0,
-	PFS_STOP,
-	PFS_ERROR_TOKEN,
-	PFS_ERROR_OVERFLOW,
-	PFS_INTEGRAL,
-	PFS_FRACTION,
-	PFS_REMAINING
-} tPFloatState;
-
-
-/** Error number parser states. */
-typedef enum tPErrState {
-	PES_START = 0,
-	PES_STOP,
-	PES_ERROR_TOKEN,
-	PES_ERROR_OVERFLOW,
-	PES_E__,
-	PES_ER_,
-	PES_ERR,
-	PES_INTEGRAL_START,
-	PES_INTEGRAL
-} tPErrState;
+
+/** Maximum length of a sensor value line in characters excluding the line termination. */
+#define PLINE_SIZE 64
+
+
+/** Sensor value line types. */
+typedef enum tPLineType {
+	PLT_NONE = 0,  /**< empty, unknown or too long line */
+	PLT_SAMPLE,    /**< sensor values with matching checksum */
+	PLT_CHECKSUM,  /**< sensor values with checksum mismatch */
+	PLT_ERROR,     /**< error number in the format "Err:#" */
+	PLT_CONTROL    /**< control line starting with '#' */
+} tPLineType;
+
+
+/** Binary frame parser states. */
+typedef enum tPFrameState {
+	PFRS_START = 0,
+	PFRS_STOP,
+	PFRS_ERROR_TOKEN,
+	PFRS_ERROR_CHECKSUM,
+	PFRS_TYPE,
+	PFRS_DATA
+} tPFrameState;
 
 
 /** Output format string parser states. */
@@ -60,22 +63,34 @@ typedef enum tPFmtFlag {
 } tPFmtFlag;
 
 
-/** Float parser context. */
-typedef struct tPFloatCtx {
-	tPFloatState state;
-	float result;
-	float sign;
-	unsigned long integral;
-	unsigned long fraction;
-	unsigned int digits;
-} tPFloatCtx;
-
-
-/** Error number parser context. */
-typedef struct tPErrCtx {
-	tPErrState state;
-	unsigned int result;
-} tPErrCtx;
+/** Sensor value line parser context. */
+typedef struct tPLineCtx {
+	tPLineType type; /**< type of the last line */
+	uint8_t channel; /**< sensor channel number of the last line */
+	int32_t temp; /**< temperature of the last line in tenths of degrees Celsius */
+	int32_t rh; /**< relative humidity of the last line in tenths of percent */
+	unsigned int error; /**< error number of the last line */
+	const char * line; /**< last line without line termination (not null-terminated) */
+	size_t length; /**< number of characters in line */
+	char buf[PLINE_SIZE]; /**< incomplete line of the previous chunks */
+	size_t len; /**< number of characters in buf */
+	int overflow; /**< non-zero if the incomplete line exceeds buf */
+} tPLineCtx;
+
+
+/** Binary frame parser context. */
+typedef struct tPFrameCtx {
+	tPFrameState state;
+	uint8_t type; /**< frame type (PROTO_FRAME_*) */
+	uint8_t channel; /**< sensor channel number */
+	uint8_t seq;
+	uint8_t status;
+	size_t count; /**< number of values */
+	int16_t value[PROTO_MAX_VALUES];
+	uint8_t buf[PROTO_FRAME_SIZE(PROTO_MAX_VALUES)];
+	size_t len; /**< number of bytes in buf */
+	size_t size; /**< expected frame size in bytes */
+} tPFrameCtx;
 
 
 /** Output format string parser context. */
@@ -89,8 +104,8 @@ typedef struct tPFmtCtx {
 } tPFmtCtx;
 
 
-int parseFloat(tPFloatCtx * ctx, const int c);
-int parseErr(tPErrCtx * ctx, const int c);
+int parseLine(tPLineCtx * ctx, const uint8_t ** buf, size_t * len);
+int parseFrame(tPFrameCtx * ctx, const int c);
 int parseFmt(tPFmtCtx * ctx, const int c);
 
 
@@ -0,0 +1,134 @@
+/**
+ * @file psychro.c
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#include <math.h>
+#include <stddef.h>
+#include "psychro.h"
+
+
+/** Magnus formula coefficient b. */
+#define MAGNUS_B 17.62
+/** Magnus formula coefficient c in degrees Celsius. */
+#define MAGNUS_C 243.12
+/** Magnus formula saturation vapour pressure at 0 degrees Celsius in hPa. */
+#define MAGNUS_E0 6.112
+/** Temperature of the first entry in esTable in degrees Celsius. */
+#define ES_TABLE_MIN -45
+/** Temperature of the last entry in esTable in degrees Celsius. */
+#define ES_TABLE_MAX 60
+
+
+/**
+ * Saturation vapour pressure over water in hPa for each degree Celsius from ES_TABLE_MIN to
+ * ES_TABLE_MAX, which is the valid range of the Magnus formula. The linear interpolation between
+ * the entries deviates less than 0.2% from the formula.
+ */
+static const double esTable[ES_TABLE_MAX - ES_TABLE_MIN + 1] = {
+	0.111708, 0.124521, 0.138654, 0.154225, 0.171365, 0.190212, 0.210916, 0.233638,
+	0.258551, 0.285841, 0.315707, 0.348362, 0.384035, 0.422970, 0.465428, 0.511689,
+	0.562050, 0.616829, 0.676365, 0.741017, 0.811171, 0.887233, 0.969638, 1.058845,
+	1.155344, 1.259651, 1.372317, 1.493923, 1.625084, 1.766450, 1.918710, 2.082591,
+	2.258860, 2.448326, 2.651843, 2.870310, 3.104675, 3.355935, 3.625139, 3.913389,
+	4.221846, 4.551727, 4.904309, 5.280933, 5.683005, 6.112000, 6.569460, 7.057002,
+	7.576318, 8.129176, 8.717427, 9.343004, 10.007926, 10.714300, 11.464327, 12.260302,
+	13.104617, 13.999764, 14.948343, 15.953057, 17.016720, 18.142263, 19.332730, 20.591287,
+	21.921225, 23.325960, 24.809042, 26.374151, 28.025110, 29.765880, 31.600569, 33.533435,
+	35.568887, 37.711492, 39.965979, 42.337239, 44.830334, 47.450498, 50.203142, 53.093856,
+	56.128417, 59.312791, 62.653137, 66.155811, 69.827371, 73.674581, 77.704416, 81.924064,
+	86.340935, 90.962660, 95.797098, 100.852342, 106.136719, 111.658799, 117.427399, 123.451582,
+	129.740670, 136.304241, 143.152139, 150.294476, 157.741634, 165.504276, 173.593345, 182.020071,
+	190.795976, 199.932875
+};
+
+
+/**
+ * Returns the natural logarithm of the given positive value. The mantissa is reduced to
+ * [sqrt(0.5), sqrt(2)) and approximated by the atanh series, which deviates less than 1e-7.
+ *
+ * @param[in] x - positive value
+ * @return ln(x)
+ */
+static double fastLog(const double x) {
+	int e;
+	double m = frexp(x, &e);
+	if (m < 0.70710678118654752) {
+		m *= 2.0;
+		e--;
+	}
+	const double s = (m - 1.0) / (m + 1.0);
+	const double s2 = s * s;
+	const double series = s * (2.0 + s2 * ((2.0 / 3.0) + s2 * ((2.0 / 5.0) + s2 * ((2.0 / 7.0) + s2 * (2.0 / 9.0)))));
+	return ((double)e * 0.69314718055994531) + series;
+}
+
+
+/**
+ * Returns the saturation vapour pressure over water at the given temperature. The value is
+ * interpolated from esTable within its range.
+ *
+ * @param[in] temp - temperature in degrees Celsius
+ * @return saturation vapour pressure in hPa
+ */
+static double saturationPressure(const double temp) {
+	if (temp >= (double)ES_TABLE_MIN && temp < (double)ES_TABLE_MAX) {
+		const double pos = temp - (double)ES_TABLE_MIN;
+		const int i = (int)pos;
+		const double frac = pos - (double)i;
+		return esTable[i] + (frac * (esTable[i + 1] - esTable[i]));
+	}
+	return MAGNUS_E0 * exp((MAGNUS_B * temp) / (MAGNUS_C + temp));
+}
+
+
+/**
+ * Returns the heat index according to the regression of the US National Weather Service.
+ *
+ * @param[in] temp - temperature in degrees Celsius
+ * @param[in] rh - relative humidity in percent
+ * @return heat index in degrees Celsius
+ */
+static double heatIndex(const double temp, const double rh) {
+	const double t = (temp * 1.8) + 32.0;
+	double hi = 0.5 * (t + 61.0 + ((t - 68.0) * 1.2) + (rh * 0.094));
+	if (((hi + t) * 0.5) >= 80.0) {
+		/* Rothfusz regression */
+		hi = -42.379 + (2.04901523 * t) + (10.14333127 * rh) - (0.22475541 * t * rh)
+			- (0.00683783 * t * t) - (0.05481717 * rh * rh) + (0.00122874 * t * t * rh)
+			+ (0.00085282 * t * rh * rh) - (0.00000199 * t * t * rh * rh);
+		if (rh < 13.0 && t > 80.0 && t < 112.0) {
+			hi -= ((13.0 - rh) * 0.25) * sqrt((17.0 - fabs(t - 95.0)) / 17.0);
+		} else if (rh > 85.0 && t > 80.0 && t < 87.0) {
+			hi += ((rh - 85.0) * 0.1) * ((87.0 - t) * 0.2);
+		}
+	}
+	return (hi - 32.0) / 1.8;
+}
+
+
+/**
+ * Computes the values derived from the given temperature and relative humidity. The dew point
+ * and absolute humidity are NAN for a relative humidity of zero or less.
+ *
+ * @param[out] out - derived values
+ * @param[in] temp - temperature in degrees Celsius
+ * @param[in] rh - relative humidity in percent
+ */
+void psychroCompute(tPsychro * out, const double temp, const double rh) {
+	if (out == NULL) return;
+	out->heatIndex = heatIndex(temp, rh);
+	if (rh <= 0.0) {
+		out->dewPoint = NAN;
+		out->absHumidity = NAN;
+		return;
+	}
+	/* Magnus formula solved for the temperature at the actual vapour pressure */
+	const double gamma = fastLog(rh / 100.0) + ((MAGNUS_B * temp) / (MAGNUS_C + temp));
+	out->dewPoint = (MAGNUS_C * gamma) / (MAGNUS_B - gamma);
+	/* ideal gas law with the specific gas constant of water vapour (461.5 J/(kg*K)) */
+	const double e = saturationPressure(temp) * rh / 100.0;
+	out->absHumidity = (e * 216.68) / (temp + 273.15);
+}
@@ -0,0 +1,26 @@
+/**
+ * @file psychro.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Values derived from temperature and relative humidity. The Magnus formula uses the same
+ * constants as the humidity correction of the firmware (see arduino.ino).
+ */
+#ifndef __PSYCHRO_H__
+#define __PSYCHRO_H__
+
+
+/** Values derived from a temperature and relative humidity pair. */
+typedef struct tPsychro {
+	double dewPoint; /**< dew point in degrees Celsius */
+	double absHumidity; /**< absolute humidity in g/m^3 */
+	double heatIndex; /**< heat index in degrees Celsius */
+} tPsychro;
+
+
+void psychroCompute(tPsychro * out, const double temp, const double rh);
+
+
+#endif /* __PSYCHRO_H__ */
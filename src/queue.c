@@ -0,0 +1,285 @@
+/**
+ * @file queue.c
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utility/thread.h"
+#include "queue.h"
+
+
+/** Assumed cache line size in bytes to separate the producer and consumer state. */
+#define QUEUE_CACHE_LINE 64
+
+
+/** Time between two checks for free space with QP_BLOCK in milliseconds. */
+#define QUEUE_BLOCK_DELAY 1
+
+
+/**
+ * Internal queue handle. The indices grow without bound and are masked to access the elements.
+ */
+struct tQueue {
+	uint8_t * elem; /**< capacity * elemSize bytes */
+	size_t elemSize; /**< size of a single element in bytes */
+	size_t capacity; /**< maximum number of elements (power of two) */
+	tQueuePolicy policy; /**< backpressure policy */
+	tThrEvent * event; /**< wakes up the consumer */
+	char pad0[QUEUE_CACHE_LINE];
+	/* producer state */
+	size_t head; /**< index of the next element to write */
+	size_t highWater; /**< maximum number of elements in the queue so far */
+	size_t dropped; /**< number of dropped elements */
+	size_t spilled; /**< number of elements stored in the spill file */
+	FILE * spill; /**< temporary file for elements which did not fit or NULL */
+	size_t spillRead; /**< index of the next element to read from the spill file */
+	size_t spillWrite; /**< index of the next element to write to the spill file */
+	int abort; /**< non-zero to stop waiting for free space */
+	char pad1[QUEUE_CACHE_LINE];
+	/* consumer state */
+	size_t tail; /**< index of the next element to read; advanced by the producer to drop */
+	int waiting; /**< non-zero if the consumer waits for new elements */
+};
+
+
+/**
+ * Wakes up the consumer if it waits for new elements.
+ *
+ * @param[in,out] queue - queue handle
+ */
+static void notify(tQueue * queue) {
+	/* order the preceding head update before the check of the consumer state */
+	THR_FENCE();
+	if (THR_LOAD(&(queue->waiting)) != 0) thr_signal(queue->event);
+}
+
+
+/**
+ * Appends the given element to the queue if there is room.
+ *
+ * @param[in,out] queue - queue handle
+ * @param[in] elem - element to add
+ * @return 1 on success, 0 if the queue is full
+ */
+static int tryPush(tQueue * queue, const void * elem) {
+	const size_t head = queue->head;
+	const size_t used = head - THR_LOAD(&(queue->tail));
+	if (used >= queue->capacity) return 0;
+	memcpy(queue->elem + ((head & (queue->capacity - 1)) * queue->elemSize), elem, queue->elemSize);
+	THR_STORE(&(queue->head), head + 1);
+	if ((used + 1) > queue->highWater) queue->highWater = used + 1;
+	return 1;
+}
+
+
+/**
+ * Appends the given element to the spill file of the queue.
+ *
+ * @param[in,out] queue - queue handle
+ * @param[in] elem - element to add
+ * @return 1 on success, else 0
+ */
+static int spillPush(tQueue * queue, const void * elem) {
+	if (queue->spill == NULL) {
+		queue->spill = tmpfile();
+		if (queue->spill == NULL) return 0;
+	}
+	if (fseek(queue->spill, (long)(queue->spillWrite * queue->elemSize), SEEK_SET) != 0) return 0;
+	if (fwrite(elem, queue->elemSize, 1, queue->spill) != 1) return 0;
+	queue->spillWrite++;
+	queue->spilled++;
+	return 1;
+}
+
+
+/**
+ * Creates a new queue.
+ *
+ * @param[in] capacity - minimal number of elements; rounded up to the next power of two
+ * @param[in] elemSize - size of a single element in bytes
+ * @param[in] policy - backpressure policy
+ * @return Handle on success, else NULL.
+ */
+tQueue * queueCreate(const size_t capacity, const size_t elemSize, const tQueuePolicy policy) {
+	if (capacity == 0 || elemSize == 0 || capacity > (SIZE_MAX / 2 / elemSize)) return NULL;
+	tQueue * res = (tQueue *)calloc(1, sizeof(tQueue));
+	if (res == NULL) return NULL;
+	res->capacity = 1;
+	while (res->capacity < capacity) res->capacity *= 2;
+	res->elemSize = elemSize;
+	res->policy = policy;
+	res->elem = (uint8_t *)malloc(res->capacity * elemSize);
+	res->event = thr_createEvent();
+	if (res->elem == NULL || res->event == NULL) {
+		queueDelete(res);
+		return NULL;
+	}
+	return res;
+}
+
+
+/**
+ * Adds the given element to the queue. This function may only be called by the producer.
+ *
+ * @param[in,out] queue - queue handle
+ * @param[in] elem - element to add
+ * @return 1 on success, 0 if the element was dropped
+ */
+int queuePush(tQueue * queue, const void * elem) {
+	if (queue == NULL || elem == NULL) return 0;
+	/* keep the order of the elements while the spill file is not empty */
+	if (queue->spillWrite > queue->spillRead && queueService(queue) != 0) {
+		if (spillPush(queue, elem) != 0) return 1;
+		queue->dropped++;
+		return 0;
+	}
+	while (tryPush(queue, elem) == 0) {
+		size_t tail = THR_LOAD(&(queue->tail));
+		switch (queue->policy) {
+		case QP_DROP:
+			/* fails if the consumer took the element in the meantime */
+			if (THR_CAS(&(queue->tail), &tail, tail + 1) != 0) queue->dropped++;
+			break;
+		case QP_BLOCK:
+			if (THR_LOAD(&(queue->abort)) != 0) {
+				queue->dropped++;
+				return 0;
+			}
+			notify(queue);
+			thr_sleep(QUEUE_BLOCK_DELAY);
+			break;
+		case QP_SPILL:
+			if (spillPush(queue, elem) != 0) return 1;
+			queue->dropped++;
+			return 0;
+		}
+	}
+	notify(queue);
+	return 1;
+}
+
+
+/**
+ * Moves elements from the spill file to the queue as long as there is room. This function may
+ * only be called by the producer.
+ *
+ * @param[in,out] queue - queue handle
+ * @return 1 if elements remain in the spill file, else 0
+ */
+int queueService(tQueue * queue) {
+	if (queue == NULL || queue->spill == NULL) return 0;
+	int moved = 0;
+	while (queue->spillRead < queue->spillWrite) {
+		const size_t head = queue->head;
+		if ((head - THR_LOAD(&(queue->tail))) >= queue->capacity) break;
+		if (fseek(queue->spill, (long)(queue->spillRead * queue->elemSize), SEEK_SET) != 0) break;
+		if (fread(queue->elem + ((head & (queue->capacity - 1)) * queue->elemSize), queue->elemSize, 1, queue->spill) != 1) break;
+		THR_STORE(&(queue->head), head + 1);
+		queue->spillRead++;
+		moved = 1;
+	}
+	if (moved != 0) notify(queue);
+	if (queue->spillRead < queue->spillWrite) return 1;
+	/* reuse the spill file from the start */
+	queue->spillRead = 0;
+	queue->spillWrite = 0;
+	return 0;
+}
+
+
+/**
+ * Stops a queuePush() call which waits for free space. All following calls drop their element
+ * if the queue is full. This function may be called from a signal handler.
+ *
+ * @param[in,out] queue - queue handle
+ */
+void queueAbort(tQueue * queue) {
+	if (queue == NULL) return;
+	THR_STORE(&(queue->abort), 1);
+}
+
+
+/**
+ * Removes the oldest element from the queue. This function may only be called by the consumer.
+ *
+ * @param[in,out] queue - queue handle
+ * @param[out] elem - set to the removed element
+ * @return 1 if an element was removed, 0 if the queue is empty
+ */
+int queuePop(tQueue * queue, void * elem) {
+	if (queue == NULL || elem == NULL) return 0;
+	for (;;) {
+		size_t tail = THR_LOAD(&(queue->tail));
+		if (tail == THR_LOAD(&(queue->head))) return 0;
+		memcpy(elem, queue->elem + ((tail & (queue->capacity - 1)) * queue->elemSize), queue->elemSize);
+		/* the copy is invalid if the producer dropped the element in the meantime */
+		if (THR_CAS(&(queue->tail), &tail, tail + 1) != 0) return 1;
+	}
+}
+
+
+/**
+ * Waits until the queue holds at least one element, queueWake() was called or the timeout
+ * elapsed. This function may only be called by the consumer.
+ *
+ * @param[in,out] queue - queue handle
+ * @param[in] timeout - timeout in milliseconds or THR_INFINITE
+ * @return 1 if woken up, 0 on timeout or -1 on error
+ */
+int queueWait(tQueue * queue, const size_t timeout) {
+	if (queue == NULL) return -1;
+	THR_STORE(&(queue->waiting), 1);
+	/* order the preceding consumer state update before the check of the head */
+	THR_FENCE();
+	int res = 1;
+	if (THR_LOAD(&(queue->tail)) == THR_LOAD(&(queue->head))) res = thr_wait(queue->event, timeout);
+	THR_STORE(&(queue->waiting), 0);
+	return res;
+}
+
+
+/**
+ * Wakes up the consumer within queueWait(). A call without a waiting consumer lets the next
+ * queueWait() call return immediately.
+ *
+ * @param[in,out] queue - queue handle
+ * @return 1 on success, else 0
+ */
+int queueWake(tQueue * queue) {
+	if (queue == NULL) return 0;
+	return thr_signal(queue->event);
+}
+
+
+/**
+ * Returns the statistics of the given queue. This function may only be called by the producer.
+ *
+ * @param[in] queue - queue handle
+ * @param[out] stats - set to the queue statistics
+ */
+void queueGetStats(const tQueue * queue, tQueueStats * stats) {
+	if (queue == NULL || stats == NULL) return;
+	stats->capacity = queue->capacity;
+	stats->highWater = queue->highWater;
+	stats->dropped = queue->dropped;
+	stats->spilled = queue->spilled;
+}
+
+
+/**
+ * Frees the given queue. The handle is invalid after this call.
+ *
+ * @param[in,out] queue - queue to free
+ */
+void queueDelete(tQueue * queue) {
+	if (queue == NULL) return;
+	if (queue->spill != NULL) fclose(queue->spill);
+	if (queue->event != NULL) thr_deleteEvent(queue->event);
+	if (queue->elem != NULL) free(queue->elem);
+	free(queue);
+}
@@ -0,0 +1,51 @@
+/**
+ * @file queue.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Bounded lock-free queue of fixed-size elements between a single producer and a single consumer
+ * thread. The backpressure policy decides what happens if the producer finds the queue full.
+ */
+#ifndef __QUEUE_H__
+#define __QUEUE_H__
+
+#include <stddef.h>
+
+
+/** Backpressure policies of a full queue. */
+typedef enum tQueuePolicy {
+	QP_DROP = 0, /**< drop the oldest element */
+	QP_BLOCK,    /**< wait until the consumer made room */
+	QP_SPILL     /**< store new elements in a temporary file until the consumer made room */
+} tQueuePolicy;
+
+
+/** Queue statistics. */
+typedef struct tQueueStats {
+	size_t capacity; /**< maximum number of elements in the queue */
+	size_t highWater; /**< maximum number of elements in the queue so far */
+	size_t dropped; /**< number of dropped elements */
+	size_t spilled; /**< number of elements stored in the temporary file */
+} tQueueStats;
+
+
+/**
+ * @internal single producer single consumer queue
+ */
+typedef struct tQueue tQueue;
+
+
+tQueue * queueCreate(const size_t capacity, const size_t elemSize, const tQueuePolicy policy);
+int queuePush(tQueue * queue, const void * elem);
+int queueService(tQueue * queue);
+void queueAbort(tQueue * queue);
+int queuePop(tQueue * queue, void * elem);
+int queueWait(tQueue * queue, const size_t timeout);
+int queueWake(tQueue * queue);
+void queueGetStats(const tQueue * queue, tQueueStats * stats);
+void queueDelete(tQueue * queue);
+
+
+#endif /* __QUEUE_H__ */
@@ -0,0 +1,161 @@
+/**
+ * @file record.c
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#include <math.h>
+#include <string.h>
+#include "record.h"
+
+
+/**
+ * Writes the given value in little endian byte order.
+ *
+ * @param[out] buf - output buffer
+ * @param[in] value - value to write
+ * @param[in] size - number of bytes to write
+ */
+static void putLe(uint8_t * buf, const uint64_t value, const size_t size) {
+	for (size_t i = 0; i < size; i++) buf[i] = (uint8_t)((value >> (8 * i)) & 0xFF);
+}
+
+
+/**
+ * Converts the given value to tenths of its unit. Values outside the range of the field are
+ * clamped.
+ *
+ * @param[in] value - value to convert
+ * @param[in,out] flags - REC_FLAG_CLAMPED is set if the value was clamped
+ * @return value in tenths
+ */
+static int16_t toTenths(const double value, uint16_t * flags) {
+	if (isnan(value)) return 0;
+	const double tenths = floor((value * 10.0) + 0.5);
+	if (tenths < (double)INT16_MIN || tenths > (double)INT16_MAX) {
+		*flags = (uint16_t)(*flags | REC_FLAG_CLAMPED);
+		return (tenths < 0.0) ? INT16_MIN : INT16_MAX;
+	}
+	return (int16_t)tenths;
+}
+
+
+/**
+ * Fills the given record with the mean values of the passed statistics.
+ *
+ * @param[out] rec - record to fill
+ * @param[in] time - end of the interval in milliseconds since the epoch
+ * @param[in] temp - temperature values in degrees Celsius
+ * @param[in] rh - relative humidity values in percent
+ * @param[in] flags - initial record flags (REC_FLAG_*)
+ */
+void recFromStats(tRecord * rec, const int64_t time, const tStats * temp, const tStats * rh, const uint16_t flags) {
+	if (rec == NULL || temp == NULL || rh == NULL) return;
+	rec->time = time;
+	rec->flags = flags;
+	rec->temp = toTenths(statsMean(temp), &(rec->flags));
+	rec->rh = toTenths(statsMean(rh), &(rec->flags));
+	if (temp->count > UINT16_MAX) {
+		rec->count = UINT16_MAX;
+		rec->flags = (uint16_t)(rec->flags | REC_FLAG_CLAMPED);
+	} else {
+		rec->count = (uint16_t)(temp->count);
+	}
+}
+
+
+/**
+ * Writes the file header for the given format.
+ *
+ * @param[out] buf - output buffer with space for REC_HEADER_SIZE bytes
+ * @param[in] format - binary output format
+ */
+void recHeader(uint8_t * buf, const tRecFormat format) {
+	if (buf == NULL) return;
+	if (format == RF_COLUMNAR) {
+		memcpy(buf, REC_MAGIC_COLUMNAR, 8);
+		putLe(buf + 8, REC_VERSION, 2);
+		putLe(buf + 10, REC_BLOCK_RECORDS, 2);
+		putLe(buf + 12, REC_BLOCK_SIZE, 4);
+	} else {
+		memcpy(buf, REC_MAGIC_BINARY, 8);
+		putLe(buf + 8, REC_VERSION, 2);
+		putLe(buf + 10, REC_SIZE, 2);
+		putLe(buf + 12, 0, 4);
+	}
+}
+
+
+/**
+ * Writes the given record as fixed-width binary record.
+ *
+ * @param[out] buf - output buffer with space for REC_SIZE bytes
+ * @param[in] rec - record to write
+ */
+void recEncode(uint8_t * buf, const tRecord * rec) {
+	if (buf == NULL || rec == NULL) return;
+	putLe(buf, (uint64_t)(rec->time), 8);
+	putLe(buf + 8, (uint16_t)(rec->temp), 2);
+	putLe(buf + 10, (uint16_t)(rec->rh), 2);
+	putLe(buf + 12, rec->count, 2);
+	putLe(buf + 14, rec->flags, 2);
+}
+
+
+/**
+ * Adds the given record to the passed columnar block.
+ *
+ * @param[in,out] block - columnar block
+ * @param[in] rec - record to add
+ * @return 1 if the block is complete afterwards, else 0
+ */
+int recBlockAdd(tRecBlock * block, const tRecord * rec) {
+	if (block == NULL || rec == NULL || block->count >= REC_BLOCK_RECORDS) return 1;
+	block->rec[block->count++] = *rec;
+	return (block->count >= REC_BLOCK_RECORDS) ? 1 : 0;
+}
+
+
+/**
+ * Writes the given columnar block with its header. Unused entries are written as zero.
+ *
+ * @param[out] buf - output buffer with space for REC_BLOCK_SIZE bytes
+ * @param[in] block - columnar block to write
+ */
+void recBlockEncode(uint8_t * buf, const tRecBlock * block) {
+	if (buf == NULL || block == NULL) return;
+	uint8_t * const timeCol = buf + REC_BLOCK_HEADER_SIZE;
+	uint8_t * const tempCol = timeCol + (8 * REC_BLOCK_RECORDS);
+	uint8_t * const rhCol = tempCol + (2 * REC_BLOCK_RECORDS);
+	uint8_t * const countCol = rhCol + (2 * REC_BLOCK_RECORDS);
+	uint8_t * const flagsCol = countCol + (2 * REC_BLOCK_RECORDS);
+	const size_t count = (block->count < REC_BLOCK_RECORDS) ? block->count : REC_BLOCK_RECORDS;
+	int64_t minTime = 0, maxTime = 0;
+	int16_t minTemp = 0, maxTemp = 0, minRh = 0, maxRh = 0;
+	uint16_t flags = 0;
+	memset(buf, 0, REC_BLOCK_SIZE);
+	for (size_t i = 0; i < count; i++) {
+		const tRecord * rec = block->rec + i;
+		if (i == 0 || rec->time < minTime) minTime = rec->time;
+		if (i == 0 || rec->time > maxTime) maxTime = rec->time;
+		if (i == 0 || rec->temp < minTemp) minTemp = rec->temp;
+		if (i == 0 || rec->temp > maxTemp) maxTemp = rec->temp;
+		if (i == 0 || rec->rh < minRh) minRh = rec->rh;
+		if (i == 0 || rec->rh > maxRh) maxRh = rec->rh;
+		flags = (uint16_t)(flags | rec->flags);
+		putLe(timeCol + (8 * i), (uint64_t)(rec->time), 8);
+		putLe(tempCol + (2 * i), (uint16_t)(rec->temp), 2);
+		putLe(rhCol + (2 * i), (uint16_t)(rec->rh), 2);
+		putLe(countCol + (2 * i), rec->count, 2);
+		putLe(flagsCol + (2 * i), rec->flags, 2);
+	}
+	putLe(buf, (uint64_t)count, 4);
+	putLe(buf + 4, flags, 2);
+	putLe(buf + 8, (uint64_t)minTime, 8);
+	putLe(buf + 16, (uint64_t)maxTime, 8);
+	putLe(buf + 24, (uint16_t)minTemp, 2);
+	putLe(buf + 26, (uint16_t)maxTemp, 2);
+	putLe(buf + 28, (uint16_t)minRh, 2);
+	putLe(buf + 30, (uint16_t)maxRh, 2);
+}
@@ -0,0 +1,132 @@
+/**
+ * @file record.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Binary output formats for long-term storage. All multi-byte values are little endian and all
+ * fields are naturally aligned if the file is mapped to memory. Both formats start with a file
+ * header of REC_HEADER_SIZE bytes:
+ * | Offset | Size | Content
+ * |-------:|-----:|----------------------------------------------------------
+ * |      0 |    8 | REC_MAGIC_BINARY or REC_MAGIC_COLUMNAR
+ * |      8 |    2 | format version (REC_VERSION)
+ * |     10 |    2 | record size (binary) or records per block (columnar)
+ * |     12 |    4 | block size in bytes (columnar) or zero (binary)
+ *
+ * Fixed-width binary records of REC_SIZE bytes follow the header of a binary file:
+ * | Offset | Size | Content
+ * |-------:|-----:|----------------------------------------------------------
+ * |      0 |    8 | end of the interval in milliseconds since the epoch (signed)
+ * |      8 |    2 | mean temperature in 0.1 degrees Celsius (signed)
+ * |     10 |    2 | mean relative humidity in 0.1 percent (signed)
+ * |     12 |    2 | number of samples
+ * |     14 |    2 | flags (REC_FLAG_*)
+ *
+ * Blocks of REC_BLOCK_SIZE bytes with up to REC_BLOCK_RECORDS records each follow the header of a
+ * columnar file. The last block of each session may be incomplete:
+ * | Offset | Size | Content
+ * |-------:|-----:|----------------------------------------------------------
+ * |      0 |    4 | N as number of records in this block
+ * |      4 |    2 | bitwise OR of the flags of all records
+ * |      6 |    2 | reserved (zero)
+ * |      8 |    8 | minimal time
+ * |     16 |    8 | maximal time
+ * |     24 |    2 | minimal temperature
+ * |     26 |    2 | maximal temperature
+ * |     28 |    2 | minimal relative humidity
+ * |     30 |    2 | maximal relative humidity
+ * |     32 |  8*C | time column with C = REC_BLOCK_RECORDS entries
+ * | 32+8*C |  2*C | temperature column
+ * |     .. |  2*C | relative humidity column
+ * |     .. |  2*C | number of samples column
+ * |     .. |  2*C | flags column
+ * Only the first N entries of each column are valid. The others are zero.
+ */
+#ifndef __RECORD_H__
+#define __RECORD_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "stats.h"
+
+
+/** File signature of binary record files. */
+#define REC_MAGIC_BINARY "thlogbin"
+
+
+/** File signature of columnar block files. */
+#define REC_MAGIC_COLUMNAR "thlogcol"
+
+
+/** Version of the binary output formats. */
+#define REC_VERSION 1
+
+
+/** Size of the file header in bytes. */
+#define REC_HEADER_SIZE 16
+
+
+/** Size of a single binary record in bytes. */
+#define REC_SIZE 16
+
+
+/** Number of records per columnar block. */
+#define REC_BLOCK_RECORDS 256
+
+
+/** Size of the columnar block header in bytes. */
+#define REC_BLOCK_HEADER_SIZE 32
+
+
+/** Size of a single columnar block in bytes. */
+#define REC_BLOCK_SIZE (REC_BLOCK_HEADER_SIZE + (16 * REC_BLOCK_RECORDS))
+
+
+/** Record flags. */
+#define REC_FLAG_SUMMARY 0x0001 /**< values were aggregated by the remote device */
+#define REC_FLAG_CLAMPED 0x0002 /**< a value exceeded the range of its field and was clamped */
+#define REC_FLAG_CHANNEL_MASK 0x0700 /**< sensor channel number of the values */
+
+
+/** Returns the record flags for the given sensor channel number. */
+#define REC_FLAG_CHANNEL(c) ((uint16_t)(((c) << 8) & REC_FLAG_CHANNEL_MASK))
+
+
+/** Returns the sensor channel number of the given record flags. */
+#define REC_CHANNEL(f) ((unsigned int)(((f) & REC_FLAG_CHANNEL_MASK) >> 8))
+
+
+/** Binary output formats. */
+typedef enum tRecFormat {
+	RF_BINARY = 0, /**< fixed-width binary records */
+	RF_COLUMNAR    /**< columnar blocks */
+} tRecFormat;
+
+
+/** Single output record. */
+typedef struct tRecord {
+	int64_t time; /**< end of the interval in milliseconds since the epoch */
+	int16_t temp; /**< mean temperature in 0.1 degrees Celsius */
+	int16_t rh; /**< mean relative humidity in 0.1 percent */
+	uint16_t count; /**< number of samples */
+	uint16_t flags; /**< record flags (REC_FLAG_*) */
+} tRecord;
+
+
+/** Columnar block which is being filled. */
+typedef struct tRecBlock {
+	size_t count; /**< number of records in rec */
+	tRecord rec[REC_BLOCK_RECORDS]; /**< records */
+} tRecBlock;
+
+
+void recFromStats(tRecord * rec, const int64_t time, const tStats * temp, const tStats * rh, const uint16_t flags);
+void recHeader(uint8_t * buf, const tRecFormat format);
+void recEncode(uint8_t * buf, const tRecord * rec);
+int recBlockAdd(tRecBlock * block, const tRecord * rec);
+void recBlockEncode(uint8_t * buf, const tRecBlock * block);
+
+
+#endif /* __RECORD_H__ */
@@ -0,0 +1,269 @@
+/**
+ * @file shm.c
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utility/target.h"
+#include "shm.h"
+
+
+#if defined(PCF_IS_WIN)
+#include <windows.h>
+#elif defined(PCF_IS_LINUX)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else /* not PCF_IS_WIN and not PCF_IS_LINUX */
+#error Unsupported target OS.
+#endif
+
+
+/**
+ * Internal shared memory segment handle.
+ */
+struct tShm {
+#if defined(PCF_IS_WIN)
+	HANDLE mapping; /**< file mapping object */
+#else /* PCF_IS_LINUX */
+	char * name; /**< POSIX shared memory object name */
+#endif
+	uint8_t * base; /**< mapped segment */
+	size_t size; /**< size of the mapped segment in bytes */
+	size_t slots; /**< number of slots */
+};
+
+
+/**
+ * Creates a zero initialized shared memory segment with the given name and number of slots. An
+ * existing segment with the same name is replaced.
+ *
+ * @param[in] name - segment name (e.g. /thlog on POSIX or Local\thlog on Windows)
+ * @param[in] slots - number of slots
+ * @return segment handle or NULL on error
+ */
+tShm * shmCreate(const TCHAR * name, const size_t slots) {
+	if (name == NULL || *name == 0 || slots == 0 || slots > 0xFFFF) return NULL;
+	tShm * shm = (tShm *)calloc(1, sizeof(tShm));
+	if (shm == NULL) return NULL;
+	shm->size = SHM_HEADER_SIZE + (slots * sizeof(tShmSlot));
+	shm->slots = slots;
+#if defined(PCF_IS_WIN)
+	shm->mapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)(shm->size), name);
+	if (shm->mapping == NULL) goto onError;
+	shm->base = (uint8_t *)MapViewOfFile(shm->mapping, FILE_MAP_ALL_ACCESS, 0, 0, shm->size);
+	if (shm->base == NULL) goto onError;
+	/* an existing mapping keeps its content */
+	memset(shm->base, 0, shm->size);
+#else /* PCF_IS_LINUX */
+	/* POSIX requires a leading slash for portable names */
+	const size_t len = strlen(name);
+	shm->name = (char *)malloc(len + 2);
+	if (shm->name == NULL) goto onError;
+	shm->name[0] = '/';
+	memcpy(shm->name + 1, name + ((*name == '/') ? 1 : 0), len + ((*name == '/') ? 0 : 1));
+	const int fd = shm_open(shm->name, O_RDWR | O_CREAT, 0644);
+	if (fd < 0) goto onError;
+	/* truncating to zero first clears an existing segment */
+	if (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)(shm->size)) != 0) {
+		close(fd);
+		shm_unlink(shm->name);
+		goto onError;
+	}
+	void * base = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) {
+		shm_unlink(shm->name);
+		goto onError;
+	}
+	shm->base = (uint8_t *)base;
+#endif
+	/* header */
+	memcpy(shm->base, SHM_MAGIC, 8);
+	const uint16_t version = SHM_VERSION;
+	const uint16_t slotSize = (uint16_t)sizeof(tShmSlot);
+	const uint32_t slotCount = (uint32_t)slots;
+	memcpy(shm->base + 8, &version, sizeof(version));
+	memcpy(shm->base + 10, &slotSize, sizeof(slotSize));
+	memcpy(shm->base + 12, &slotCount, sizeof(slotCount));
+	return shm;
+onError:
+#if defined(PCF_IS_WIN)
+	if (shm->mapping != NULL) CloseHandle(shm->mapping);
+#else /* PCF_IS_LINUX */
+	if (shm->name != NULL) free(shm->name);
+#endif
+	free(shm);
+	return NULL;
+}
+
+
+/**
+ * Returns the slot with the given index.
+ *
+ * @param[in,out] shm - segment handle
+ * @param[in] index - slot index
+ * @return slot or NULL if out of range
+ */
+tShmSlot * shmSlot(tShm * shm, const size_t index) {
+	if (shm == NULL || index >= shm->slots) return NULL;
+	return (tShmSlot *)(void *)(shm->base + SHM_HEADER_SIZE + (index * sizeof(tShmSlot)));
+}
+
+
+/**
+ * Starts writing the given slot.
+ *
+ * @param[in,out] slot - slot to write
+ */
+static void beginWrite(tShmSlot * slot) {
+	const uint32_t seq = __atomic_load_n(&(slot->seq), __ATOMIC_RELAXED);
+	__atomic_store_n(&(slot->seq), seq + 1, __ATOMIC_RELAXED);
+	/* the odd sequence number becomes visible before any of the following stores */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+
+/**
+ * Completes writing the given slot.
+ *
+ * @param[in,out] slot - slot written
+ */
+static void endWrite(tShmSlot * slot) {
+	const uint32_t seq = __atomic_load_n(&(slot->seq), __ATOMIC_RELAXED);
+	__atomic_store_n(&(slot->seq), seq + 1, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * Sets the given slot statistics from the passed value series.
+ *
+ * @param[out] out - slot statistics
+ * @param[in] stats - value series
+ */
+static void setStats(tShmStats * out, const tStats * stats) {
+	if (stats->count == 0) {
+		out->mean = NAN;
+		out->min = NAN;
+		out->max = NAN;
+		out->sd = NAN;
+		return;
+	}
+	out->mean = statsMean(stats);
+	out->min = stats->min;
+	out->max = stats->max;
+	out->sd = statsSd(stats);
+}
+
+
+/**
+ * Initializes the given slot for a sensor channel of a device.
+ *
+ * @param[in,out] slot - slot to initialize
+ * @param[in] name - UTF-8 encoded device name
+ * @param[in] channel - sensor channel number
+ */
+void shmInitSlot(tShmSlot * slot, const char * name, const unsigned int channel) {
+	if (slot == NULL || name == NULL) return;
+	beginWrite(slot);
+	slot->channel = (uint16_t)channel;
+	slot->flags = 0;
+	const size_t len = strlen(name);
+	memset(slot->name, 0, sizeof(slot->name));
+	memcpy(slot->name, name, (len < sizeof(slot->name)) ? len : sizeof(slot->name) - 1);
+	slot->count = 0;
+	slot->tempStats.mean = slot->tempStats.min = slot->tempStats.max = slot->tempStats.sd = NAN;
+	slot->rhStats = slot->tempStats;
+	endWrite(slot);
+}
+
+
+/**
+ * Publishes the given latest sample and the statistics of the current interval including it.
+ *
+ * @param[in,out] slot - slot to update
+ * @param[in] time - reception time in milliseconds since the epoch
+ * @param[in] temp - temperature in degrees Celsius
+ * @param[in] rh - relative humidity in percent
+ * @param[in] summary - non-zero if the values are the means of a summary frame
+ * @param[in] tempStats - temperature values of the current interval
+ * @param[in] rhStats - relative humidity values of the current interval
+ */
+void shmPublishSample(tShmSlot * slot, const int64_t time, const double temp, const double rh, const int summary, const tStats * tempStats, const tStats * rhStats) {
+	if (slot == NULL || tempStats == NULL || rhStats == NULL) return;
+	beginWrite(slot);
+	slot->flags = (uint16_t)(SHM_FLAG_SAMPLE | ((summary != 0) ? SHM_FLAG_SUMMARY : 0));
+	slot->time = time;
+	slot->temp = temp;
+	slot->rh = rh;
+	slot->count = (uint64_t)(tempStats->count);
+	setStats(&(slot->tempStats), tempStats);
+	setStats(&(slot->rhStats), rhStats);
+	endWrite(slot);
+}
+
+
+/**
+ * Publishes the statistics of the current interval. The latest sample remains unchanged.
+ *
+ * @param[in,out] slot - slot to update
+ * @param[in] tempStats - temperature values of the current interval
+ * @param[in] rhStats - relative humidity values of the current interval
+ */
+void shmPublishInterval(tShmSlot * slot, const tStats * tempStats, const tStats * rhStats) {
+	if (slot == NULL || tempStats == NULL || rhStats == NULL) return;
+	beginWrite(slot);
+	slot->count = (uint64_t)(tempStats->count);
+	setStats(&(slot->tempStats), tempStats);
+	setStats(&(slot->rhStats), rhStats);
+	endWrite(slot);
+}
+
+
+/**
+ * Copies the given slot if it is not written at the same time. This is the reader side of the
+ * sequence lock for consumers mapping the segment. The function does not wait. The caller may
+ * retry on failure.
+ *
+ * @param[in] slot - slot within the shared memory segment
+ * @param[out] out - consistent copy of the slot
+ * @return 1 on success, 0 if the slot was written meanwhile
+ */
+int shmRead(const tShmSlot * slot, tShmSlot * out) {
+	if (slot == NULL || out == NULL) return 0;
+	const uint32_t seq = __atomic_load_n(&(slot->seq), __ATOMIC_ACQUIRE);
+	if ((seq & 1) != 0) return 0;
+	memcpy(out, slot, sizeof(*out));
+	/* the copy completes before the sequence number is checked again */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if (__atomic_load_n(&(slot->seq), __ATOMIC_RELAXED) != seq) return 0;
+	out->seq = seq;
+	return 1;
+}
+
+
+/**
+ * Unmaps and removes the given shared memory segment. Consumers which mapped it keep their
+ * mapping. The handle is invalid after this call.
+ *
+ * @param[in,out] shm - segment handle
+ */
+void shmClose(tShm * shm) {
+	if (shm == NULL) return;
+#if defined(PCF_IS_WIN)
+	if (shm->base != NULL) UnmapViewOfFile(shm->base);
+	if (shm->mapping != NULL) CloseHandle(shm->mapping);
+#else /* PCF_IS_LINUX */
+	if (shm->base != NULL) munmap(shm->base, shm->size);
+	if (shm->name != NULL) {
+		shm_unlink(shm->name);
+		free(shm->name);
+	}
+#endif
+	free(shm);
+}
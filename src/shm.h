@@ -0,0 +1,107 @@
+/**
+ * @file shm.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Publication of the latest values in a shared memory segment for local consumers. The segment
+ * uses the native byte order and alignment of the host. It starts with a header of
+ * SHM_HEADER_SIZE bytes:
+ * | Offset | Size | Content
+ * |-------:|-----:|----------------------------------------------------------
+ * |      0 |    8 | SHM_MAGIC
+ * |      8 |    2 | layout version (SHM_VERSION)
+ * |     10 |    2 | slot size in bytes (SHM_SLOT_SIZE)
+ * |     12 |    4 | number of slots
+ * |     16 |   48 | reserved (zero)
+ *
+ * One slot of SHM_SLOT_SIZE bytes follows for each sensor channel of each device in the order of
+ * the devices on the command line, i.e. slot i holds channel i % SHM_CHANNELS of device
+ * i / SHM_CHANNELS (see tShmSlot). A single writer updates each slot under a sequence lock. The
+ * sequence number is odd while the slot is written and incremented again afterwards. Readers copy
+ * the slot and retry if the sequence number was odd or changed meanwhile (see shmRead()). Neither
+ * side blocks or performs a system call in the process.
+ */
+#ifndef __SHM_H__
+#define __SHM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "utility/tchar.h"
+#include "stats.h"
+
+
+/** Segment signature. */
+#define SHM_MAGIC "thlogshm"
+
+
+/** Version of the segment layout. */
+#define SHM_VERSION 1
+
+
+/** Size of the segment header in bytes. */
+#define SHM_HEADER_SIZE 64
+
+
+/** Size of a single slot in bytes. */
+#define SHM_SLOT_SIZE 192
+
+
+/** Number of slots per device (see PROTO_MAX_CHANNELS). */
+#define SHM_CHANNELS 8
+
+
+/** Size of the device name field in bytes including the terminating null character. */
+#define SHM_NAME_SIZE 56
+
+
+/** Slot flag: the latest sample fields are valid. */
+#define SHM_FLAG_SAMPLE 0x0001
+
+
+/** Slot flag: the latest sample holds the means of a summary frame of the remote device. */
+#define SHM_FLAG_SUMMARY 0x0002
+
+
+/** Statistics of a value series within the current interval. All NAN if there are no values. */
+typedef struct tShmStats {
+	double mean; /**< arithmetic mean */
+	double min; /**< minimal value */
+	double max; /**< maximal value */
+	double sd; /**< sample standard deviation */
+} tShmStats;
+
+
+/** Values of a single sensor channel. */
+typedef struct tShmSlot {
+	uint32_t seq; /**< sequence number (odd while written) */
+	uint16_t channel; /**< sensor channel number */
+	uint16_t flags; /**< SHM_FLAG_* */
+	char name[SHM_NAME_SIZE]; /**< null-terminated UTF-8 encoded device name (truncated) */
+	int64_t time; /**< reception time of the latest sample in milliseconds since the epoch */
+	double temp; /**< latest temperature in degrees Celsius */
+	double rh; /**< latest relative humidity in percent */
+	uint64_t count; /**< number of samples within the current interval */
+	tShmStats tempStats; /**< temperature within the current interval in degrees Celsius */
+	tShmStats rhStats; /**< relative humidity within the current interval in percent */
+	uint8_t reserved[SHM_SLOT_SIZE - 160]; /**< zero */
+} tShmSlot;
+
+
+/**
+ * @internal target specific
+ */
+typedef struct tShm tShm;
+
+
+tShm * shmCreate(const TCHAR * name, const size_t slots);
+tShmSlot * shmSlot(tShm * shm, const size_t index);
+void shmInitSlot(tShmSlot * slot, const char * name, const unsigned int channel);
+void shmPublishSample(tShmSlot * slot, const int64_t time, const double temp, const double rh, const int summary, const tStats * tempStats, const tStats * rhStats);
+void shmPublishInterval(tShmSlot * slot, const tStats * tempStats, const tStats * rhStats);
+int shmRead(const tShmSlot * slot, tShmSlot * out);
+void shmClose(tShm * shm);
+
+
+#endif /* __SHM_H__ */
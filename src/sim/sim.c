@@ -0,0 +1,840 @@
+/**
+ * @file sim.c
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Simulator of the device firmware for load tests of thlog without hardware.
+ * Each simulated device is a pseudo terminal which behaves like arduino/arduino.ino on a serial
+ * interface: it signals readiness to a new host, answers the commands defined in
+ * arduino/Protocol.h and sends ASCII lines, binary sample frames or summary frames at the
+ * configured rate. Errors of the sensor and the transmission can be injected. All devices are
+ * served by a single thread.
+ */
+#ifdef __linux__
+/* posix_openpt(), cfmakeraw() */
+#define _GNU_SOURCE
+#endif /* __linux__ */
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include "../utility/getopt.h"
+#include "../utility/target.h"
+#include "../arduino/Protocol.h"
+#include "../version.h"
+
+
+#if !defined(PCF_IS_LINUX)
+#error The device simulator needs pseudo terminals which are only supported on Linux.
+#endif /* not PCF_IS_LINUX */
+
+
+/** Defines the default time between two readings of the same sensor in milliseconds. */
+#define SIM_INTERVAL 2000
+
+
+/** Defines the default maximal deviation of each reading from the simulated value in tenths. */
+#define SIM_NOISE 5
+
+
+/** Defines the time between two checks of the disconnected devices for a new host in milliseconds. */
+#define SIM_HOST_CHECK 100
+
+
+/** Defines the maximal lag in milliseconds after which missed readings are skipped. */
+#define SIM_MAX_LAG 1000
+
+
+/** Defines the maximum length of a command line received from the host (see arduino.ino). */
+#define SIM_COMMAND_SIZE 16
+
+
+/** Defines the shortest and longest serial interface speed accepted by the device (see arduino.ino). */
+#define SIM_SPEED_MIN 1200UL
+#define SIM_SPEED_MAX 2000000UL
+
+
+/** Defines the aggregated readings of a single sensor within the current interval. */
+typedef struct tSimSummary {
+	uint16_t count; /**< number of successful readings */
+	int16_t tempMin; /**< minimal temperature */
+	int16_t tempMax; /**< maximal temperature */
+	int16_t rhMin; /**< minimal RH */
+	int16_t rhMax; /**< maximal RH */
+	int32_t tempSum; /**< sum of all temperatures */
+	int32_t rhSum; /**< sum of all RH values */
+	int64_t tempSqSum; /**< sum of all squared temperatures */
+	int64_t rhSqSum; /**< sum of all squared RH values */
+	uint8_t lastError; /**< last error code */
+} tSimSummary;
+
+
+/** Defines the state of a single simulated device. */
+typedef struct tSimDevice {
+	char * link; /**< symbolic link to the pseudo terminal */
+	int fd; /**< pseudo terminal master */
+	int connected; /**< non-zero if a host opened the pseudo terminal */
+	int binary; /**< non-zero if the binary protocol is active */
+	uint8_t sequence; /**< sequence number of the next frame */
+	uint8_t channel; /**< sensor channel of the next reading */
+	int64_t next; /**< monotonic time of the next reading in milliseconds */
+	int64_t aggrIntvl; /**< on-device aggregation interval in milliseconds or 0 */
+	int64_t aggrStart; /**< monotonic start time of the current aggregation interval */
+	uint32_t seed; /**< state of the pseudo random number generator */
+	int16_t temp[PROTO_MAX_CHANNELS]; /**< simulated temperature of each sensor in tenths */
+	int16_t rh[PROTO_MAX_CHANNELS]; /**< simulated RH of each sensor in tenths */
+	tSimSummary summary[PROTO_MAX_CHANNELS]; /**< aggregated readings of each sensor */
+	char command[SIM_COMMAND_SIZE]; /**< command line received from the host */
+	size_t commandLen; /**< number of characters in command */
+	uint64_t readings; /**< number of sent readings and summaries */
+	uint64_t bytes; /**< number of sent bytes */
+	uint64_t dropped; /**< number of bytes dropped because the host did not read them */
+	uint64_t connects; /**< number of host connections */
+} tSimDevice;
+
+
+/** Defines the simulation parameters. */
+typedef struct tSimConfig {
+	int64_t intvl; /**< time between two readings of the same sensor in milliseconds */
+	unsigned int sensors; /**< number of sensor channels per device */
+	int noise; /**< maximal deviation of each reading in tenths */
+	double errors; /**< probability of a sensor error code in percent */
+	double checksum; /**< probability of a checksum error in percent */
+	double garbage; /**< probability of garbage after a reading in percent */
+	int asciiOnly; /**< non-zero to ignore the commands like firmware without binary protocol */
+} tSimConfig;
+
+
+static volatile int signalReceived = 0;
+static int verbose = 1;
+static tSimConfig config = {SIM_INTERVAL, 1, SIM_NOISE, 0.0, 0.0, 0.0, 0};
+
+
+static void printHelp(void);
+static void handleSignal(int signum);
+static int parsePercent(const char * str, double * value);
+static int openDevice(tSimDevice * dev, const char * link, const uint32_t seed);
+static void closeDevice(tSimDevice * dev);
+static void connectDevice(tSimDevice * dev, const int64_t now);
+static void receiveCommands(tSimDevice * dev, const int64_t now);
+static void executeCommand(tSimDevice * dev, const char * cmd, const int64_t now);
+static void sendReading(tSimDevice * dev, const uint8_t channel);
+static void sendSummary(tSimDevice * dev);
+static size_t appendFrame(tSimDevice * dev, uint8_t * buf, const uint8_t type, const uint8_t status, const int16_t * values, const size_t count);
+static void sendData(tSimDevice * dev, const uint8_t * buf, const size_t len);
+static int chance(tSimDevice * dev, const double percent);
+static uint32_t nextRandom(tSimDevice * dev);
+static void raiseFileLimit(const size_t count);
+static int64_t getMonoMs(void);
+static double getCpuSec(void);
+
+
+/**
+ * Main entry point.
+ */
+int main(int argc, char ** argv) {
+	char POSIXLY_CORRECT[] = "POSIXLY_CORRECT=";
+	struct option longOptions[] = {
+		{"ascii",    no_argument,       NULL, 'a'},
+		{"checksum", required_argument, NULL, 'c'},
+		{"count",    required_argument, NULL, 'n'},
+		{"duration", required_argument, NULL, 'd'},
+		{"errors",   required_argument, NULL, 'e'},
+		{"garbage",  required_argument, NULL, 'g'},
+		{"help",     no_argument,       NULL, 'h'},
+		{"interval", required_argument, NULL, 'i'},
+		{"noise",    required_argument, NULL, 'r'},
+		{"sensors",  required_argument, NULL, 's'},
+		{"verbose",  no_argument,       NULL, 'v'},
+		{NULL, 0, NULL, 0}
+	};
+	int ret = EXIT_FAILURE;
+	tSimDevice * devs = NULL;
+	struct pollfd * fds = NULL;
+	size_t count = 1;
+	size_t devCount = 0;
+	int64_t duration = 0;
+	char * strNum;
+	size_t i;
+
+	/* ensure that the environment does not change the argument parser behavior */
+	putenv(POSIXLY_CORRECT);
+
+	while (1) {
+		const int res = getopt_long(argc, argv, ":ac:d:e:g:hi:n:r:s:v", longOptions, NULL);
+		long value;
+
+		if (res == -1) break;
+		switch (res) {
+		case 'a':
+			config.asciiOnly = 1;
+			break;
+		case 'c':
+			if (parsePercent(optarg, &(config.checksum)) == 0) goto onBadArg;
+			break;
+		case 'd':
+			value = strtol(optarg, &strNum, 10);
+			if (value < 0 || *strNum != 0) goto onBadArg;
+			duration = (int64_t)value * 1000;
+			break;
+		case 'e':
+			if (parsePercent(optarg, &(config.errors)) == 0) goto onBadArg;
+			break;
+		case 'g':
+			if (parsePercent(optarg, &(config.garbage)) == 0) goto onBadArg;
+			break;
+		case 'h':
+			printHelp();
+			return EXIT_SUCCESS;
+		case 'i':
+			value = strtol(optarg, &strNum, 10);
+			if (value < 1 || *strNum != 0) goto onBadArg;
+			config.intvl = (int64_t)value;
+			break;
+		case 'n':
+			value = strtol(optarg, &strNum, 10);
+			if (value < 1 || *strNum != 0) goto onBadArg;
+			count = (size_t)value;
+			break;
+		case 'r':
+			value = strtol(optarg, &strNum, 10);
+			if (value < 0 || value > 1000 || *strNum != 0) goto onBadArg;
+			config.noise = (int)value;
+			break;
+		case 's':
+			value = strtol(optarg, &strNum, 10);
+			if (value < 1 || value > PROTO_MAX_CHANNELS || *strNum != 0) goto onBadArg;
+			config.sensors = (unsigned int)value;
+			break;
+		case 'v':
+			verbose++;
+			break;
+		case ':':
+			fprintf(stderr, "Error: Option argument is missing for '%s'.\n", argv[optind - 1]);
+			return EXIT_FAILURE;
+		case '?':
+			fprintf(stderr, "Error: Unknown or ambiguous option '%s'.\n", argv[optind - 1]);
+			return EXIT_FAILURE;
+		default:
+			abort();
+		}
+		continue;
+onBadArg:
+		fprintf(stderr, "Error: Invalid value for option '-%c'. (%s)\n", (char)res, optarg);
+		return EXIT_FAILURE;
+	}
+	if (optind >= argc) {
+		printHelp();
+		return EXIT_FAILURE;
+	}
+
+	/* each link argument is numbered if more than one device is created per argument */
+	const size_t total = count * (size_t)(argc - optind);
+	raiseFileLimit(total);
+	devs = (tSimDevice *)calloc(total, sizeof(tSimDevice));
+	fds = (struct pollfd *)calloc(total, sizeof(struct pollfd));
+	if (devs == NULL || fds == NULL) {
+		fprintf(stderr, "Error: Failed to allocate memory.\n");
+		goto onError;
+	}
+	for (; optind < argc; optind++) {
+		for (i = 0; i < count; i++) {
+			const size_t size = strlen(argv[optind]) + 24;
+			char * link = (char *)malloc(size);
+			if (link == NULL) {
+				fprintf(stderr, "Error: Failed to allocate memory.\n");
+				goto onError;
+			}
+			if (count > 1) {
+				snprintf(link, size, "%s%u", argv[optind], (unsigned)i);
+			} else {
+				snprintf(link, size, "%s", argv[optind]);
+			}
+			const int res = openDevice(devs + devCount, link, (uint32_t)(devCount + 1) * UINT32_C(2654435761));
+			free(link);
+			if (res == 0) goto onError;
+			devCount++;
+		}
+	}
+
+	signal(SIGINT, handleSignal);
+	signal(SIGTERM, handleSignal);
+	if (verbose > 1) fprintf(stderr, "Info: Simulating %u devices.\n", (unsigned)devCount);
+
+	const int64_t start = getMonoMs();
+	const double cpuStart = getCpuSec();
+	int64_t hostCheck = start;
+	while (signalReceived == 0) {
+		int64_t now = getMonoMs();
+		if (duration > 0 && (now - start) >= duration) break;
+		/* pseudo terminals without host signal a hang-up which would end poll() at once */
+		if (now >= hostCheck) {
+			for (i = 0; i < devCount; i++) {
+				fds[i].fd = devs[i].fd;
+				fds[i].events = POLLIN;
+				fds[i].revents = 0;
+			}
+			if (poll(fds, (nfds_t)devCount, 0) < 0 && errno != EINTR) {
+				fprintf(stderr, "Error: Failed to wait for the hosts.\n");
+				goto onError;
+			}
+			for (i = 0; i < devCount; i++) {
+				const int connected = ((fds[i].revents & POLLHUP) == 0) ? 1 : 0;
+				if (connected != 0 && devs[i].connected == 0) {
+					connectDevice(devs + i, now);
+				} else if (connected == 0) {
+					devs[i].connected = 0;
+				}
+			}
+			hostCheck = now + SIM_HOST_CHECK;
+		}
+		/* send the due readings and summaries */
+		int64_t deadline = hostCheck;
+		for (i = 0; i < devCount; i++) {
+			tSimDevice * dev = devs + i;
+			if (dev->connected == 0) continue;
+			if (dev->binary != 0 && dev->aggrIntvl > 0) {
+				if ((now - dev->aggrStart) >= dev->aggrIntvl) sendSummary(dev);
+				deadline = PCF_MIN(deadline, dev->aggrStart + dev->aggrIntvl);
+			}
+			if ((now - dev->next) >= SIM_MAX_LAG) dev->next = now;
+			while (dev->next <= now) {
+				const uint8_t channel = dev->channel;
+				dev->channel = (uint8_t)((channel + 1) % config.sensors);
+				dev->next += PCF_MAX(config.intvl / (int64_t)(config.sensors), 1);
+				sendReading(dev, channel);
+			}
+			deadline = PCF_MIN(deadline, dev->next);
+		}
+		/* wait for commands from the hosts until the next deadline */
+		for (i = 0; i < devCount; i++) {
+			fds[i].fd = (devs[i].connected != 0) ? devs[i].fd : -1;
+			fds[i].events = POLLIN;
+			fds[i].revents = 0;
+		}
+		now = getMonoMs();
+		const int64_t timeout = PCF_MAX(deadline - now, 0);
+		const int res = poll(fds, (nfds_t)devCount, (int)timeout);
+		if (res < 0) {
+			if (errno == EINTR) continue;
+			fprintf(stderr, "Error: Failed to wait for the hosts.\n");
+			goto onError;
+		}
+		now = getMonoMs();
+		for (i = 0; i < devCount && res > 0; i++) {
+			if ((fds[i].revents & POLLHUP) != 0) {
+				devs[i].connected = 0;
+			} else if ((fds[i].revents & POLLIN) != 0) {
+				receiveCommands(devs + i, now);
+			}
+		}
+	}
+
+	/* report the load generated in total */
+	const double elapsed = (double)(getMonoMs() - start) / 1000.0;
+	const double cpu = getCpuSec() - cpuStart;
+	uint64_t readings = 0, bytes = 0, dropped = 0;
+	for (i = 0; i < devCount; i++) {
+		readings += devs[i].readings;
+		bytes += devs[i].bytes;
+		dropped += devs[i].dropped;
+		if (verbose > 2) {
+			fprintf(stderr, "Info: %s: %llu readings, %llu bytes, %llu bytes dropped, %llu connections.\n",
+				devs[i].link, (unsigned long long)(devs[i].readings), (unsigned long long)(devs[i].bytes),
+				(unsigned long long)(devs[i].dropped), (unsigned long long)(devs[i].connects));
+		}
+	}
+	if (verbose > 0) {
+		fprintf(stderr, "Info: Sent %llu readings (%.1f/s) and %llu bytes (%.0f/s) in %.1f s. %llu bytes were dropped.\n",
+			(unsigned long long)readings, (elapsed > 0.0) ? (double)readings / elapsed : 0.0,
+			(unsigned long long)bytes, (elapsed > 0.0) ? (double)bytes / elapsed : 0.0, elapsed,
+			(unsigned long long)dropped);
+		fprintf(stderr, "Info: Used %.3f s CPU time (%.2f us per reading, %.3f%% per device).\n",
+			cpu, (readings > 0) ? (cpu * 1e6) / (double)readings : 0.0,
+			(elapsed > 0.0 && devCount > 0) ? (100.0 * cpu) / (elapsed * (double)devCount) : 0.0);
+	}
+	ret = EXIT_SUCCESS;
+onError:
+	if (devs != NULL) {
+		for (i = 0; i < devCount; i++) closeDevice(devs + i);
+		free(devs);
+	}
+	if (fds != NULL) free(fds);
+	return ret;
+}
+
+
+/**
+ * Write the help for this application to standard error.
+ */
+static void printHelp(void) {
+	fprintf(stderr,
+	"thlog-sim [options] <link> [<link> ...]\n"
+	"\n"
+	"Simulates devices running the thlog firmware for load tests. Each device is a\n"
+	"pseudo terminal with the given symbolic link, e.g. /tmp/sim. The links are\n"
+	"numbered if more than one device is created per link, e.g. /tmp/sim0.\n"
+	"\n"
+	"-a, --ascii\n"
+	"      Ignores all commands like firmware without binary protocol support.\n"
+	"-c, --checksum <percent>\n"
+	"      Probability of a checksum error per reading. Default: 0\n"
+	"-d, --duration <number>\n"
+	"      Exits after the given number of seconds. Default: 0 (never)\n"
+	"-e, --errors <percent>\n"
+	"      Probability of a sensor error code per reading. Default: 0\n"
+	"-g, --garbage <percent>\n"
+	"      Probability of random bytes after a reading. Default: 0\n"
+	"-h, --help\n"
+	"      Print short usage instruction.\n"
+	"-i, --interval <number>\n"
+	"      Time between two readings of the same sensor in milliseconds. The\n"
+	"      sensors of a device are read one after another. Default: %u\n"
+	"-n, --count <number>\n"
+	"      Number of devices per link. Default: 1\n"
+	"-r, --noise <number>\n"
+	"      Maximal deviation of each reading from the slowly changing simulated\n"
+	"      value in tenths of degrees Celsius and percent. Default: %u\n"
+	"-s, --sensors <number>\n"
+	"      Number of sensors per device (1 to %u). Default: 1\n"
+	"-v, --verbose\n"
+	"      Increases verbosity.\n"
+	"\n"
+	"The number of readings, bytes and the CPU time used are reported on exit.\n"
+	"\n"
+	"thlog-sim %u.%u.%u\n"
+	"https://github.com/daniel-starke/thlog\n"
+	, (unsigned)SIM_INTERVAL
+	, (unsigned)SIM_NOISE
+	, (unsigned)PROTO_MAX_CHANNELS
+	, PROGRAM_VERSION);
+}
+
+
+/**
+ * Handles external signals.
+ *
+ * @param[in] signum - received signal number
+ */
+static void handleSignal(int signum) {
+	PCF_UNUSED(signum);
+	signalReceived++;
+}
+
+
+/**
+ * Parses the given probability in percent.
+ *
+ * @param[in] str - string to parse
+ * @param[out] value - set to the parsed value
+ * @return 1 on success, else 0
+ */
+static int parsePercent(const char * str, double * value) {
+	char * end;
+	const double res = strtod(str, &end);
+	if (end == str || *end != 0 || !(res >= 0.0 && res <= 100.0)) return 0;
+	*value = res;
+	return 1;
+}
+
+
+/**
+ * Creates a pseudo terminal for the given device and links it to the passed path. An existing
+ * symbolic link is replaced. Errors are reported on stderr.
+ *
+ * @param[out] dev - device to initialize
+ * @param[in] link - symbolic link path
+ * @param[in] seed - seed of the pseudo random number generator (non-zero)
+ * @return 1 on success, else 0
+ */
+static int openDevice(tSimDevice * dev, const char * link, const uint32_t seed) {
+	struct termios settings;
+	struct stat st;
+	memset(dev, 0, sizeof(*dev));
+	dev->seed = (seed != 0) ? seed : 1;
+	dev->fd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (dev->fd < 0) goto onError;
+	if (grantpt(dev->fd) != 0 || unlockpt(dev->fd) != 0) goto onError;
+	/* the serial interface transfers bytes unaltered */
+	if (tcgetattr(dev->fd, &settings) != 0) goto onError;
+	cfmakeraw(&settings);
+	if (tcsetattr(dev->fd, TCSANOW, &settings) != 0) goto onError;
+	if (fcntl(dev->fd, F_SETFL, fcntl(dev->fd, F_GETFL) | O_NONBLOCK) != 0) goto onError;
+	const char * name = ptsname(dev->fd);
+	if (name == NULL) goto onError;
+	/* the master signals a hang-up only after the slave was closed once */
+	const int slave = open(name, O_RDWR | O_NOCTTY);
+	if (slave < 0) goto onError;
+	close(slave);
+	if (lstat(link, &st) == 0) {
+		if ( ! S_ISLNK(st.st_mode) ) {
+			fprintf(stderr, "Error: '%s' exists and is no symbolic link.\n", link);
+			closeDevice(dev);
+			return 0;
+		}
+		unlink(link);
+	}
+	if (symlink(name, link) != 0) goto onError;
+	/* removed on exit */
+	dev->link = strdup(link);
+	if (dev->link == NULL) {
+		unlink(link);
+		goto onError;
+	}
+	for (size_t i = 0; i < PROTO_MAX_CHANNELS; i++) {
+		dev->temp[i] = (int16_t)(215 + (10 * (int)i));
+		dev->rh[i] = 450;
+	}
+	return 1;
+onError:
+	fprintf(stderr, "Error: Failed to create the pseudo terminal for '%s'.\n", link);
+	closeDevice(dev);
+	return 0;
+}
+
+
+/**
+ * Closes the pseudo terminal of the given device and removes its symbolic link.
+ *
+ * @param[in,out] dev - device to close
+ */
+static void closeDevice(tSimDevice * dev) {
+	if (dev->link != NULL) {
+		unlink(dev->link);
+		free(dev->link);
+		dev->link = NULL;
+	}
+	if (dev->fd >= 0) close(dev->fd);
+	dev->fd = -1;
+}
+
+
+/**
+ * Resets the given device to its power-on state for a new host and signals readiness like the
+ * firmware does.
+ *
+ * @param[in,out] dev - device
+ * @param[in] now - current monotonic time in milliseconds
+ */
+static void connectDevice(tSimDevice * dev, const int64_t now) {
+	static const char ready[] = PROTO_CMD_READY "\r\n";
+	dev->connected = 1;
+	dev->binary = 0;
+	dev->sequence = 0;
+	dev->aggrIntvl = 0;
+	dev->commandLen = 0;
+	dev->next = now;
+	dev->connects++;
+	if (verbose > 1) fprintf(stderr, "Info: Host connected to %s.\n", dev->link);
+	sendData(dev, (const uint8_t *)ready, sizeof(ready) - 1);
+}
+
+
+/**
+ * Reads and executes the command lines received from the host of the given device.
+ *
+ * @param[in,out] dev - device
+ * @param[in] now - current monotonic time in milliseconds
+ */
+static void receiveCommands(tSimDevice * dev, const int64_t now) {
+	uint8_t buf[256];
+	ssize_t len;
+	while ((len = read(dev->fd, buf, sizeof(buf))) > 0) {
+		for (ssize_t i = 0; i < len; i++) {
+			const char c = (char)buf[i];
+			if (c == '\r' || c == '\n') {
+				if (dev->commandLen > 0 && dev->commandLen < SIM_COMMAND_SIZE) {
+					dev->command[dev->commandLen] = 0;
+					executeCommand(dev, dev->command, now);
+				}
+				dev->commandLen = 0;
+			} else if (dev->commandLen < SIM_COMMAND_SIZE) {
+				/* a too long command line is discarded */
+				dev->command[dev->commandLen++] = c;
+			}
+		}
+	}
+	if (len == 0 || (len < 0 && errno == EIO)) dev->connected = 0;
+}
+
+
+/**
+ * Executes the given command line received from the host like the firmware does. Unknown commands
+ * are ignored.
+ *
+ * @param[in,out] dev - device
+ * @param[in] cmd - null-terminated command line
+ * @param[in] now - current monotonic time in milliseconds
+ */
+static void executeCommand(tSimDevice * dev, const char * cmd, const int64_t now) {
+	static const size_t baudLen = sizeof(PROTO_CMD_BAUD) - 1;
+	static const size_t aggrLen = sizeof(PROTO_CMD_AGGREGATE) - 1;
+	char line[SIM_COMMAND_SIZE + 2];
+	if (verbose > 2) fprintf(stderr, "Info: %s received \"%s\".\n", dev->link, cmd);
+	if (config.asciiOnly != 0) return;
+	const int len = snprintf(line, sizeof(line), "%s\r\n", cmd);
+	if (strncmp(cmd, PROTO_CMD_BAUD, baudLen) == 0 && cmd[baudLen] == ' ') {
+		char * end;
+		const unsigned long speed = strtoul(cmd + baudLen + 1, &end, 10);
+		if (*end != 0 || speed < SIM_SPEED_MIN || speed > SIM_SPEED_MAX) return;
+		/* pseudo terminals transfer at any speed */
+		sendData(dev, (const uint8_t *)line, (size_t)len);
+	} else if (strncmp(cmd, PROTO_CMD_AGGREGATE, aggrLen) == 0 && cmd[aggrLen] == ' ') {
+		char * end;
+		const unsigned long interval = strtoul(cmd + aggrLen + 1, &end, 10);
+		if (*end != 0 || interval > PROTO_AGGREGATE_MAX) return;
+		sendData(dev, (const uint8_t *)line, (size_t)len);
+		dev->aggrIntvl = (int64_t)interval * 1000;
+		dev->aggrStart = now;
+		memset(dev->summary, 0, sizeof(dev->summary));
+	} else if (strcmp(cmd, PROTO_CMD_READY) == 0) {
+		sendData(dev, (const uint8_t *)line, (size_t)len);
+	} else if (strcmp(cmd, PROTO_CMD_BINARY) == 0) {
+		/* acknowledge with the last ASCII line */
+		sendData(dev, (const uint8_t *)line, (size_t)len);
+		dev->binary = 1;
+		dev->sequence = 0;
+		dev->aggrStart = now;
+		memset(dev->summary, 0, sizeof(dev->summary));
+	} else if (strcmp(cmd, PROTO_CMD_ASCII) == 0) {
+		dev->binary = 0;
+	}
+}
+
+
+/**
+ * Sends a new reading of the given sensor of the passed device in the active protocol. The
+ * reading is added to the current summary instead if the device aggregates. Sensor errors,
+ * checksum errors and garbage are injected with the configured probability.
+ *
+ * @param[in,out] dev - device
+ * @param[in] channel - sensor channel number
+ */
+static void sendReading(tSimDevice * dev, const uint8_t channel) {
+	uint8_t buf[64];
+	size_t len = 0;
+	/* the simulated values change slowly */
+	const uint32_t r = nextRandom(dev);
+	dev->temp[channel] = (int16_t)PCF_MIN(PCF_MAX(dev->temp[channel] + (int)(r % 3) - 1, -400), 800);
+	dev->rh[channel] = (int16_t)PCF_MIN(PCF_MAX(dev->rh[channel] + (int)((r >> 2) % 3) - 1, 0), 1000);
+	const int span = (2 * config.noise) + 1;
+	const int16_t temp = (int16_t)(dev->temp[channel] + (int)((r >> 4) % (uint32_t)span) - config.noise);
+	const int16_t rh = (int16_t)PCF_MIN(PCF_MAX(dev->rh[channel] + (int)((r >> 14) % (uint32_t)span) - config.noise, 0), 1000);
+	const uint8_t status = (uint8_t)((chance(dev, config.errors) != 0) ? (1 + (nextRandom(dev) % 3)) : 0);
+	const int badChecksum = chance(dev, config.checksum);
+	if (dev->binary != 0 && dev->aggrIntvl > 0) {
+		tSimSummary * sum = dev->summary + channel;
+		if (status != 0) {
+			sum->lastError = status;
+			return;
+		}
+		if (sum->count >= 0xFFFF) return;
+		if (sum->count == 0 || temp < sum->tempMin) sum->tempMin = temp;
+		if (sum->count == 0 || temp > sum->tempMax) sum->tempMax = temp;
+		if (sum->count == 0 || rh < sum->rhMin) sum->rhMin = rh;
+		if (sum->count == 0 || rh > sum->rhMax) sum->rhMax = rh;
+		sum->tempSum += temp;
+		sum->rhSum += rh;
+		sum->tempSqSum += (int64_t)temp * temp;
+		sum->rhSqSum += (int64_t)rh * rh;
+		sum->count++;
+		return;
+	}
+	if (dev->binary != 0) {
+		const int16_t values[PROTO_SAMPLE_VALUES] = {(int16_t)((status == 0) ? temp : 0), (int16_t)((status == 0) ? rh : 0)};
+		len = appendFrame(dev, buf, PROTO_FRAME_TYPE_BYTE(PROTO_FRAME_SAMPLE, channel), status, values, PROTO_SAMPLE_VALUES);
+		if (badChecksum != 0) buf[len - 1] = (uint8_t)(buf[len - 1] ^ 0x5A);
+	} else {
+		if (channel > 0) len = (size_t)sprintf((char *)buf, "%u:", (unsigned)channel);
+		if (status != 0) {
+			len += (size_t)sprintf((char *)buf + len, "Err:%u\r\n", (unsigned)status);
+		} else {
+			/* the checksum is the sum of both values */
+			const int sum = temp + rh + ((badChecksum != 0) ? 10 : 0);
+			len += (size_t)sprintf(
+				(char *)buf + len,
+				"%s%d.%d\t%d.%d\t%s%d.%d\r\n",
+				(temp < 0) ? "-" : "", abs(temp) / 10, abs(temp) % 10,
+				rh / 10, rh % 10,
+				(sum < 0) ? "-" : "", abs(sum) / 10, abs(sum) % 10
+			);
+		}
+	}
+	if (chance(dev, config.garbage) != 0) {
+		for (uint32_t i = 1 + (nextRandom(dev) % 15); i > 0; i--) buf[len++] = (uint8_t)(nextRandom(dev) >> 24);
+	}
+	dev->readings++;
+	sendData(dev, buf, len);
+}
+
+
+/**
+ * Sends the summary frames of the current aggregation interval of the given device and starts
+ * the next interval. Missed intervals are skipped.
+ *
+ * @param[in,out] dev - device
+ */
+static void sendSummary(tSimDevice * dev) {
+	uint8_t buf[PROTO_FRAME_SIZE(PROTO_SUMMARY_VALUES) * PROTO_MAX_CHANNELS];
+	size_t len = 0;
+	for (uint8_t i = 0; i < config.sensors; i++) {
+		const tSimSummary * sum = dev->summary + i;
+		int16_t values[PROTO_SUMMARY_VALUES] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+		uint8_t status = 0;
+		if (sum->count > 0) {
+			const int32_t n = (int32_t)(sum->count);
+			const double tempMean = (double)(sum->tempSum) / (double)n;
+			const double rhMean = (double)(sum->rhSum) / (double)n;
+			const double tempVar = (n > 1) ? ((double)(sum->tempSqSum) - (tempMean * (double)(sum->tempSum))) / (double)(n - 1) : 0.0;
+			const double rhVar = (n > 1) ? ((double)(sum->rhSqSum) - (rhMean * (double)(sum->rhSum))) / (double)(n - 1) : 0.0;
+			values[PROTO_SUMMARY_COUNT]    = (int16_t)(sum->count);
+			values[PROTO_SUMMARY_TEMP]     = (int16_t)lround(tempMean);
+			values[PROTO_SUMMARY_TEMP_MIN] = sum->tempMin;
+			values[PROTO_SUMMARY_TEMP_MAX] = sum->tempMax;
+			values[PROTO_SUMMARY_RH]       = (int16_t)lround(rhMean);
+			values[PROTO_SUMMARY_RH_MIN]   = sum->rhMin;
+			values[PROTO_SUMMARY_RH_MAX]   = sum->rhMax;
+			values[PROTO_SUMMARY_TEMP_SD]  = (int16_t)((tempVar > 0.0) ? lround(sqrt(tempVar)) : 0);
+			values[PROTO_SUMMARY_RH_SD]    = (int16_t)((rhVar > 0.0) ? lround(sqrt(rhVar)) : 0);
+		} else {
+			status = sum->lastError;
+		}
+		len += appendFrame(dev, buf + len, PROTO_FRAME_TYPE_BYTE(PROTO_FRAME_SUMMARY, i), status, values, PROTO_SUMMARY_VALUES);
+		if (chance(dev, config.checksum) != 0) buf[len - 1] = (uint8_t)(buf[len - 1] ^ 0x5A);
+		dev->readings++;
+	}
+	const int64_t now = getMonoMs();
+	dev->aggrStart += dev->aggrIntvl;
+	if ((now - dev->aggrStart) >= dev->aggrIntvl) dev->aggrStart = now;
+	memset(dev->summary, 0, sizeof(dev->summary));
+	sendData(dev, buf, len);
+}
+
+
+/**
+ * Appends a binary frame with the given content to the passed buffer.
+ *
+ * @param[in,out] dev - device with the sequence number
+ * @param[out] buf - output buffer with at least PROTO_FRAME_SIZE(count) bytes space
+ * @param[in] type - frame type byte (see PROTO_FRAME_TYPE_BYTE())
+ * @param[in] status - status code
+ * @param[in] values - fixed-point values
+ * @param[in] count - number of values
+ * @return number of bytes written
+ */
+static size_t appendFrame(tSimDevice * dev, uint8_t * buf, const uint8_t type, const uint8_t status, const int16_t * values, const size_t count) {
+	size_t len = 0;
+	buf[len++] = PROTO_SYNC;
+	buf[len++] = type;
+	buf[len++] = dev->sequence++;
+	buf[len++] = status;
+	for (size_t i = 0; i < count; i++) {
+		const uint16_t val = (uint16_t)(values[i]);
+		buf[len++] = (uint8_t)(val & 0xFF);
+		buf[len++] = (uint8_t)(val >> 8);
+	}
+	buf[len] = protoCrc8(buf + 1, len - 1);
+	return len + 1;
+}
+
+
+/**
+ * Sends the given data to the host of the passed device. Data which does not fit into the buffer
+ * of the pseudo terminal is dropped like by a serial interface without flow control.
+ *
+ * @param[in,out] dev - device
+ * @param[in] buf - data to send
+ * @param[in] len - number of bytes in buf
+ */
+static void sendData(tSimDevice * dev, const uint8_t * buf, const size_t len) {
+	size_t pos = 0;
+	while (pos < len) {
+		const ssize_t res = write(dev->fd, buf + pos, len - pos);
+		if (res < 0 && errno == EINTR) continue;
+		if (res <= 0) break;
+		pos += (size_t)res;
+	}
+	dev->bytes += pos;
+	dev->dropped += len - pos;
+}
+
+
+/**
+ * Decides randomly whether an event with the given probability occurs.
+ *
+ * @param[in,out] dev - device with the pseudo random number generator
+ * @param[in] percent - probability in percent
+ * @return 1 if the event occurs, else 0
+ */
+static int chance(tSimDevice * dev, const double percent) {
+	if (percent <= 0.0) return 0;
+	return ((double)(nextRandom(dev) % 1000000) < (percent * 10000.0)) ? 1 : 0;
+}
+
+
+/**
+ * Returns the next pseudo random number of the given device. The sequence is the same for each
+ * program run.
+ *
+ * @param[in,out] dev - device with the pseudo random number generator
+ * @return pseudo random number
+ */
+static uint32_t nextRandom(tSimDevice * dev) {
+	/* xorshift32 */
+	dev->seed ^= dev->seed << 13;
+	dev->seed ^= dev->seed >> 17;
+	dev->seed ^= dev->seed << 5;
+	return dev->seed;
+}
+
+
+/**
+ * Raises the limit of open files to the hard limit if needed for the given number of devices.
+ *
+ * @param[in] count - number of devices
+ */
+static void raiseFileLimit(const size_t count) {
+	struct rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return;
+	/* standard streams and some reserve */
+	const rlim_t needed = (rlim_t)count + 16;
+	if (limit.rlim_cur >= needed) return;
+	limit.rlim_cur = (limit.rlim_max == RLIM_INFINITY || limit.rlim_max > needed) ? needed : limit.rlim_max;
+	setrlimit(RLIMIT_NOFILE, &limit);
+}
+
+
+/**
+ * Returns the current time of a monotonic clock in milliseconds.
+ *
+ * @return current monotonic time in milliseconds
+ */
+static int64_t getMonoMs(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((int64_t)(ts.tv_sec) * 1000) + (int64_t)(ts.tv_nsec / 1000000);
+}
+
+
+/**
+ * Returns the CPU time used by this process so far.
+ *
+ * @return user and system time in seconds
+ */
+static double getCpuSec(void) {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+	return (double)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + ((double)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6);
+}
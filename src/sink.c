@@ -0,0 +1,906 @@
+/**
+ * @file sink.c
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#ifdef __linux__
+/* fallocate() */
+#define _GNU_SOURCE
+#endif /* __linux__ */
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utility/target.h"
+#include "sink.h"
+
+
+#if defined(PCF_IS_WIN)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+typedef SOCKET tSocket;
+typedef int tSockLen;
+#define SINK_NO_SOCKET INVALID_SOCKET
+#define SINK_SEND_FLAGS 0
+#elif defined(PCF_IS_LINUX)
+#include <fcntl.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+typedef int tSocket;
+typedef socklen_t tSockLen;
+#define SINK_NO_SOCKET -1
+/* a collector which closed the connection shall not raise SIGPIPE */
+#define SINK_SEND_FLAGS MSG_NOSIGNAL
+#else /* not PCF_IS_WIN and not PCF_IS_LINUX */
+#error Unsupported target OS.
+#endif
+
+
+/** Initial output buffer size in bytes. */
+#define SINK_BUFFER_SIZE 4096
+
+
+/** Maximum payload of a single UDP datagram in bytes. Avoids IP fragmentation on Ethernet. */
+#define SINK_DATAGRAM_SIZE 1400
+
+
+/** Maximum number of bytes buffered for a TCP collector which is not reachable. */
+#define SINK_NET_BUFFER_MAX 1048576
+
+
+/** Time between two connection attempts to a TCP collector in milliseconds. */
+#define SINK_RECONNECT_DELAY 1000
+
+
+/** Time between two checks of a pending TCP connection or send operation in milliseconds. */
+#define SINK_RETRY_DELAY 100
+
+
+/** Time to wait for a TCP collector to accept the remaining records on close in milliseconds. */
+#define SINK_CLOSE_TIMEOUT 1000
+
+
+/** Output sink types. */
+typedef enum tSinkType {
+	ST_FILE = 0, /**< file or standard output */
+	ST_UDP,      /**< UDP collector; each flush sends one datagram per SINK_DATAGRAM_SIZE */
+	ST_TCP       /**< TCP collector with non-blocking reconnect */
+} tSinkType;
+
+
+/** TCP connection states. */
+typedef enum tSinkConn {
+	SC_DISCONNECTED = 0, /**< no connection; reconnect at checkAt */
+	SC_CONNECTING,       /**< non-blocking connect in progress */
+	SC_CONNECTED         /**< connection established */
+} tSinkConn;
+
+
+/**
+ * Internal output sink handle.
+ */
+struct tSink {
+	tSinkType type; /**< output type */
+#if defined(PCF_IS_WIN)
+	HANDLE fd; /**< output file handle */
+	int console; /**< non-zero if fd is a console */
+#else /* PCF_IS_LINUX */
+	int fd; /**< output file descriptor */
+#endif
+	int owned; /**< non-zero if fd needs to be closed */
+	uint64_t fileSize; /**< number of bytes in the output file */
+	uint64_t prealloc; /**< number of bytes preallocated for the output file or 0 */
+	int utf8; /**< non-zero to keep UTF-8 instead of converting to UTF-16 (Unicode builds on Windows) */
+	int crlf; /**< non-zero to write line feeds as CR/LF */
+	tSinkFlush flush; /**< flush policy */
+	size_t param; /**< flush policy parameter */
+	size_t linger; /**< maximum time a record is buffered with SF_RECORDS in milliseconds or 0 */
+	int64_t pendingSince; /**< time the oldest buffered record was added */
+	int64_t lastNow; /**< time of the last write or poll */
+	uint8_t * buf; /**< buffered records */
+	size_t len; /**< number of buffered bytes */
+	size_t size; /**< capacity of buf in bytes */
+	size_t records; /**< number of buffered records */
+	/* network sinks */
+	tSocket sock; /**< collector socket or SINK_NO_SOCKET */
+	struct sockaddr_storage addr; /**< collector address */
+	tSockLen addrLen; /**< size of addr in bytes */
+	tSinkConn conn; /**< TCP connection state */
+	int due; /**< non-zero if a flush could not be completed, yet */
+	int partial; /**< non-zero if the first buffered record was sent in part */
+	int64_t checkAt; /**< time of the next connection attempt or pending operation check */
+};
+
+
+/**
+ * Ensures that the buffer of the given sink can hold the passed number of additional bytes.
+ *
+ * @param[in,out] sink - output sink
+ * @param[in] extra - number of additional bytes
+ * @return 1 on success, else 0
+ */
+static int reserveBuf(tSink * sink, const size_t extra) {
+	size_t newSize = sink->size;
+	if ((sink->len + extra) <= newSize) return 1;
+	while (newSize < (sink->len + extra)) newSize *= 2;
+	uint8_t * newBuf = (uint8_t *)realloc(sink->buf, newSize);
+	if (newBuf == NULL) return 0;
+	sink->buf = newBuf;
+	sink->size = newSize;
+	return 1;
+}
+
+
+#if defined(UNICODE) && defined(PCF_IS_WIN)
+/**
+ * Appends the given UTF-8 string as UTF-16 to the buffer of the passed sink. Invalid UTF-8
+ * sequences are replaced by U+FFFD.
+ *
+ * @param[in,out] sink - output sink
+ * @param[in] str - UTF-8 string to append
+ * @param[in] len - string length in bytes
+ * @return 1 on success, else 0
+ */
+static int appendUtf16(tSink * sink, const char * str, const size_t len) {
+	/* 2 CR/LF code units or 2 UTF-16 code units per byte at most */
+	if (reserveBuf(sink, 4 * len) == 0) return 0;
+	const uint8_t * in = (const uint8_t *)str;
+	const uint8_t * const end = in + len;
+	uint8_t * out = sink->buf + sink->len;
+	while (in < end) {
+		uint32_t c = *in++;
+		if (c >= 0x80) {
+			/* number of continuation bytes and the minimal code point of the sequence */
+			const size_t n = (c >= 0xC2 && c < 0xE0) ? 1 : (c >= 0xE0 && c < 0xF0) ? 2 : (c >= 0xF0 && c < 0xF5) ? 3 : 0;
+			const uint32_t min = (n == 3) ? 0x10000 : (n == 2) ? 0x800 : 0x80;
+			size_t i;
+			c &= (uint32_t)(0x3F >> n);
+			for (i = 0; i < n && in < end && (*in & 0xC0) == 0x80; i++) c = (c << 6) | (uint32_t)(*in++ & 0x3F);
+			if (n == 0 || i < n || c < min || c > 0x10FFFF || (c >= 0xD800 && c < 0xE000)) c = 0xFFFD;
+		}
+		if (c == '\n' && sink->crlf != 0) {
+			*out++ = (uint8_t)'\r';
+			*out++ = 0;
+		}
+		if (c >= 0x10000) {
+			/* surrogate pair */
+			const uint32_t high = 0xD800 + ((c - 0x10000) >> 10);
+			const uint32_t low = 0xDC00 + ((c - 0x10000) & 0x3FF);
+			*out++ = (uint8_t)(high & 0xFF);
+			*out++ = (uint8_t)(high >> 8);
+			c = low;
+		}
+		*out++ = (uint8_t)(c & 0xFF);
+		*out++ = (uint8_t)(c >> 8);
+	}
+	sink->len = (size_t)(out - sink->buf);
+	return 1;
+}
+#endif /* UNICODE and PCF_IS_WIN */
+
+
+/**
+ * Appends the given string to the buffer of the passed sink. The string is copied as is unless
+ * line feeds shall be written as CR/LF. It is converted to UTF-16 if the sink has no UTF-8
+ * encoding in Unicode builds on Windows.
+ *
+ * @param[in,out] sink - output sink
+ * @param[in] str - UTF-8 string to append
+ * @param[in] len - string length in bytes
+ * @return 1 on success, else 0
+ */
+static int appendBuf(tSink * sink, const char * str, const size_t len) {
+#if defined(UNICODE) && defined(PCF_IS_WIN)
+	if (sink->utf8 == 0 || sink->console != 0) return appendUtf16(sink, str, len);
+#endif /* UNICODE and PCF_IS_WIN */
+	if (sink->crlf == 0) {
+		if (reserveBuf(sink, len) == 0) return 0;
+		memcpy(sink->buf + sink->len, str, len);
+		sink->len += len;
+		return 1;
+	}
+	if (reserveBuf(sink, 2 * len) == 0) return 0;
+	uint8_t * out = sink->buf + sink->len;
+	for (size_t i = 0; i < len; i++) {
+		if (str[i] == '\n') *out++ = (uint8_t)'\r';
+		*out++ = (uint8_t)str[i];
+	}
+	sink->len = (size_t)(out - sink->buf);
+	return 1;
+}
+
+
+/**
+ * Closes the socket of the given network sink.
+ *
+ * @param[in,out] sink - network sink
+ */
+static void closeSocket(tSink * sink) {
+	if (sink->sock == SINK_NO_SOCKET) return;
+#if defined(PCF_IS_WIN)
+	closesocket(sink->sock);
+#else /* PCF_IS_LINUX */
+	close(sink->sock);
+#endif
+	sink->sock = SINK_NO_SOCKET;
+}
+
+
+/**
+ * Checks whether the last socket operation only failed because it would have blocked.
+ *
+ * @return 1 if the operation can be retried later, else 0
+ */
+static int wouldBlock(void) {
+#if defined(PCF_IS_WIN)
+	const int err = WSAGetLastError();
+	return (err == WSAEWOULDBLOCK || err == WSAEINPROGRESS || err == WSAEINTR) ? 1 : 0;
+#else /* PCF_IS_LINUX */
+	return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS || errno == EINTR) ? 1 : 0;
+#endif
+}
+
+
+/**
+ * Creates a non-blocking socket for the collector of the given network sink.
+ *
+ * @param[in,out] sink - network sink
+ * @return 1 on success, else 0
+ */
+static int createSocket(tSink * sink) {
+	sink->sock = socket(sink->addr.ss_family, (sink->type == ST_UDP) ? SOCK_DGRAM : SOCK_STREAM, 0);
+	if (sink->sock == SINK_NO_SOCKET) return 0;
+#if defined(PCF_IS_WIN)
+	u_long nonBlocking = 1;
+	if (ioctlsocket(sink->sock, FIONBIO, &nonBlocking) == 0) return 1;
+#else /* PCF_IS_LINUX */
+	const int flags = fcntl(sink->sock, F_GETFL, 0);
+	if (flags != -1 && fcntl(sink->sock, F_SETFL, flags | O_NONBLOCK) != -1) return 1;
+#endif
+	closeSocket(sink);
+	return 0;
+}
+
+
+/**
+ * Closes the TCP connection of the given sink and schedules the next connection attempt. The
+ * buffered records are dropped if the first one was sent in part as its remainder would corrupt
+ * the data stream of the next connection.
+ *
+ * @param[in,out] sink - TCP sink
+ */
+static void disconnect(tSink * sink) {
+	closeSocket(sink);
+	sink->conn = SC_DISCONNECTED;
+	sink->checkAt = sink->lastNow + SINK_RECONNECT_DELAY;
+	if (sink->partial != 0) {
+		sink->len = 0;
+		sink->records = 0;
+		sink->partial = 0;
+		sink->due = 0;
+	}
+}
+
+
+/**
+ * Starts a non-blocking connection attempt to the collector of the given TCP sink.
+ *
+ * @param[in,out] sink - TCP sink
+ */
+static void connectNet(tSink * sink) {
+	if (createSocket(sink) == 0) {
+		disconnect(sink);
+	} else if (connect(sink->sock, (const struct sockaddr *)&(sink->addr), sink->addrLen) == 0) {
+		sink->conn = SC_CONNECTED;
+	} else if (wouldBlock() != 0) {
+		sink->conn = SC_CONNECTING;
+		sink->checkAt = sink->lastNow + SINK_RETRY_DELAY;
+	} else {
+		disconnect(sink);
+	}
+}
+
+
+/**
+ * Waits until the socket of the given network sink becomes writable.
+ *
+ * @param[in,out] sink - network sink
+ * @param[in] timeout - maximum time to wait in milliseconds
+ * @return 1 if writable, 0 on timeout or -1 if the connection failed
+ */
+static int waitWritable(tSink * sink, const size_t timeout) {
+	fd_set wfds, efds;
+	struct timeval tv;
+	int err = 0;
+	tSockLen errLen = (tSockLen)sizeof(err);
+	FD_ZERO(&wfds);
+	FD_ZERO(&efds);
+	FD_SET(sink->sock, &wfds);
+	/* Windows reports failed connection attempts as exception */
+	FD_SET(sink->sock, &efds);
+	tv.tv_sec = (long)(timeout / 1000);
+	tv.tv_usec = (long)((timeout % 1000) * 1000);
+	const int res = select((int)(sink->sock + 1), NULL, &wfds, &efds, &tv);
+	if (res == 0) return 0;
+	if (res < 0) return (wouldBlock() != 0) ? 0 : -1;
+	if (getsockopt(sink->sock, SOL_SOCKET, SO_ERROR, (char *)&err, &errLen) != 0 || err != 0) return -1;
+	return 1;
+}
+
+
+/**
+ * Advances the TCP connection state of the given sink without blocking.
+ *
+ * @param[in,out] sink - TCP sink
+ */
+static void checkConn(tSink * sink) {
+	switch (sink->conn) {
+	case SC_DISCONNECTED:
+		if (sink->lastNow >= sink->checkAt) connectNet(sink);
+		break;
+	case SC_CONNECTING:
+		switch (waitWritable(sink, 0)) {
+		case 1:
+			sink->conn = SC_CONNECTED;
+			break;
+		case 0:
+			sink->checkAt = sink->lastNow + SINK_RETRY_DELAY;
+			break;
+		default:
+			disconnect(sink);
+			break;
+		}
+		break;
+	case SC_CONNECTED:
+		break;
+	}
+}
+
+
+/**
+ * Sends the buffered records of the given network sink. UDP sinks send them as single datagram
+ * which is lost if it cannot be sent. TCP sinks keep the records which could not be sent, yet, up
+ * to SINK_NET_BUFFER_MAX bytes. A collector outage is no error as the sink recovers on its own.
+ *
+ * @param[in,out] sink - network sink
+ * @return 1 on success, else 0
+ */
+static int flushNet(tSink * sink) {
+	if (sink->type == ST_UDP) {
+#if defined(PCF_IS_WIN)
+		if (sink->len > 0) sendto(sink->sock, (const char *)(sink->buf), (int)(sink->len), 0, (const struct sockaddr *)&(sink->addr), sink->addrLen);
+#else /* PCF_IS_LINUX */
+		if (sink->len > 0) sendto(sink->sock, sink->buf, sink->len, SINK_SEND_FLAGS, (const struct sockaddr *)&(sink->addr), sink->addrLen);
+#endif
+		sink->len = 0;
+		sink->records = 0;
+		return 1;
+	}
+	size_t pos = 0;
+	int lost = 0;
+	if (sink->conn != SC_CONNECTED) checkConn(sink);
+	while (sink->conn == SC_CONNECTED && pos < sink->len) {
+#if defined(PCF_IS_WIN)
+		const int sent = send(sink->sock, (const char *)(sink->buf + pos), (int)(sink->len - pos), SINK_SEND_FLAGS);
+#else /* PCF_IS_LINUX */
+		const ssize_t sent = send(sink->sock, sink->buf + pos, sink->len - pos, SINK_SEND_FLAGS);
+#endif
+		if (sent > 0) {
+			pos += (size_t)sent;
+		} else {
+			if (sent == 0 || wouldBlock() == 0) lost = 1;
+			break;
+		}
+	}
+	if (pos > 0) {
+		/* keep the records which have not been sent */
+		memmove(sink->buf, sink->buf + pos, sink->len - pos);
+		sink->len -= pos;
+		sink->partial = (sink->len > 0) ? 1 : 0;
+	}
+	if (lost != 0) disconnect(sink);
+	if (sink->len > SINK_NET_BUFFER_MAX) {
+		/* drop the records of a long collector outage */
+		if (sink->partial != 0) disconnect(sink);
+		sink->len = 0;
+	}
+	if (sink->len == 0) sink->records = 0;
+	sink->due = (sink->len > 0) ? 1 : 0;
+	if (sink->due != 0 && sink->conn == SC_CONNECTED) sink->checkAt = sink->lastNow + SINK_RETRY_DELAY;
+	return 1;
+}
+
+
+/**
+ * Resolves the collector address of the given network sink URL and creates its socket. The URL
+ * has the form udp://host:port or tcp://host:port with IPv6 addresses enclosed in brackets. TCP
+ * sinks start their first connection attempt.
+ *
+ * @param[in,out] sink - output sink
+ * @param[in] url - network sink URL
+ * @return 1 on success, else 0
+ */
+static int openNet(tSink * sink, const TCHAR * url) {
+	struct addrinfo hints;
+	struct addrinfo * info = NULL;
+	char * port;
+	int res = 0;
+	char * str = _ttoUtf8(url);
+	if (str == NULL) return 0;
+	const tSinkType type = (strncmp(str, "udp://", 6) == 0) ? ST_UDP : ST_TCP;
+	char * host = str + 6;
+	if (*host == '[') {
+		host++;
+		port = strchr(host, ']');
+		if (port == NULL || port[1] != ':') goto onError;
+		*port = 0;
+		port += 2;
+	} else {
+		port = strrchr(host, ':');
+		if (port == NULL) goto onError;
+		*port++ = 0;
+	}
+	if (*host == 0 || *port == 0) goto onError;
+#if defined(PCF_IS_WIN)
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) goto onError;
+#endif
+	/* sinkClose() releases the network resources of all sinks which are not of type ST_FILE */
+	sink->type = type;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = (type == ST_UDP) ? SOCK_DGRAM : SOCK_STREAM;
+	if (getaddrinfo(host, port, &hints, &info) != 0 || info == NULL) goto onError;
+	if ((size_t)(info->ai_addrlen) > sizeof(sink->addr)) goto onError;
+	memcpy(&(sink->addr), info->ai_addr, (size_t)(info->ai_addrlen));
+	sink->addrLen = (tSockLen)(info->ai_addrlen);
+	if (type == ST_UDP) {
+		if (createSocket(sink) == 0) goto onError;
+	} else {
+		connectNet(sink);
+	}
+	res = 1;
+onError:
+	if (info != NULL) freeaddrinfo(info);
+	free(str);
+	return res;
+}
+
+
+/**
+ * Flushes the given output sink if required by its flush policy after a record was added.
+ *
+ * @param[in,out] sink - output sink
+ * @param[in] now - current time
+ * @return 1 on success, else 0
+ */
+static int applyPolicy(tSink * sink, const int64_t now) {
+	switch (sink->flush) {
+	case SF_LINE:
+		return sinkFlush(sink);
+	case SF_BYTES:
+		if (sink->len >= sink->param) return sinkFlush(sink);
+		break;
+	case SF_RECORDS:
+		if (sink->records >= sink->param) return sinkFlush(sink);
+		return sinkPoll(sink, now);
+	case SF_INTERVAL:
+		return sinkPoll(sink, now);
+	}
+	return 1;
+}
+
+
+/**
+ * Completes the addition of a record to the buffer of the given sink and flushes it according to
+ * its flush policy. A record which does not fit into the current datagram of a UDP sink starts a
+ * new one.
+ *
+ * @param[in,out] sink - output sink
+ * @param[in] start - buffer offset of the added record
+ * @param[in] now - current time
+ * @return 1 on success, else 0
+ */
+static int addRecord(tSink * sink, const size_t start, const int64_t now) {
+	sink->lastNow = now;
+	sink->records++;
+	if (sink->type == ST_UDP && start > 0 && sink->len > SINK_DATAGRAM_SIZE) {
+		const size_t len = sink->len;
+		sink->len = start;
+		flushNet(sink);
+		memmove(sink->buf, sink->buf + start, len - start);
+		sink->len = len - start;
+		sink->records = 1;
+		sink->pendingSince = now;
+	}
+	return applyPolicy(sink, now);
+}
+
+
+/**
+ * Opens the given output file of the passed sink in append mode. The file is created if it does
+ * not exist.
+ *
+ * @param[in,out] sink - file sink
+ * @param[in] path - output file path
+ * @return 1 on success, else 0
+ */
+static int openFile(tSink * sink, const TCHAR * path) {
+#if defined(PCF_IS_WIN)
+	LARGE_INTEGER size;
+	sink->fd = CreateFile(path, FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (sink->fd == INVALID_HANDLE_VALUE) return 0;
+	sink->owned = 1;
+	sink->fileSize = (GetFileSizeEx(sink->fd, &size) != 0) ? (uint64_t)(size.QuadPart) : 0;
+#else /* PCF_IS_LINUX */
+	struct stat st;
+	sink->fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0666);
+	if (sink->fd < 0) return 0;
+	sink->owned = 1;
+	sink->fileSize = (fstat(sink->fd, &st) == 0) ? (uint64_t)(st.st_size) : 0;
+#endif
+	sink->prealloc = 0;
+	return 1;
+}
+
+
+/**
+ * Closes the output file of the given sink.
+ *
+ * @param[in,out] sink - file sink
+ */
+static void closeFile(tSink * sink) {
+#if defined(PCF_IS_WIN)
+	/* unused preallocated space is released with the last handle */
+	if (sink->owned != 0 && sink->fd != INVALID_HANDLE_VALUE) CloseHandle(sink->fd);
+	sink->fd = INVALID_HANDLE_VALUE;
+#else /* PCF_IS_LINUX */
+	if (sink->owned != 0 && sink->fd >= 0) {
+		/* release the unused preallocated space */
+		if (sink->prealloc > sink->fileSize) {
+			int res;
+			do {
+				res = ftruncate(sink->fd, (off_t)(sink->fileSize));
+			} while (res != 0 && errno == EINTR);
+		}
+		close(sink->fd);
+	}
+	sink->fd = -1;
+#endif
+	sink->owned = 0;
+	sink->prealloc = 0;
+}
+
+
+/**
+ * Checks whether the given output path is a network sink URL (udp://host:port or tcp://host:port).
+ *
+ * @param[in] path - output path
+ * @return 1 if path is a network sink URL, else 0
+ */
+int sinkIsUrl(const TCHAR * path) {
+	if (path == NULL) return 0;
+	return (_tcsncmp(path, _T("udp://"), 6) == 0 || _tcsncmp(path, _T("tcp://"), 6) == 0) ? 1 : 0;
+}
+
+
+/**
+ * Opens a new output sink for the given file path or network sink URL. The file is created if it
+ * does not exist and written in append mode. Network sinks send UTF-8 text with plain line feeds.
+ *
+ * @param[in] path - output file path, network sink URL (see sinkIsUrl()) or NULL for standard output
+ * @param[in] utf8 - non-zero to write UTF-8 instead of UTF-16 (Unicode builds on Windows)
+ * @param[in] crlf - non-zero to write line feeds as CR/LF to files and the standard output
+ * @param[in] flush - flush policy
+ * @param[in] param - flush policy parameter (seconds for SF_INTERVAL, bytes for SF_BYTES, records for SF_RECORDS)
+ * @param[in] linger - maximum time in milliseconds a record is buffered with SF_RECORDS or 0
+ * @return Handle on success, else NULL.
+ */
+tSink * sinkOpen(const TCHAR * path, const int utf8, const int crlf, const tSinkFlush flush, const size_t param, const size_t linger) {
+	tSink * res = (tSink *)calloc(1, sizeof(tSink));
+	if (res == NULL) return NULL;
+	res->type = ST_FILE;
+	res->sock = SINK_NO_SOCKET;
+	res->utf8 = utf8;
+	if (sinkIsUrl(path) != 0) {
+		res->utf8 = 1;
+#if defined(PCF_IS_WIN)
+		res->fd = INVALID_HANDLE_VALUE;
+#else /* PCF_IS_LINUX */
+		res->fd = -1;
+#endif
+		if (openNet(res, path) == 0) goto onError;
+	} else {
+		res->crlf = crlf;
+#if defined(PCF_IS_WIN)
+		if (path == NULL) {
+			res->fd = GetStdHandle(STD_OUTPUT_HANDLE);
+			if (res->fd == NULL || res->fd == INVALID_HANDLE_VALUE) goto onError;
+#ifdef UNICODE
+			/* the console is written via WriteConsoleW() */
+			DWORD mode;
+			res->console = (GetConsoleMode(res->fd, &mode) != 0) ? 1 : 0;
+#endif /* UNICODE */
+		} else if (openFile(res, path) == 0) {
+			goto onError;
+		}
+#else /* PCF_IS_LINUX */
+		if (path == NULL) {
+			res->fd = STDOUT_FILENO;
+		} else if (openFile(res, path) == 0) {
+			goto onError;
+		}
+#endif
+	}
+	res->flush = flush;
+	res->param = param;
+	res->linger = linger;
+	res->size = PCF_MAX((size_t)SINK_BUFFER_SIZE, (flush == SF_BYTES) ? param : 0);
+	res->buf = (uint8_t *)malloc(res->size);
+	if (res->buf == NULL) goto onError;
+	return res;
+onError:
+#if defined(PCF_IS_WIN)
+	res->fd = INVALID_HANDLE_VALUE;
+#else /* PCF_IS_LINUX */
+	res->fd = -1;
+#endif
+	res->owned = 0;
+	sinkClose(res);
+	return NULL;
+}
+
+
+/**
+ * Adds the given record to the output sink. The sink is flushed according to its flush policy.
+ *
+ * @param[in,out] sink - output sink
+ * @param[in] str - UTF-8 encoded record to add
+ * @param[in] len - length of str in bytes
+ * @param[in] now - current time
+ * @return 1 on success, else 0
+ */
+int sinkWrite(tSink * sink, const char * str, const size_t len, const int64_t now) {
+	if (sink == NULL || (str == NULL && len > 0)) return 0;
+	if (sink->len == 0) sink->pendingSince = now;
+	const size_t start = sink->len;
+	if (appendBuf(sink, str, len) == 0) return 0;
+	return addRecord(sink, start, now);
+}
+
+
+/**
+ * Adds the given binary record to the output sink without any character encoding. The sink is
+ * flushed according to its flush policy.
+ *
+ * @param[in,out] sink - output sink
+ * @param[in] data - record to add
+ * @param[in] size - size of data in bytes
+ * @param[in] now - current time
+ * @return 1 on success, else 0
+ */
+int sinkWriteRaw(tSink * sink, const uint8_t * data, const size_t size, const int64_t now) {
+	if (sink == NULL || (data == NULL && size > 0)) return 0;
+	if (sink->len == 0) sink->pendingSince = now;
+	const size_t start = sink->len;
+	if (reserveBuf(sink, size) == 0) return 0;
+	if (size > 0) memcpy(sink->buf + sink->len, data, size);
+	sink->len += size;
+	return addRecord(sink, start, now);
+}
+
+
+/**
+ * Checks whether nothing has been written to the output file of the given sink, yet. Network
+ * sinks are never empty as they have no file header.
+ *
+ * @param[in] sink - output sink
+ * @return 1 if the output file and buffer are empty, 0 if not and -1 on error
+ */
+int sinkIsEmpty(const tSink * sink) {
+	if (sink == NULL) return -1;
+	if (sink->len > 0 || sink->type != ST_FILE) return 0;
+#if defined(PCF_IS_WIN)
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(sink->fd, &size) == 0) return -1;
+	return (size.QuadPart == 0) ? 1 : 0;
+#else /* PCF_IS_LINUX */
+	struct stat st;
+	if (fstat(sink->fd, &st) != 0) return -1;
+	return (st.st_size == 0) ? 1 : 0;
+#endif
+}
+
+
+/**
+ * Flushes the given output sink if the buffered records are due according to its flush policy.
+ * TCP sinks reconnect to their collector and retry pending records in here.
+ *
+ * @param[in,out] sink - output sink
+ * @param[in] now - current time
+ * @return 1 on success, else 0
+ */
+int sinkPoll(tSink * sink, const int64_t now) {
+	int64_t deadline;
+	if (sink == NULL) return 0;
+	sink->lastNow = now;
+	if (sink->type == ST_TCP) checkConn(sink);
+	if (sinkDeadline(sink, &deadline) != 0 && now >= deadline) return sinkFlush(sink);
+	return 1;
+}
+
+
+/**
+ * Returns the point in time at which the buffered records of the given sink are due.
+ *
+ * @param[in] sink - output sink
+ * @param[out] deadline - set to the point in time of the next flush
+ * @return 1 if a flush is pending, else 0
+ */
+int sinkDeadline(const tSink * sink, int64_t * deadline) {
+	if (sink == NULL || deadline == NULL || sink->len == 0) return 0;
+	int res = 0;
+	if (sink->flush == SF_INTERVAL) {
+		*deadline = sink->pendingSince + ((int64_t)(sink->param) * 1000);
+		res = 1;
+	} else if (sink->flush == SF_RECORDS && sink->linger > 0) {
+		*deadline = sink->pendingSince + (int64_t)(sink->linger);
+		res = 1;
+	}
+	if (sink->type == ST_TCP && sink->due != 0 && (res == 0 || sink->checkAt < *deadline)) {
+		/* retry the records which could not be sent, yet */
+		*deadline = sink->checkAt;
+		res = 1;
+	}
+	return res;
+}
+
+
+/**
+ * Writes all buffered records of the given sink to the output file at once.
+ *
+ * @param[in,out] sink - output sink
+ * @return 1 on success, else 0
+ */
+int sinkFlush(tSink * sink) {
+	if (sink == NULL) return 0;
+	if (sink->type != ST_FILE) return flushNet(sink);
+	size_t pos = 0;
+	while (pos < sink->len) {
+#if defined(PCF_IS_WIN)
+		DWORD written = 0;
+		BOOL ok;
+		if (sink->console != 0) {
+			ok = WriteConsoleW(sink->fd, sink->buf + pos, (DWORD)((sink->len - pos) / sizeof(wchar_t)), &written, NULL);
+			written = (DWORD)(written * sizeof(wchar_t));
+		} else {
+			ok = WriteFile(sink->fd, sink->buf + pos, (DWORD)(sink->len - pos), &written, NULL);
+		}
+		if (ok == 0 || written == 0) break;
+		pos += (size_t)written;
+#else /* PCF_IS_LINUX */
+		const ssize_t written = write(sink->fd, sink->buf + pos, sink->len - pos);
+		if (written < 0 && errno == EINTR) continue;
+		if (written <= 0) break;
+		pos += (size_t)written;
+#endif
+	}
+	sink->fileSize += (uint64_t)pos;
+	if (pos < sink->len) {
+		/* keep the records which have not been written */
+		memmove(sink->buf, sink->buf + pos, sink->len - pos);
+		sink->len -= pos;
+		return 0;
+	}
+	sink->len = 0;
+	sink->records = 0;
+	return 1;
+}
+
+
+/**
+ * Writes all buffered records of the given file sink to its current output file and continues
+ * with the passed file. The current file is closed. The unused preallocated space of it is
+ * released. The file is kept open if the new one cannot be opened.
+ *
+ * @param[in,out] sink - file sink
+ * @param[in] path - new output file path
+ * @return 1 on success, else 0
+ */
+int sinkReopen(tSink * sink, const TCHAR * path) {
+	if (sink == NULL || path == NULL || sink->type != ST_FILE || sink->owned == 0) return 0;
+	if (sinkFlush(sink) == 0) return 0;
+	tSink old;
+	memcpy(&old, sink, sizeof(old));
+	if (openFile(sink, path) == 0) {
+		memcpy(sink, &old, sizeof(old));
+		return 0;
+	}
+	closeFile(&old);
+	return 1;
+}
+
+
+/**
+ * Preallocates disk space for the given number of bytes of the output file of the passed sink.
+ * The file size remains unchanged. Appending to the file does not need to allocate space until
+ * it reaches this size. This avoids fragmentation on flash storage.
+ *
+ * @param[in,out] sink - file sink
+ * @param[in] size - number of bytes to preallocate from the start of the file
+ * @return 1 on success, else 0
+ * @remarks Not supported on all file systems and targets.
+ */
+int sinkPreallocate(tSink * sink, const uint64_t size) {
+	if (sink == NULL || sink->type != ST_FILE || sink->owned == 0) return 0;
+	if (size <= sink->fileSize) return 1;
+#if defined(PCF_IS_WIN)
+#if _WIN32_WINNT >= 0x0600
+	/* the append-only handle has no permission to change the allocation size */
+	HANDLE fd = ReOpenFile(sink->fd, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0);
+	if (fd == INVALID_HANDLE_VALUE) return 0;
+	FILE_ALLOCATION_INFO info;
+	info.AllocationSize.QuadPart = (LONGLONG)size;
+	const BOOL ok = SetFileInformationByHandle(fd, FileAllocationInfo, &info, sizeof(info));
+	CloseHandle(fd);
+	if (ok == 0) return 0;
+#else /* _WIN32_WINNT < 0x0600 */
+	return 0;
+#endif /* _WIN32_WINNT */
+#elif defined(__linux__)
+	int res;
+	do {
+		res = fallocate(sink->fd, FALLOC_FL_KEEP_SIZE, 0, (off_t)size);
+	} while (res != 0 && errno == EINTR);
+	if (res != 0) return 0;
+#else /* PCF_IS_LINUX but not __linux__ */
+	return 0;
+#endif
+	sink->prealloc = size;
+	return 1;
+}
+
+
+/**
+ * Returns the size of the output file of the given sink including the buffered records.
+ *
+ * @param[in] sink - file sink
+ * @return size in bytes
+ */
+uint64_t sinkFileSize(const tSink * sink) {
+	if (sink == NULL) return 0;
+	return sink->fileSize + (uint64_t)(sink->len);
+}
+
+
+/**
+ * Flushes and closes the given output sink. The handle is invalid after this call.
+ *
+ * @param[in,out] sink - output sink to close
+ */
+void sinkClose(tSink * sink) {
+	if (sink == NULL) return;
+	if (sink->buf != NULL) {
+		sinkFlush(sink);
+		/* give a TCP collector a moment to accept the remaining records */
+		while (sink->type == ST_TCP && sink->len > 0 && sink->conn != SC_DISCONNECTED && waitWritable(sink, SINK_CLOSE_TIMEOUT) > 0) {
+			sink->conn = SC_CONNECTED;
+			flushNet(sink);
+		}
+		free(sink->buf);
+	}
+	closeFile(sink);
+	if (sink->type != ST_FILE) {
+		closeSocket(sink);
+#if defined(PCF_IS_WIN)
+		WSACleanup();
+#endif
+	}
+	free(sink);
+}
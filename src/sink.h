@@ -0,0 +1,48 @@
+/**
+ * @file sink.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Buffered output to files, standard output or network collectors. Points in time are given in
+ * milliseconds since the epoch.
+ */
+#ifndef __SINK_H__
+#define __SINK_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "utility/tchar.h"
+
+
+/** Output sink flush policies. */
+typedef enum tSinkFlush {
+	SF_LINE = 0, /**< flush after each record */
+	SF_INTERVAL, /**< flush records buffered for the given number of seconds */
+	SF_BYTES,    /**< flush if at least the given number of bytes are buffered */
+	SF_RECORDS   /**< flush if the given number of records are buffered or the oldest one lingered */
+} tSinkFlush;
+
+
+/**
+ * @internal target specific
+ */
+typedef struct tSink tSink;
+
+
+int sinkIsUrl(const TCHAR * path);
+tSink * sinkOpen(const TCHAR * path, const int utf8, const int crlf, const tSinkFlush flush, const size_t param, const size_t linger);
+int sinkWrite(tSink * sink, const char * str, const size_t len, const int64_t now);
+int sinkWriteRaw(tSink * sink, const uint8_t * data, const size_t size, const int64_t now);
+int sinkIsEmpty(const tSink * sink);
+int sinkPoll(tSink * sink, const int64_t now);
+int sinkDeadline(const tSink * sink, int64_t * deadline);
+int sinkFlush(tSink * sink);
+int sinkReopen(tSink * sink, const TCHAR * path);
+int sinkPreallocate(tSink * sink, const uint64_t size);
+uint64_t sinkFileSize(const tSink * sink);
+void sinkClose(tSink * sink);
+
+
+#endif /* __SINK_H__ */
@@ -0,0 +1,217 @@
+/**
+ * @file stats.c
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#include <math.h>
+#include <string.h>
+#include "stats.h"
+
+
+/** Desired marker position increments of the P-square estimator for the median. */
+static const double p2Increment[STATS_P2_MARKERS] = {0.0, 0.25, 0.5, 0.75, 1.0};
+
+
+/**
+ * Returns the parabolic prediction of the P-square estimator for the given marker.
+ *
+ * @param[in] stats - statistics
+ * @param[in] i - marker index (1 to 3)
+ * @param[in] d - adjustment direction (-1 or 1)
+ * @return predicted marker height
+ */
+static double p2Parabolic(const tStats * stats, const size_t i, const double d) {
+	const double * q = stats->q;
+	const double * n = stats->n;
+	return q[i] + (d / (n[i + 1] - n[i - 1])) * (
+		((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]))
+		+ ((n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]))
+	);
+}
+
+
+/**
+ * Adds the given value to the P-square median estimator.
+ *
+ * @param[in,out] stats - statistics with the value already counted
+ * @param[in] value - value to add
+ */
+static void p2Add(tStats * stats, const double value) {
+	double * q = stats->q;
+	double * n = stats->n;
+	size_t i, k;
+	if (stats->count <= STATS_P2_MARKERS) {
+		/* collect the initial values in sorted order */
+		for (i = stats->count - 1; i > 0 && q[i - 1] > value; i--) q[i] = q[i - 1];
+		q[i] = value;
+		if (stats->count == STATS_P2_MARKERS) {
+			for (i = 0; i < STATS_P2_MARKERS; i++) {
+				n[i] = (double)i;
+				stats->np[i] = 4.0 * p2Increment[i];
+			}
+		}
+		return;
+	}
+	/* find the cell of the new value */
+	if (value < q[0]) {
+		q[0] = value;
+		k = 0;
+	} else if (value >= q[STATS_P2_MARKERS - 1]) {
+		q[STATS_P2_MARKERS - 1] = value;
+		k = STATS_P2_MARKERS - 2;
+	} else {
+		for (k = 0; k < (STATS_P2_MARKERS - 2) && value >= q[k + 1]; k++);
+	}
+	for (i = k + 1; i < STATS_P2_MARKERS; i++) n[i] += 1.0;
+	for (i = 0; i < STATS_P2_MARKERS; i++) stats->np[i] += p2Increment[i];
+	/* adjust the heights of the inner markers */
+	for (i = 1; i < (STATS_P2_MARKERS - 1); i++) {
+		const double d = stats->np[i] - n[i];
+		if ((d >= 1.0 && (n[i + 1] - n[i]) > 1.0) || (d <= -1.0 && (n[i - 1] - n[i]) < -1.0)) {
+			const double dir = (d >= 0.0) ? 1.0 : -1.0;
+			const double qp = p2Parabolic(stats, i, dir);
+			if (q[i - 1] < qp && qp < q[i + 1]) {
+				q[i] = qp;
+			} else {
+				/* linear prediction */
+				const size_t j = (dir > 0.0) ? i + 1 : i - 1;
+				q[i] += dir * (q[j] - q[i]) / (n[j] - n[i]);
+			}
+			n[i] += dir;
+		}
+	}
+}
+
+
+/**
+ * Resets the given statistics to an empty value series.
+ *
+ * @param[out] stats - statistics to reset
+ */
+void statsReset(tStats * stats) {
+	if (stats == NULL) return;
+	memset(stats, 0, sizeof(*stats));
+	stats->p2 = 1;
+}
+
+
+/**
+ * Adds the given value to the statistics. The mean and variance are updated with Welford's
+ * algorithm and the median with the P-square estimator.
+ *
+ * @param[in,out] stats - statistics
+ * @param[in] value - value to add
+ */
+void statsAdd(tStats * stats, const double value) {
+	if (stats == NULL) return;
+	stats->count++;
+	if (stats->count == 1) {
+		stats->min = value;
+		stats->max = value;
+	} else {
+		if (value < stats->min) stats->min = value;
+		if (value > stats->max) stats->max = value;
+	}
+	const double delta = value - stats->mean;
+	stats->mean += delta / (double)(stats->count);
+	stats->m2 += delta * (value - stats->mean);
+	if (stats->p2 != 0) p2Add(stats, value);
+}
+
+
+/**
+ * Adds a series of values given by its summary to the statistics.
+ *
+ * @param[in,out] stats - statistics
+ * @param[in] count - number of values in the series
+ * @param[in] mean - mean of the series
+ * @param[in] sd - sample standard deviation of the series
+ * @param[in] min - minimal value of the series
+ * @param[in] max - maximal value of the series
+ * @remarks The median of the series is approximated by its mean.
+ */
+void statsAddSummary(tStats * stats, const size_t count, const double mean, const double sd, const double min, const double max) {
+	tStats other;
+	if (stats == NULL || count == 0) return;
+	memset(&other, 0, sizeof(other));
+	other.count = count;
+	other.mean = mean;
+	other.m2 = sd * sd * (double)(count - 1);
+	other.min = min;
+	other.max = max;
+	other.median = mean;
+	statsMerge(stats, &other);
+}
+
+
+/**
+ * Merges the given statistics into the passed one. Count, mean, variance, minimum and maximum are
+ * combined exactly (Chan et al.). The median is approximated by the count weighted mean of both
+ * medians.
+ *
+ * @param[in,out] stats - statistics to merge into
+ * @param[in] other - statistics to merge
+ */
+void statsMerge(tStats * stats, const tStats * other) {
+	if (stats == NULL || other == NULL || other->count == 0) return;
+	if (stats->count == 0) {
+		memcpy(stats, other, sizeof(*stats));
+		return;
+	}
+	const double na = (double)(stats->count);
+	const double nb = (double)(other->count);
+	const double n = na + nb;
+	const double delta = other->mean - stats->mean;
+	stats->median = ((statsMedian(stats) * na) + (statsMedian(other) * nb)) / n;
+	stats->p2 = 0;
+	stats->mean += delta * nb / n;
+	stats->m2 += other->m2 + (delta * delta * na * nb / n);
+	if (other->min < stats->min) stats->min = other->min;
+	if (other->max > stats->max) stats->max = other->max;
+	stats->count += other->count;
+}
+
+
+/**
+ * Returns the arithmetic mean of the given statistics.
+ *
+ * @param[in] stats - statistics
+ * @return mean or NaN if empty
+ */
+double statsMean(const tStats * stats) {
+	if (stats == NULL || stats->count == 0) return (double)NAN;
+	return stats->mean;
+}
+
+
+/**
+ * Returns the sample standard deviation of the given statistics.
+ *
+ * @param[in] stats - statistics
+ * @return standard deviation, 0 for a single value or NaN if empty
+ */
+double statsSd(const tStats * stats) {
+	if (stats == NULL || stats->count == 0) return (double)NAN;
+	if (stats->count < 2) return 0.0;
+	return sqrt(stats->m2 / (double)(stats->count - 1));
+}
+
+
+/**
+ * Returns the median of the given statistics. The value is exact for up to STATS_P2_MARKERS values
+ * and approximated otherwise.
+ *
+ * @param[in] stats - statistics
+ * @return median or NaN if empty
+ */
+double statsMedian(const tStats * stats) {
+	if (stats == NULL || stats->count == 0) return (double)NAN;
+	if (stats->p2 == 0) return stats->median;
+	if (stats->count < STATS_P2_MARKERS) {
+		const size_t mid = stats->count / 2;
+		return ((stats->count & 1) != 0) ? stats->q[mid] : (stats->q[mid - 1] + stats->q[mid]) / 2.0;
+	}
+	return stats->q[2];
+}
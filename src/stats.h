@@ -0,0 +1,45 @@
+/**
+ * @file stats.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include <stddef.h>
+
+
+/** Number of markers of the P-square median estimator. */
+#define STATS_P2_MARKERS 5
+
+
+/**
+ * Streaming statistics of a single value series. The memory usage is constant regardless of the
+ * number of values added. Initialize with statsReset() before use.
+ */
+typedef struct tStats {
+	size_t count; /**< number of values */
+	double mean; /**< arithmetic mean (Welford) */
+	double m2; /**< sum of squared differences from the mean (Welford) */
+	double min; /**< minimal value */
+	double max; /**< maximal value */
+	double q[STATS_P2_MARKERS]; /**< P-square marker heights */
+	double np[STATS_P2_MARKERS]; /**< P-square desired marker positions */
+	double n[STATS_P2_MARKERS]; /**< P-square actual marker positions */
+	int p2; /**< non-zero if the P-square estimator covers all values */
+	double median; /**< approximated median if p2 is zero */
+} tStats;
+
+
+void statsReset(tStats * stats);
+void statsAdd(tStats * stats, const double value);
+void statsAddSummary(tStats * stats, const size_t count, const double mean, const double sd, const double min, const double max);
+void statsMerge(tStats * stats, const tStats * other);
+double statsMean(const tStats * stats);
+double statsSd(const tStats * stats);
+double statsMedian(const tStats * stats);
+
+
+#endif /* __STATS_H__ */
@@ -3,12 +3,12 @@
  * @author Daniel Starke
  * @copyright Copyright 2019 Daniel Starke
  * @date 2019-06-02
- * @version 2023-04-11
+ * @version 2026-10-14
  */
 #include <ctype.h>
 #include <errno.h>
-#include <math.h>
 #include <signal.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -19,15 +19,27 @@
 #include "utility/serial.h"
 #include "utility/target.h"
 #include "utility/tchar.h"
+#include "utility/thread.h"
 #include "license.i"
+#include "capture.h"
+#include "format.h"
+#include "metrics.h"
 #include "parse.h"
+#include "queue.h"
+#include "record.h"
+#include "shm.h"
+#include "sink.h"
+#include "stats.h"
 #include "version.h"
 
 
 #if defined(PCF_IS_WIN)
 #include <windows.h>
 #elif defined(PCF_IS_LINUX)
+#include <spawn.h>
 #include <unistd.h>
+#include <sys/wait.h>
+extern char ** environ;
 #else /* not PCF_IS_WIN and not PCF_IS_LINUX */
 #error Unsupported target OS.
 #endif
@@ -41,12 +53,80 @@
 #define DEFAULT_INTERVAL 10
 
 
-/** Timeout resolution in milliseconds. Needed to handle SIGINT/SIGTERM quickly. */
-#define TIMEOUT_RESOLUTION 100
+/** Defines the maximum number of rollup levels per device (see option --rollup). */
+#define MAX_ROLLUPS 4
 
 
-/** Defines the input buffer size for the sensor data. */
-#define INPUT_BUFFER_SIZE 64
+/** Defines the default serial interface speed in baud. */
+#define DEFAULT_BAUD 9600
+
+
+/**
+ * Defines the input buffer size for the sensor data. Each read drains the receive buffer of the
+ * serial driver up to this size.
+ */
+#define INPUT_BUFFER_SIZE 4096
+
+
+/** Defines the maximum length of a control line from the remote device. */
+#define CTRL_LINE_SIZE 16
+
+
+/** Defines the timeout for commands sent to the remote device in milliseconds. */
+#define COMMAND_TIMEOUT 1000
+
+
+/** Defines the default time to wait for the remote device to become ready in milliseconds. */
+#define DEFAULT_READY_TIMEOUT 2000
+
+
+/** Defines the time between two readiness requests in milliseconds. */
+#define READY_RETRY 250
+
+
+/** Defines the default number of samples queued between the reader and writer thread. */
+#define DEFAULT_QUEUE_SIZE 4096
+
+
+/** Defines the time between two attempts to move spilled samples back to the queue in milliseconds. */
+#define QUEUE_SERVICE_DELAY 10
+
+
+/** Defines the default time between two updates of the metrics file in seconds. */
+#define DEFAULT_METRICS_INTERVAL 10
+
+
+/** Defines the initial delay before reconnecting to a lost remote device in milliseconds. */
+#define RECONNECT_DELAY 250
+
+
+/** Defines the default maximum delay between two reconnection attempts in seconds. */
+#define DEFAULT_RECONNECT_MAX 30
+
+
+/**
+ * Defines the delay between the notification about a new serial device and the reconnection
+ * attempt in milliseconds. This gives the system time to set up the device node.
+ */
+#define HOTPLUG_DELAY 500
+
+
+/**
+ * Defines the file extensions of common compression tools which are considered when checking
+ * whether a rotated output file exists already.
+ */
+#define COMPRESS_EXTS {_T(".gz"), _T(".bz2"), _T(".xz"), _T(".zst")}
+
+
+/** Defines the maximum length of the extensions in COMPRESS_EXTS in number of characters. */
+#define COMPRESS_EXT_MAX 4
+
+
+/**
+ * Defines the output format string for the InfluxDB line protocol. The first %s is replaced by the
+ * escaped device path. The time stamp is given in nanoseconds.
+ */
+#define INFLUX_FORMAT _T("thlog,device=%s,channel=%%vI temperature=%%.1vC,humidity=%%.1vH,count=%%vNi %%s%%3f000000\\n")
 
 
 /** Returns the given UTF-8 error message string. */
@@ -57,32 +137,208 @@
 #define MSGT(x) ((const TCHAR *)fmsg[(x)])
 
 
+/** Output file formats. */
+typedef enum tOutFormat {
+	OF_TEXT = 0, /**< text according to the output format string */
+	OF_BINARY,   /**< fixed-width binary records (see record.h) */
+	OF_COLUMNAR, /**< columnar blocks (see record.h) */
+	OF_INFLUX    /**< InfluxDB line protocol text (see INFLUX_FORMAT) */
+} tOutFormat;
+
+
+/** Connection handshake steps of a reconnecting remote device. */
+typedef enum tLinkState {
+	LS_IDLE = 0,  /**< no handshake in progress */
+	LS_READY,     /**< waiting for the readiness signal */
+	LS_BAUD,      /**< waiting for the acknowledgement of the speed switch */
+	LS_AGGREGATE  /**< waiting for the acknowledgement of the aggregation request */
+} tLinkState;
+
+
 /** Defines the data processing configuration parameters. */
 typedef struct tConfig {
 	size_t intvl; /**< update interval in seconds */
 	int utc; /**< non-zero to represent the time in UTC instead of local time */
 	const TCHAR * fmt; /**< output format string supporting all of strftime and %vC, %vF, %vH */
+	tFmtProg * prog; /**< compiled output format string */
+	const TCHAR * output; /**< output file path or NULL for standard output */
+	tSinkFlush flush; /**< output flush policy */
+	size_t flushParam; /**< output flush policy parameter */
+	size_t flushLinger; /**< maximum time in milliseconds a record is buffered with SF_RECORDS or 0 */
+	int binary; /**< non-zero to request the binary protocol from the remote device */
+	size_t baud; /**< serial interface speed in baud */
+	size_t baudSwitch; /**< serial interface speed requested after connecting or 0 */
+	tSerFraming framing; /**< serial interface framing */
+	tSerFlowCtrl flow; /**< serial interface flow control */
+	size_t readyTimeout; /**< time to wait for the remote device to become ready in milliseconds */
+	int aggregate; /**< non-zero to request on-device aggregation over the update interval */
+	const TCHAR * rawTee; /**< raw capture file path for the received data or NULL */
+	int align; /**< non-zero to align the intervals to wall clock boundaries */
+	tOutFormat outFormat; /**< output file format */
+	uint64_t rotateSize; /**< output file size in bytes which starts a new file or 0 */
+	size_t rotateIntvl; /**< period in seconds after which a new output file is started or 0 */
+	uint64_t prealloc; /**< disk space in bytes to preallocate for each output file or 0 */
+	const TCHAR * compress; /**< command to compress each rotated output file or NULL */
+	int crlf; /**< non-zero to write line feeds as CR/LF */
 } tConfig;
 
 
+/** Defines an output file which may be shared by several devices. */
+typedef struct tOutput {
+	const TCHAR * path; /**< output file path or NULL for standard output */
+	tSink * sink; /**< buffered output sink */
+	tOutFormat format; /**< output file format */
+	tRecBlock * block; /**< columnar block which is being filled or NULL */
+	tFmtProg * name; /**< compiled output file path pattern if rotated, else NULL */
+	TCHAR * file; /**< current output file path if rotated, else NULL */
+	uint64_t rotateSize; /**< output file size in bytes which starts a new file or 0 */
+	size_t rotateIntvl; /**< period in seconds after which a new output file is started or 0 */
+	int64_t rotateAt; /**< wall clock time in milliseconds when the next file is started */
+	int utc; /**< non-zero to align the rotation period to UTC instead of local time */
+	uint64_t prealloc; /**< disk space in bytes to preallocate for each output file or 0 */
+	const TCHAR * compress; /**< command to compress each rotated output file or NULL */
+	unsigned long seq; /**< sequence number last appended to the current output file path */
+	tThread * compressor; /**< thread running the compression command or NULL */
+	TCHAR * compressFile; /**< rotated output file path passed to compressor or NULL */
+} tOutput;
+
+
+/** Defines the values of a single sensor channel within the current interval. */
+typedef struct tChannel {
+	tStats tempStats; /**< temperature values within the current interval */
+	tStats rhStats; /**< relative humidity values within the current interval */
+	int summary; /**< non-zero if the current interval contains summaries of the remote device */
+	int intvlDue; /**< non-zero if the remote device completed the current interval */
+} tChannel;
+
+
+/** Defines a coarser output level which is computed from the intervals of the next finer level. */
+typedef struct tRollup {
+	tConfig cfg; /**< data processing configuration of this level */
+	tOutput * out; /**< output file */
+	TCHAR * influxFmt; /**< generated output format string for OF_INFLUX or NULL */
+	tChannel chan[PROTO_MAX_CHANNELS]; /**< merged values of each sensor channel */
+	int64_t intvlEnd; /**< monotonic end time of the current interval in ms or INT64_MAX if not started */
+} tRollup;
+
+
+/** Defines the data processing state of a single remote device. */
+typedef struct tDevice {
+	char * name; /**< UTF-8 encoded device path */
+	tSerial * ser; /**< serial device handle */
+	const TCHAR * replayPath; /**< raw capture file to replay instead of a serial device or NULL */
+	tCapReader * replay; /**< raw capture file reader if replayed */
+	tCapWriter * tee; /**< raw capture file writer for the received data or NULL */
+	tConfig cfg; /**< data processing configuration */
+	tOutput * out; /**< output file */
+	tChannel chan[PROTO_MAX_CHANNELS]; /**< values of each sensor channel */
+	tPLineCtx pLine; /**< sensor value line parser context */
+	tPFrameCtx pFrame; /**< binary frame parser context */
+	TCHAR * influxFmt; /**< generated output format string for OF_INFLUX or NULL */
+	tRollup * rollup; /**< coarser output levels from fine to coarse or NULL */
+	size_t rollupCount; /**< number of levels in rollup */
+	int binary; /**< non-zero if the remote device sends binary frames */
+	int seqValid; /**< non-zero if seq holds the sequence number of the last frame */
+	uint8_t seq; /**< sequence number of the last frame */
+	const char * expect; /**< control line expected as acknowledgement or NULL */
+	int acked; /**< non-zero if the expected control line was received */
+	tLinkState link; /**< connection handshake step while reconnecting */
+	char cmd[CTRL_LINE_SIZE]; /**< command whose acknowledgement is expected while reconnecting */
+	int64_t linkAt; /**< monotonic time of the next readiness request in ms while reconnecting */
+	int64_t linkDeadline; /**< monotonic timeout of the current handshake step in ms */
+	int done; /**< non-zero if no more output is needed (see option --once) */
+	int intvlDue; /**< non-zero to complete the current interval of all channels */
+	int64_t intvlEnd; /**< monotonic end time of the current interval in ms or INT64_MAX if not started */
+	int64_t retryAt; /**< monotonic time of the next reconnection attempt in ms while disconnected */
+	size_t retryDelay; /**< current delay between two reconnection attempts in ms */
+	size_t sampleCount; /**< number of samples received since start */
+	size_t lineCount; /**< number of lines output since start */
+	tMetrics met; /**< operational counters */
+	tShmSlot * shm; /**< first of the PROTO_MAX_CHANNELS shared memory slots or NULL */
+} tDevice;
+
+
+/** Defines a decoded sample passed from the reader thread to the writer thread. */
+typedef struct tSample {
+	tDevice * dev; /**< device which received the sample */
+	int64_t mono; /**< monotonic reception time in milliseconds */
+	int64_t wall; /**< wall clock reception time in milliseconds since the epoch */
+	int summary; /**< non-zero if value holds the values of a summary frame */
+	uint8_t channel; /**< sensor channel number */
+	int32_t temp; /**< temperature in tenths of degrees Celsius if not a summary */
+	int32_t rh; /**< relative humidity in tenths of percent if not a summary */
+	int16_t value[PROTO_SUMMARY_VALUES]; /**< summary frame values */
+} tSample;
+
+
+/** Defines the shared state of the reader and writer thread. */
+typedef struct tWriter {
+	tDevice * devs; /**< list of devices */
+	size_t count; /**< number of devices in devs */
+	int stop; /**< set by the reader thread to finish after the queued samples */
+	int finished; /**< set by the writer thread once it finished */
+} tWriter;
+
+
 typedef enum {
 	MSGT_SUCCESS = 0,
 	MSGT_ERR_NO_MEM,
 	MSGT_ERR_OPT_NO_ARG,
 	MSGT_ERR_OPT_BAD_INTERVAL,
+	MSGT_ERR_OPT_BAD_FLUSH,
+	MSGT_ERR_OPT_BAD_PROTOCOL,
+	MSGT_ERR_OPT_BAD_BAUD,
+	MSGT_ERR_OPT_BAD_FRAMING,
+	MSGT_ERR_OPT_BAD_FLOW,
+	MSGT_ERR_OPT_BAD_OUT_FORMAT,
+	MSGT_ERR_OPT_BAD_TIMEOUT,
+	MSGT_ERR_OPT_BAD_QUEUE_SIZE,
+	MSGT_ERR_OPT_BAD_BACKPRESSURE,
+	MSGT_ERR_OPT_BAD_SINK,
+	MSGT_ERR_OPT_BAD_ROTATE,
+	MSGT_ERR_OPT_BAD_PREALLOC,
 	MSGT_ERR_OPT_NO_DEVICE,
+	MSGT_ERR_OPT_MANY_DEVICES,
+	MSGT_ERR_OPT_MANY_ROLLUPS,
+	MSGT_ERR_OPT_BAD_ROLLUP,
+	MSGT_ERR_OPT_REPLAY_MIX,
+	MSGT_ERR_OPT_TEE_SHARED,
+	MSGT_ERR_OPT_OUT_FORMAT_MIX,
+	MSGT_ERR_OPT_OUT_FORMAT_STDOUT,
+	MSGT_ERR_OPT_ROTATE_FILE,
 	MSGT_ERR_OPT_AMB_C,
 	MSGT_ERR_OPT_AMB_S,
 	MSGT_ERR_OPT_AMB_X,
 	MSGT_ERR_REMOTE_CONNECT,
+	MSGT_ERR_REMOTE_CONFIG,
+	MSGT_ERR_REMOTE_WAIT,
 	MSGT_ERR_REMOTE_READ,
+	MSGT_ERR_REMOTE_WRITE,
 	MSGT_ERR_REMOTE_VALUE,
+	MSGT_ERR_REMOTE_CHANNEL_VALUE,
 	MSGT_ERR_REMOTE_CHECKSUM,
+	MSGT_WARN_REMOTE_LOST,
+	MSGT_WARN_REMOTE_NO_ACK,
+	MSGT_WARN_REMOTE_NOT_READY,
+	MSGT_WARN_REMOTE_DISCONNECTED,
+	MSGT_INFO_REMOTE_RECONNECTED,
 	MSGT_ERR_FMT_OVERFLOW,
 	MSGT_ERR_FMT_SYNTAX,
-	MSGT_ERR_FMT_LENGTH,
 	MSGT_ERR_FMT_API,
+	MSGT_ERR_FMT_VALUE,
 	MSGT_ERR_FMT_WRITE,
+	MSGT_ERR_FILE_OPEN,
+	MSGT_ERR_SINK_OPEN,
+	MSGT_WARN_PREALLOC,
+	MSGT_WARN_COMPRESS,
+	MSGT_ERR_CAP_OPEN,
+	MSGT_ERR_CAP_READ,
+	MSGT_ERR_CAP_WRITE,
+	MSGT_ERR_THREAD,
+	MSGT_WARN_QUEUE_DROPPED,
+	MSGT_INFO_QUEUE_STATS,
+	MSGT_WARN_METRICS_WRITE,
+	MSGT_ERR_SHM_CREATE,
 	MSGT_INFO_SIGTERM,
 	MSG_COUNT
 } tMessage;
@@ -92,26 +348,79 @@ static const void * fmsg[MSG_COUNT] = {
 	/* MSGT_SUCCESS                    */ _T(""), /* never used for output */
 	/* MSGT_ERR_NO_MEM                 */ _T("Error: Failed to allocate memory.\n"),
 	/* MSGT_ERR_OPT_NO_ARG             */ _T("Error: Option argument is missing for '%s'.\n"),
-	/* MSGT_ERR_OPT_BAD_INTERVAL       */ _T("Error: Invalid interval value. (%s)"),
+	/* MSGT_ERR_OPT_BAD_INTERVAL       */ _T("Error: Invalid interval value. (%s)\n"),
+	/* MSGT_ERR_OPT_BAD_FLUSH          */ _T("Error: Invalid flush policy. (%s)\n"),
+	/* MSGT_ERR_OPT_BAD_PROTOCOL       */ _T("Error: Invalid protocol. (%s)\n"),
+	/* MSGT_ERR_OPT_BAD_BAUD           */ _T("Error: Invalid baud rate. (%s)\n"),
+	/* MSGT_ERR_OPT_BAD_FRAMING        */ _T("Error: Invalid framing. (%s)\n"),
+	/* MSGT_ERR_OPT_BAD_FLOW           */ _T("Error: Invalid flow control. (%s)\n"),
+	/* MSGT_ERR_OPT_BAD_OUT_FORMAT     */ _T("Error: Invalid output format. (%s)\n"),
+	/* MSGT_ERR_OPT_BAD_TIMEOUT        */ _T("Error: Invalid timeout value. (%s)\n"),
+	/* MSGT_ERR_OPT_BAD_QUEUE_SIZE     */ _T("Error: Invalid queue size. (%s)\n"),
+	/* MSGT_ERR_OPT_BAD_BACKPRESSURE   */ _T("Error: Invalid backpressure policy. (%s)\n"),
+	/* MSGT_ERR_OPT_BAD_SINK           */ _T("Error: Invalid network sink. (%s)\n"),
+	/* MSGT_ERR_OPT_BAD_ROTATE         */ _T("Error: Invalid rotation policy. (%s)\n"),
+	/* MSGT_ERR_OPT_BAD_PREALLOC       */ _T("Error: Invalid preallocation size. (%s)\n"),
 	/* MSGT_ERR_OPT_NO_DEVICE          */ _T("Error: Missing device.\n"),
+	/* MSGT_ERR_OPT_MANY_DEVICES       */ _T("Error: Too many devices. At most %u devices are supported.\n"),
+	/* MSGT_ERR_OPT_MANY_ROLLUPS       */ _T("Error: Too many rollup levels. At most %u levels are supported.\n"),
+	/* MSGT_ERR_OPT_BAD_ROLLUP         */ _T("Error: The rollup interval %u needs to be a larger multiple of the previous interval %u.\n"),
+	/* MSGT_ERR_OPT_REPLAY_MIX         */ _T("Error: Replayed raw captures cannot be combined with serial devices.\n"),
+	/* MSGT_ERR_OPT_TEE_SHARED         */ _T("Error: Raw capture file '%s' is used by multiple devices.\n"),
+	/* MSGT_ERR_OPT_OUT_FORMAT_MIX     */ _T("Error: Output file '%s' is used with different output formats.\n"),
+	/* MSGT_ERR_OPT_OUT_FORMAT_STDOUT  */ _T("Error: Binary output formats need an output file.\n"),
+	/* MSGT_ERR_OPT_ROTATE_FILE        */ _T("Error: File rotation needs an output file.\n"),
 	/* MSGT_ERR_OPT_AMB_C              */ _T("Error: Unknown or ambiguous option '-%c'.\n"),
 	/* MSGT_ERR_OPT_AMB_S              */ _T("Error: Unknown or ambiguous option '%s'.\n"),
 	/* MSGT_ERR_OPT_AMB_X              */ _T("Error: Unknown option character '0x%02X'.\n"),
 	/* MSGT_ERR_REMOTE_CONNECT         */ _T2("Error: Failed to connect to remote device via %" PRUTF8 ".\n"),
-	/* MSGT_ERR_REMOTE_READ            */ _T("Error: Failed to read data from remote device.\n"),
-	/* MSGT_ERR_REMOTE_VALUE           */ _T("Error: The remote device returned error code %u.\n"),
-	/* MSGT_ERR_REMOTE_CHECKSUM        */ _T("Error: Checksum of the remote data failed.\n"),
+	/* MSGT_ERR_REMOTE_CONFIG          */ _T2("Error: Failed to configure the serial interface of remote device %" PRUTF8 ".\n"),
+	/* MSGT_ERR_REMOTE_WAIT            */ _T("Error: Failed to wait for data from the remote devices.\n"),
+	/* MSGT_ERR_REMOTE_READ            */ _T2("Error: Failed to read data from remote device %" PRUTF8 ".\n"),
+	/* MSGT_ERR_REMOTE_WRITE           */ _T2("Error: Failed to send command to remote device %" PRUTF8 ".\n"),
+	/* MSGT_ERR_REMOTE_VALUE           */ _T2("Error: The remote device %" PRUTF8 " returned error code %u.\n"),
+	/* MSGT_ERR_REMOTE_CHANNEL_VALUE   */ _T2("Error: The remote device %" PRUTF8 " returned error code %u for sensor %u.\n"),
+	/* MSGT_ERR_REMOTE_CHECKSUM        */ _T2("Error: Checksum of the remote data from %" PRUTF8 " failed.\n"),
+	/* MSGT_WARN_REMOTE_LOST           */ _T2("Warning: Lost %u frames from remote device %" PRUTF8 ".\n"),
+	/* MSGT_WARN_REMOTE_NO_ACK         */ _T2("Warning: Remote device %" PRUTF8 " did not acknowledge \"%" PRUTF8 "\".\n"),
+	/* MSGT_WARN_REMOTE_NOT_READY      */ _T2("Warning: Remote device %" PRUTF8 " did not signal readiness in time.\n"),
+	/* MSGT_WARN_REMOTE_DISCONNECTED   */ _T2("Warning: Lost connection to remote device %" PRUTF8 ". Reconnecting.\n"),
+	/* MSGT_INFO_REMOTE_RECONNECTED    */ _T2("Info: Reconnected to remote device %" PRUTF8 ".\n"),
 	/* MSGT_ERR_FMT_OVERFLOW           */ _T("Error: Format code width/precision modifier is too large.\n%.*s<<<HERE<<<%s\n"),
 	/* MSGT_ERR_FMT_SYNTAX             */ _T("Error: Format code syntax error.\n%.*s<<<HERE<<<%s\n"),
-	/* MSGT_ERR_FMT_LENGTH             */ _T("Error: Format code length error.\n%.*s<<<HERE<<<%s\n"),
 	/* MSGT_ERR_FMT_API                */ _T("Error: Format code error reported by underlaying API.\n%.*s<<<HERE<<<%s\n"),
+	/* MSGT_ERR_FMT_VALUE              */ _T("Error: Sensor value format codes are not allowed in file paths.\n%.*s<<<HERE<<<%s\n"),
 	/* MSGT_ERR_FMT_WRITE              */ _T("Error: Failed to write formatted sensor data.\n"),
+	/* MSGT_ERR_FILE_OPEN              */ _T("Error: Failed to open output file '%s'.\n"),
+	/* MSGT_ERR_SINK_OPEN              */ _T("Error: Failed to resolve or open network sink '%s'.\n"),
+	/* MSGT_WARN_PREALLOC              */ _T("Warning: Failed to preallocate disk space for output file '%s'.\n"),
+	/* MSGT_WARN_COMPRESS              */ _T("Warning: Failed to compress rotated output file '%s'.\n"),
+	/* MSGT_ERR_CAP_OPEN               */ _T("Error: Failed to open raw capture file '%s'.\n"),
+	/* MSGT_ERR_CAP_READ               */ _T2("Error: Failed to read raw capture file %" PRUTF8 ".\n"),
+	/* MSGT_ERR_CAP_WRITE              */ _T2("Error: Failed to write raw capture of remote device %" PRUTF8 ". Recording stopped.\n"),
+	/* MSGT_ERR_THREAD                 */ _T("Error: Failed to start the output thread.\n"),
+	/* MSGT_WARN_QUEUE_DROPPED         */ _T("Warning: Dropped %u samples because the output could not keep up.\n"),
+	/* MSGT_INFO_QUEUE_STATS           */ _T("Info: At most %u of %u queued samples were used. %u samples were spilled to disk.\n"),
+	/* MSGT_WARN_METRICS_WRITE         */ _T("Warning: Failed to write metrics file '%s'.\n"),
+	/* MSGT_ERR_SHM_CREATE             */ _T("Error: Failed to create shared memory segment '%s'.\n"),
 	/* MSGT_INFO_SIGTERM               */ _T("Info: Received signal. Finishing current operation.\n")
 };
 
 
 static volatile int signalReceived = 0;
+static tSerWakeup * wakeup = NULL; /* wakes up the event loop on SIGINT/SIGTERM */
 static int verbose = 1; /* 0 = critical, 1 = error, 2 = warn, 3 = info, 4 = debug */
+static int once = 0; /* non-zero to exit after the first valid sample of each device */
+static int utf8Out = 0; /* non-zero to write UTF-8 instead of UTF-16 to standard output */
+static size_t queueSize = DEFAULT_QUEUE_SIZE; /* number of queued samples or 0 to use a single thread */
+static tQueuePolicy queuePolicy = QP_BLOCK; /* backpressure policy of the sample queue */
+static tQueue * sampleQueue = NULL; /* passes the samples to the writer thread while it runs */
+static const TCHAR * metricsPath = NULL; /* metrics file path or NULL */
+static size_t metricsIntvl = DEFAULT_METRICS_INTERVAL; /* time between two metrics file updates in seconds */
+static int64_t metricsDue = 0; /* monotonic time of the next metrics file update in ms */
+static const TCHAR * shmName = NULL; /* shared memory segment name or NULL */
+static tMetLoops loopMetrics = {0, 0}; /* event loop counters */
+static size_t reconnectMax = DEFAULT_RECONNECT_MAX; /* maximum delay between two reconnection attempts in seconds or 0 */
 static FILE * fin = NULL;
 static FILE * fout = NULL;
 static FILE * ferr = NULL;
@@ -120,9 +429,72 @@ static FILE * ferr = NULL;
 /* forward declarations */
 static void printHelp(void);
 static void handleSignal(int signum);
-static int processData(tSerial * ser, uint8_t * inBuf, const size_t inBufSize, const tConfig * cfg);
-static int printData(FILE * fd, const TCHAR * fmt, const struct tm * timeInfo, const float temp, const float rh);
-static void delay(const unsigned long duration);
+static int addDevice(tDevice * devs, size_t * count, const TCHAR * path, const tConfig * cfg, const tConfig * rollups, const size_t rollupCount);
+static int parseFlush(tConfig * cfg, const TCHAR * str);
+static int parseRotate(tConfig * cfg, const TCHAR * str);
+static int parseSize(const TCHAR * str, TCHAR ** end, uint64_t * size);
+static tOutput * openOutput(tOutput * outs, size_t * count, const tConfig * cfg);
+static int writeHeader(tOutput * out, const int64_t now);
+static void preallocOutput(tOutput * out);
+static TCHAR * getOutputFile(tOutput * out, const int64_t wall, const int unique);
+static int64_t getRotateTime(const tOutput * out, const int64_t wall);
+static int rotateOutput(tOutput * out, const int64_t wall);
+static void compressOutput(tOutput * out, TCHAR * file);
+static void finishCompress(tOutput * out);
+static int runCompress(void * arg);
+static int runCommand(const TCHAR * cmd, const TCHAR * file);
+static int fileExists(const TCHAR * path);
+static int outputFileExists(TCHAR * path, const size_t len);
+static int processData(tDevice * devs, const size_t count, tRing * in);
+static int runWriter(void * arg);
+static int processOutput(tDevice * devs, const size_t count, const int64_t mono, const int64_t wall);
+static int pollOutput(tDevice * devs, const size_t count, const int64_t wall);
+static int flushOutput(tDevice * devs, const size_t count);
+static size_t getOutputTimeout(const tDevice * devs, const size_t count, const int64_t mono);
+static void writeMetrics(const tDevice * devs, const size_t count);
+static int processReplay(tDevice * devs, const size_t count);
+static int parseBaud(const TCHAR * str, size_t * baud);
+static int parseFraming(const TCHAR * str, tSerFraming * framing);
+static int parseFlow(const TCHAR * str, tSerFlowCtrl * flow);
+static int parseOutFormat(const TCHAR * str, tOutFormat * format);
+static int parseBackpressure(const TCHAR * str, tQueuePolicy * policy);
+static void initDevice(tDevice * dev);
+static void resetLink(tDevice * dev);
+static void disconnectDevice(tDevice * dev, const int64_t mono);
+static int reconnectDevice(tDevice * dev, const int64_t mono);
+static int continueLink(tDevice * dev, const int64_t mono);
+static int requestLinkAck(tDevice * dev, const tLinkState link, const int64_t mono);
+static int waitReady(tDevice * devs, const size_t count, tRing * in);
+static int switchBaud(tDevice * dev, tRing * in);
+static int requestAggregation(tDevice * dev, tRing * in);
+static int sendCommand(tDevice * dev, const char * cmd);
+static int waitAck(tDevice * dev, const char * ack, tRing * in, const size_t timeout);
+static ssize_t readInput(tDevice * dev, tRing * in, const size_t timeout);
+static void processInput(tDevice * dev, const uint8_t * buf, const size_t len);
+static void processRing(tDevice * dev, tRing * in);
+static void processLine(tDevice * dev);
+static void processControl(tDevice * dev, const char * line);
+static void processFrame(tDevice * dev, const int c);
+static void addSample(tDevice * dev, const uint8_t channel, const int32_t temp, const int32_t rh);
+static void addSummary(tDevice * dev, const uint8_t channel, const int16_t * v);
+static void applySample(tDevice * dev, const uint8_t channel, const int32_t temp, const int32_t rh, const int64_t wall);
+static void applySummary(tDevice * dev, const uint8_t channel, const int16_t * v, const int64_t wall);
+static void resetValues(tDevice * dev);
+static int hasValues(const tChannel * chan);
+static int processInterval(tDevice * dev, const int64_t mono, const int64_t wall);
+static int processRollup(tDevice * dev, const size_t level, const int64_t mono, const int64_t wall);
+static int outputChannel(tDevice * dev, tOutput * out, const tConfig * cfg, const size_t channel, tChannel * chan, tChannel * next, const int64_t wall);
+static int64_t getFirstDeadline(const tConfig * cfg, const int64_t mono, const int64_t wall);
+static int setInfluxFormat(const char * name, tConfig * cfg, TCHAR ** influxFmt);
+static int compileFormat(tConfig * cfg);
+static tFmtProg * compileFormatString(const TCHAR * fmt, const tFmtMode mode);
+static int printData(tSink * sink, tFmtProg * prog, const int64_t timeMs, const int utc, const unsigned int channel, const tStats * temp, const tStats * rh);
+static int printRecord(tOutput * out, const int64_t timeMs, const tStats * temp, const tStats * rh, const uint16_t flags);
+static int flushBlock(tOutput * out, const int64_t now);
+static int64_t getTimeMs(void);
+static int64_t getMonoMs(void);
+static int64_t getUtcOffsetMs(const time_t now);
+static size_t msUntil(const int64_t deadline);
 
 
 /**
@@ -130,32 +502,109 @@ static void delay(const unsigned long duration);
  */
 int _tmain(int argc, TCHAR ** argv) {
 	enum {
-		GETOPT_LICENSE = 1,
-		GETOPT_UTF8 = 2,
-		GETOPT_VERSION = 3
+		GETOPT_DEVICE = 1,
+		GETOPT_LICENSE = 2,
+		GETOPT_UTF8 = 3,
+		GETOPT_VERSION = 4,
+		GETOPT_FLUSH = 5,
+		GETOPT_FRAMING = 6,
+		GETOPT_FLOW = 7,
+		GETOPT_BAUD_SWITCH = 8,
+		GETOPT_ONCE = 9,
+		GETOPT_RAW_TEE = 10,
+		GETOPT_REPLAY = 11,
+		GETOPT_ALIGN = 12,
+		GETOPT_OUT_FORMAT = 13,
+		GETOPT_QUEUE_SIZE = 14,
+		GETOPT_BACKPRESSURE = 15,
+		GETOPT_SINK = 16,
+		GETOPT_METRICS = 17,
+		GETOPT_METRICS_INTERVAL = 18,
+		GETOPT_RECONNECT = 19,
+		GETOPT_ROLLUP = 20,
+		GETOPT_SHM = 21,
+		GETOPT_ROTATE = 22,
+		GETOPT_PREALLOCATE = 23,
+		GETOPT_COMPRESS = 24,
+		GETOPT_CRLF = 25
 	};
 	char POSIXLY_CORRECT[] = "POSIXLY_CORRECT=";
 	int ret = EXIT_FAILURE;
 	TCHAR * strNum;
 	struct option longOptions[] = {
+		{_T("align"),        no_argument,       NULL,   GETOPT_ALIGN},
+		{_T("backpressure"), required_argument, NULL, GETOPT_BACKPRESSURE},
+		{_T("output-format"), required_argument, NULL, GETOPT_OUT_FORMAT},
 		{_T("license"),      no_argument,       NULL, GETOPT_LICENSE},
+		{_T("metrics"),      required_argument, NULL, GETOPT_METRICS},
+		{_T("metrics-interval"), required_argument, NULL, GETOPT_METRICS_INTERVAL},
 		{_T("utf8"),         no_argument,       NULL,    GETOPT_UTF8},
 		{_T("version"),      no_argument,       NULL, GETOPT_VERSION},
+		{_T("flush"),        required_argument, NULL,   GETOPT_FLUSH},
+		{_T("framing"),      required_argument, NULL, GETOPT_FRAMING},
+		{_T("flow"),         required_argument, NULL,    GETOPT_FLOW},
+		{_T("baud-switch"),  required_argument, NULL, GETOPT_BAUD_SWITCH},
+		{_T("compress"),     required_argument, NULL, GETOPT_COMPRESS},
+		{_T("crlf"),         no_argument,       NULL,    GETOPT_CRLF},
+		{_T("preallocate"),  required_argument, NULL, GETOPT_PREALLOCATE},
+		{_T("once"),         no_argument,       NULL,    GETOPT_ONCE},
+		{_T("queue-size"),   required_argument, NULL, GETOPT_QUEUE_SIZE},
+		{_T("raw-tee"),      required_argument, NULL, GETOPT_RAW_TEE},
+		{_T("reconnect"),    required_argument, NULL, GETOPT_RECONNECT},
+		{_T("replay"),       required_argument, NULL,  GETOPT_REPLAY},
+		{_T("rollup"),       required_argument, NULL,  GETOPT_ROLLUP},
+		{_T("rotate"),       required_argument, NULL,  GETOPT_ROTATE},
+		{_T("shm"),          required_argument, NULL,    GETOPT_SHM},
+		{_T("sink"),         required_argument, NULL,    GETOPT_SINK},
+		{_T("baud"),         required_argument, NULL,        _T('b')},
+		{_T("aggregate"),    no_argument,       NULL,        _T('a')},
 		{_T("format"),       required_argument, NULL,        _T('f')},
 		{_T("help"),         no_argument,       NULL,        _T('h')},
 		{_T("interval"),     required_argument, NULL,        _T('i')},
+		{_T("output"),       required_argument, NULL,        _T('o')},
+		{_T("protocol"),     required_argument, NULL,        _T('p')},
+		{_T("timeout"),      required_argument, NULL,        _T('t')},
 		{_T("utc"),          no_argument,       NULL,        _T('u')},
 		{_T("verbose"),      no_argument,       NULL,        _T('v')},
 		{NULL, 0, NULL, 0}
 	};
-	char * device = NULL;
 	uint8_t * inBuf = NULL;
-	tSerial * remoteConn = NULL;
+	tRing in;
+	tDevice * devices = NULL;
+	tOutput * outputs = NULL;
+	size_t deviceCount = 0;
+	size_t outputCount = 0;
+	size_t i;
 	tConfig config = {
 		DEFAULT_INTERVAL, /* update interval in seconds */
 		0, /* use local time */
-		DEFAULT_FORMAT /* format string */
+		DEFAULT_FORMAT, /* format string */
+		NULL, /* compiled format string */
+		NULL, /* standard output */
+		SF_LINE, /* flush each line */
+		0, /* flush policy parameter */
+		0, /* no maximum buffering time */
+		1, /* request binary protocol */
+		DEFAULT_BAUD, /* serial interface speed */
+		0, /* keep serial interface speed */
+		SFR_8N1, /* serial interface framing */
+		SFC_NONE, /* no flow control */
+		DEFAULT_READY_TIMEOUT, /* time to wait for the remote device */
+		0, /* aggregate on the host */
+		NULL, /* no raw capture */
+		0, /* intervals start with the first value */
+		OF_TEXT, /* formatted text output */
+		0, /* no size based rotation */
+		0, /* no time based rotation */
+		0, /* no preallocation */
+		NULL, /* no compression */
+		0 /* plain line feeds */
 	};
+	tConfig rollups[MAX_ROLLUPS];
+	size_t rollupCount = 0;
+	/* configuration changed by the output options (base or last rollup level) */
+	tConfig * level = &config;
+	tShm * shm = NULL;
 
 	/* ensure that the environment does not change the argument parser behavior */
 	putenv(POSIXLY_CORRECT);
@@ -175,11 +624,24 @@ int _tmain(int argc, TCHAR ** argv) {
 		return EXIT_FAILURE;
 	}
 
+	/* there can be no more devices and outputs than arguments */
+	devices = (tDevice *)calloc((size_t)argc, sizeof(tDevice));
+	outputs = (tOutput *)calloc((size_t)argc, sizeof(tOutput));
+	if (devices == NULL || outputs == NULL) {
+		_ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
+		goto onError;
+	}
+
 	while (1) {
-		const int res = getopt_long(argc, argv, _T(":f:hi:uv"), longOptions, NULL);
+		const int res = getopt_long(argc, argv, _T("-:ab:f:hi:o:p:t:uv"), longOptions, NULL);
 
 		if (res == -1) break;
 		switch (res) {
+		case GETOPT_DEVICE:
+			/* the options given so far apply to this device */
+			if (addDevice(devices, &deviceCount, optarg, &config, rollups, rollupCount) == 0) goto onError;
+			level = &config;
+			break;
 		case GETOPT_LICENSE:
 #ifdef UNICODE
 			{
@@ -195,9 +657,11 @@ int _tmain(int argc, TCHAR ** argv) {
 			_ftprintf(ferr, _T("%s"), licenseText);
 #endif /* UNICODE */
 			signalReceived++;
-			return EXIT_SUCCESS;
+			ret = EXIT_SUCCESS;
+			goto onError;
 			break;
 		case GETOPT_UTF8:
+			utf8Out = 1;
 #ifdef UNICODE
 			_setmode(_fileno(fout), _O_U8TEXT);
 			_setmode(_fileno(ferr), _O_U8TEXT);
@@ -206,15 +670,159 @@ int _tmain(int argc, TCHAR ** argv) {
 		case GETOPT_VERSION:
 			_ftprintf(fout, _T("%u.%u.%u"), PROGRAM_VERSION);
 			signalReceived++;
-			return EXIT_SUCCESS;
+			ret = EXIT_SUCCESS;
+			goto onError;
+			break;
+		case GETOPT_FLUSH:
+			if (parseFlush(level, optarg) == 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_FLUSH), optarg);
+				goto onError;
+			}
+			break;
+		case GETOPT_FRAMING:
+			if (parseFraming(optarg, &(config.framing)) == 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_FRAMING), optarg);
+				goto onError;
+			}
+			break;
+		case GETOPT_FLOW:
+			if (parseFlow(optarg, &(config.flow)) == 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_FLOW), optarg);
+				goto onError;
+			}
+			break;
+		case GETOPT_BAUD_SWITCH:
+			if (parseBaud(optarg, &(config.baudSwitch)) == 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_BAUD), optarg);
+				goto onError;
+			}
+			break;
+		case GETOPT_ONCE:
+			once = 1;
+			break;
+		case GETOPT_ALIGN:
+			config.align = 1;
+			break;
+		case GETOPT_OUT_FORMAT:
+			if (parseOutFormat(optarg, &(level->outFormat)) == 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_OUT_FORMAT), optarg);
+				goto onError;
+			}
+			break;
+		case GETOPT_QUEUE_SIZE:
+			{
+				const long value = _tcstol(optarg, &strNum, 10);
+				if (value < 0 || strNum == NULL || *strNum != 0) {
+					_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_QUEUE_SIZE), optarg);
+					goto onError;
+				}
+				queueSize = (size_t)value;
+			}
+			break;
+		case GETOPT_BACKPRESSURE:
+			if (parseBackpressure(optarg, &queuePolicy) == 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_BACKPRESSURE), optarg);
+				goto onError;
+			}
+			break;
+		case GETOPT_SINK:
+			if (sinkIsUrl(optarg) == 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_SINK), optarg);
+				goto onError;
+			}
+			level->output = optarg;
+			break;
+		case GETOPT_METRICS:
+			metricsPath = (_tcscmp(optarg, _T("-")) != 0) ? optarg : NULL;
+			break;
+		case GETOPT_SHM:
+			shmName = (_tcscmp(optarg, _T("-")) != 0) ? optarg : NULL;
+			break;
+		case GETOPT_ROTATE:
+			if (parseRotate(level, optarg) == 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_ROTATE), optarg);
+				goto onError;
+			}
+			break;
+		case GETOPT_PREALLOCATE:
+			if (parseSize(optarg, &strNum, &(level->prealloc)) == 0 || *strNum != 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_PREALLOC), optarg);
+				goto onError;
+			}
+			break;
+		case GETOPT_COMPRESS:
+			level->compress = (_tcscmp(optarg, _T("-")) != 0) ? optarg : NULL;
+			break;
+		case GETOPT_CRLF:
+			level->crlf = 1;
+			break;
+		case GETOPT_METRICS_INTERVAL:
+			metricsIntvl = (size_t)_tcstol(optarg, &strNum, 10);
+			if (metricsIntvl < 1 || strNum == NULL || *strNum != 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_INTERVAL), optarg);
+				goto onError;
+			}
+			break;
+		case GETOPT_RECONNECT:
+			{
+				const long value = _tcstol(optarg, &strNum, 10);
+				if (value < 0 || strNum == NULL || *strNum != 0) {
+					_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_TIMEOUT), optarg);
+					goto onError;
+				}
+				reconnectMax = (size_t)value;
+			}
+			break;
+		case GETOPT_RAW_TEE:
+			config.rawTee = (_tcscmp(optarg, _T("-")) != 0) ? optarg : NULL;
+			break;
+		case GETOPT_REPLAY:
+			/* the options given so far apply to this replayed device */
+			if (addDevice(devices, &deviceCount, optarg, &config, rollups, rollupCount) == 0) goto onError;
+			devices[deviceCount - 1].replayPath = optarg;
+			level = &config;
+			break;
+		case GETOPT_ROLLUP:
+			{
+				const long value = _tcstol(optarg, &strNum, 10);
+				if (value < 0 || strNum == NULL || *strNum != 0) {
+					_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_INTERVAL), optarg);
+					goto onError;
+				}
+				if (value == 0) {
+					/* remove all rollup levels */
+					rollupCount = 0;
+					level = &config;
+					break;
+				}
+				if (rollupCount >= MAX_ROLLUPS) {
+					_ftprintf(ferr, MSGT(MSGT_ERR_OPT_MANY_ROLLUPS), (unsigned)MAX_ROLLUPS);
+					goto onError;
+				}
+				/* the new level starts with the output options of the previous one */
+				memcpy(rollups + rollupCount, level, sizeof(*level));
+				level = rollups + rollupCount;
+				level->intvl = (size_t)value;
+				rollupCount++;
+			}
+			break;
+		case _T('a'):
+			config.aggregate = 1;
+			break;
+		case _T('b'):
+			if (parseBaud(optarg, &(config.baud)) == 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_BAUD), optarg);
+				goto onError;
+			}
 			break;
 		case _T('f'):
-			config.fmt = optarg;
+			level->fmt = optarg;
 			break;
 		case _T('h'):
 			printHelp();
 			signalReceived++;
-			return EXIT_SUCCESS;
+			ret = EXIT_SUCCESS;
+			goto onError;
 			break;
 		case _T('i'):
 			config.intvl = (size_t)_tcstol(optarg, &strNum, 10);
@@ -223,6 +831,29 @@ int _tmain(int argc, TCHAR ** argv) {
 				goto onError;
 			}
 			break;
+		case _T('o'):
+			level->output = (_tcscmp(optarg, _T("-")) != 0) ? optarg : NULL;
+			break;
+		case _T('p'):
+			if (_tcscmp(optarg, _T("ascii")) == 0) {
+				config.binary = 0;
+			} else if (_tcscmp(optarg, _T("binary")) == 0) {
+				config.binary = 1;
+			} else {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_PROTOCOL), optarg);
+				goto onError;
+			}
+			break;
+		case _T('t'):
+			{
+				const long value = _tcstol(optarg, &strNum, 10);
+				if (value < 0 || strNum == NULL || *strNum != 0) {
+					_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_TIMEOUT), optarg);
+					goto onError;
+				}
+				config.readyTimeout = (size_t)value;
+			}
+			break;
 		case _T('u'):
 			config.utc = 1;
 			break;
@@ -248,45 +879,177 @@ int _tmain(int argc, TCHAR ** argv) {
 		}
 	}
 
-	if (optind >= argc) {
+	/* all arguments after "--" are devices */
+	for (; optind < argc; optind++) {
+		if (addDevice(devices, &deviceCount, argv[optind], &config, rollups, rollupCount) == 0) goto onError;
+	}
+
+	if (deviceCount <= 0) {
 		_ftprintf(ferr, MSGT(MSGT_ERR_OPT_NO_DEVICE));
 		goto onError;
 	}
-	device = _ttoUtf8(argv[optind]);
-	if (device == NULL) {
-		_ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
+
+	/* compile output format strings and open output files */
+	for (i = 0; i < deviceCount; i++) {
+		tDevice * dev = devices + i;
+		if (dev->cfg.outFormat == OF_INFLUX && setInfluxFormat(dev->name, &(dev->cfg), &(dev->influxFmt)) == 0) goto onError;
+		if (compileFormat(&(dev->cfg)) == 0) goto onError;
+		dev->out = openOutput(outputs, &outputCount, &(dev->cfg));
+		if (dev->out == NULL) goto onError;
+		for (size_t j = 0; j < dev->rollupCount; j++) {
+			tRollup * rollup = dev->rollup + j;
+			if (rollup->cfg.outFormat == OF_INFLUX && setInfluxFormat(dev->name, &(rollup->cfg), &(rollup->influxFmt)) == 0) goto onError;
+			if (compileFormat(&(rollup->cfg)) == 0) goto onError;
+			rollup->out = openOutput(outputs, &outputCount, &(rollup->cfg));
+			if (rollup->out == NULL) goto onError;
+		}
+	}
+
+	/* create the shared memory segment with one slot per device and channel */
+	if (shmName != NULL) {
+		shm = shmCreate(shmName, deviceCount * PROTO_MAX_CHANNELS);
+		if (shm == NULL) {
+			_ftprintf(ferr, MSGT(MSGT_ERR_SHM_CREATE), shmName);
+			goto onError;
+		}
+		for (i = 0; i < deviceCount; i++) {
+			devices[i].shm = shmSlot(shm, i * PROTO_MAX_CHANNELS);
+			for (size_t j = 0; j < PROTO_MAX_CHANNELS; j++) shmInitSlot(devices[i].shm + j, devices[i].name, (unsigned int)j);
+		}
+	}
+
+	/* replayed raw captures are processed without serial devices */
+	for (i = 0; i < deviceCount && devices[i].replayPath != NULL; i++);
+	if (i >= deviceCount) {
+		for (i = 0; i < deviceCount; i++) {
+			devices[i].replay = capOpenReader(devices[i].replayPath);
+			if (devices[i].replay == NULL) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_CAP_OPEN), devices[i].replayPath);
+				goto onError;
+			}
+			initDevice(devices + i);
+		}
+		ret = processReplay(devices, deviceCount);
+		writeMetrics(devices, deviceCount);
 		goto onError;
 	}
 
+	/* open raw capture files for the received data */
+	for (i = 0; i < deviceCount; i++) {
+		const TCHAR * path = devices[i].cfg.rawTee;
+		if (devices[i].replayPath != NULL) {
+			_ftprintf(ferr, MSGT(MSGT_ERR_OPT_REPLAY_MIX));
+			goto onError;
+		}
+		if (path == NULL) continue;
+		for (size_t j = i + 1; j < deviceCount; j++) {
+			if (devices[j].cfg.rawTee != NULL && _tcscmp(devices[j].cfg.rawTee, path) == 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_TEE_SHARED), path);
+				goto onError;
+			}
+		}
+	}
+	for (i = 0; i < deviceCount; i++) {
+		const TCHAR * path = devices[i].cfg.rawTee;
+		if (path == NULL) continue;
+		devices[i].tee = capOpenWriter(path);
+		if (devices[i].tee == NULL) {
+			_ftprintf(ferr, MSGT(MSGT_ERR_CAP_OPEN), path);
+			goto onError;
+		}
+	}
+
 	/* allocate input buffer */
 	inBuf = malloc(INPUT_BUFFER_SIZE);
 	if (inBuf == NULL) {
 		_ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
 		goto onError;
 	}
+	ring_init(&in, inBuf, INPUT_BUFFER_SIZE);
 
 	/* install signal handlers */
+	wakeup = ser_createWakeup();
+	if (wakeup == NULL) {
+		_ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
+		goto onError;
+	}
 	signal(SIGINT, handleSignal);
 	signal(SIGTERM, handleSignal);
 
-	/* connect to remote device */
-	remoteConn = ser_create(device, 9600, SFR_8N1, SFC_NONE);
-	if (remoteConn == NULL) {
-		_ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_CONNECT), device);
-		goto onError;
+	/* connect to remote devices */
+	for (i = 0; i < deviceCount; i++) {
+		const tConfig * cfg = &(devices[i].cfg);
+		devices[i].ser = ser_create(devices[i].name, cfg->baud, cfg->framing, cfg->flow);
+		if (devices[i].ser == NULL) {
+			_ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_CONNECT), devices[i].name);
+			goto onError;
+		}
+	}
+
+	/* wait for remote devices to become ready */
+	for (i = 0; i < deviceCount; i++) {
+		ser_clear(devices[i].ser);
+		initDevice(devices + i);
+	}
+	if (waitReady(devices, deviceCount, &in) == 0) goto onError;
+	for (i = 0; i < deviceCount; i++) {
+		/* discard values received before the device was ready */
+		resetValues(devices + i);
 	}
 
-	/* wait for remote device to connect */
-	delay(1000);
-	ser_clear(remoteConn);
+	/* negotiate the serial interface speed and protocol */
+	for (i = 0; i < deviceCount && signalReceived == 0; i++) {
+		if (switchBaud(devices + i, &in) == 0) goto onError;
+		if (requestAggregation(devices + i, &in) == 0) goto onError;
+		/* devices without support for the binary protocol keep sending ASCII lines */
+		if (devices[i].cfg.binary != 0 && sendCommand(devices + i, PROTO_CMD_BINARY) == 0) goto onError;
+	}
 
 	/* read data and output results once per interval */
-	ret = processData(remoteConn, inBuf, INPUT_BUFFER_SIZE, &config);
+	ret = processData(devices, deviceCount, &in);
+	writeMetrics(devices, deviceCount);
 onError:
 	if (ret != EXIT_SUCCESS) signalReceived++;
-	if (remoteConn != NULL) ser_delete(remoteConn);
+	if (devices != NULL) {
+		for (i = 0; i < deviceCount; i++) {
+			if (devices[i].ser != NULL) ser_delete(devices[i].ser);
+			if (devices[i].replay != NULL) capCloseReader(devices[i].replay);
+			if (devices[i].tee != NULL) capCloseWriter(devices[i].tee);
+			if (devices[i].name != NULL) free(devices[i].name);
+			if (devices[i].cfg.prog != NULL) fmtDelete(devices[i].cfg.prog);
+			if (devices[i].influxFmt != NULL) free(devices[i].influxFmt);
+			if (devices[i].rollup != NULL) {
+				for (size_t j = 0; j < devices[i].rollupCount; j++) {
+					if (devices[i].rollup[j].cfg.prog != NULL) fmtDelete(devices[i].rollup[j].cfg.prog);
+					if (devices[i].rollup[j].influxFmt != NULL) free(devices[i].rollup[j].influxFmt);
+				}
+				free(devices[i].rollup);
+			}
+		}
+		free(devices);
+	}
+	if (outputs != NULL) {
+		for (i = 0; i < outputCount; i++) {
+			if (outputs[i].block != NULL) {
+				/* write the incomplete last block */
+				if (flushBlock(outputs + i, getTimeMs()) == 0 && verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_FMT_WRITE));
+				free(outputs[i].block);
+			}
+			if (outputs[i].sink != NULL) sinkClose(outputs[i].sink);
+			finishCompress(outputs + i);
+			if (outputs[i].name != NULL) fmtDelete(outputs[i].name);
+			if (outputs[i].file != NULL) free(outputs[i].file);
+		}
+		free(outputs);
+	}
+	if (shm != NULL) shmClose(shm);
 	if (inBuf != NULL) free(inBuf);
-	if (device != NULL) free(device);
+	if (wakeup != NULL) {
+		signal(SIGINT, SIG_DFL);
+		signal(SIGTERM, SIG_DFL);
+		ser_deleteWakeup(wakeup);
+		wakeup = NULL;
+	}
 	return ret;
 };
 
@@ -296,27 +1059,148 @@ onError:
  */
 static void printHelp(void) {
 	_ftprintf(ferr,
-	_T("thlog [options] <device>\n")
+	_T("thlog [options] <device> [[options] <device> ...]\n")
+	_T("thlog [options] --replay <file> [[options] --replay <file> ...]\n")
+	_T("\n")
+	_T("Options apply to all following devices.\n")
 	_T("\n")
+	_T("-a, --aggregate\n")
+	_T("      Lets the device aggregate the values over the update interval and send\n")
+	_T("      a single summary per interval. Needs the binary protocol.\n")
+	_T("    --align\n")
+	_T("      Aligns the intervals to the wall clock, e.g. an interval of 60 ends at\n")
+	_T("      each full minute. Uses UTC if selected, else local time.\n")
+	_T("    --backpressure <policy>\n")
+	_T("      Defines what happens if the output cannot keep up with the received\n")
+	_T("      samples and the queue is full. Possible policies are:\n")
+	_T("      drop  - drop the oldest queued sample\n")
+	_T("      block - wait until the output made room (default)\n")
+	_T("      spill - queue the samples in a temporary file\n")
+	_T("-b, --baud <number>\n")
+	_T("      Serial interface speed in baud. Default: %u\n")
+	_T("    --baud-switch <number>\n")
+	_T("      Requests the device to switch to the given speed after connecting.\n")
+	_T("      The initial speed is kept if the device does not acknowledge it.\n")
+	_T("    --compress <command>\n")
+	_T("      Runs the given command with the path of each rotated output file as last\n")
+	_T("      argument in the background, e.g. gzip. Default: - (disabled)\n")
+	_T("    --crlf\n")
+	_T("      Writes line feeds of the text output as CR/LF, e.g. for old text editors\n")
+	_T("      on Windows. Network sinks always use plain line feeds.\n")
+	_T("    --flow <none|sw|hw>\n")
+	_T("      Serial interface flow control. Default: none\n")
 	_T("-f, --format <string>\n")
 	_T("      Defines the output format string. The allows the same as strftime in C\n")
 	_T("      and the following:\n")
+	_T("      %%vA - absolute humidity in g/m^3\n")
 	_T("      %%vC - temperature in degrees Celsius\n")
+	_T("      %%vD - dew point in degrees Celsius\n")
 	_T("      %%vF - temperature in degrees Fahrenheit\n")
 	_T("      %%vH - relative humidity in percent\n")
+	_T("      %%vI - sensor channel number of the device (0 for the first sensor)\n")
+	_T("      %%vN - number of samples\n")
+	_T("      %%vX - heat index (apparent temperature) in degrees Celsius\n")
+	_T("      %%f  - fractional seconds; %%1f to %%3f select the digits (default: 3)\n")
+	_T("      The suffixes min, max, sd and med output the minimum, maximum, standard\n")
+	_T("      deviation and approximated median instead of the mean (e.g. %%vCmax).\n")
+	_T("      %%vA, %%vD and %%vX are derived from the mean values of the interval.\n")
 	_T("      The format modifiers of printf's %%f can be applied here.\n")
+	_T("      %%vI and %%vN default to a precision of 0.\n")
 	_T("      The default is \"%s\"\n")
+	_T("    --flush <policy>\n")
+	_T("      Defines when buffered output is written. Possible policies are:\n")
+	_T("      line       - after each line (default)\n")
+	_T("      interval:N - at most N seconds after a line got buffered\n")
+	_T("      bytes:N    - once at least N bytes are buffered\n")
+	_T("      records:N[,T] - once N records are buffered or the oldest is T ms old\n")
+	_T("      UDP sinks send each flush as datagrams of whole records up to 1400 bytes.\n")
+	_T("      Outputs are always flushed on exit.\n")
+	_T("    --framing <type>\n")
+	_T("      Serial interface framing as data bits, parity (N, E, O) and stop bits.\n")
+	_T("      Possible values are 7N1, 8N1, 7N2, 8N2, 7E1, 8E1, 7E2, 8E2, 7O1, 8O1,\n")
+	_T("      7O2 and 8O2. Default: 8N1\n")
 	_T("-h, --help\n")
 	_T("      Print short usage instruction.\n")
 	_T("-i, --interval <number>\n")
 	_T("      Update interval in seconds. Default: %u\n")
 	_T("    --license\n")
 	_T("      Displays the licenses for this program.\n")
+	_T("    --metrics <file>\n")
+	_T("      Writes counters of the input processing and output in the Prometheus\n")
+	_T("      text format to the given file, e.g. for the node exporter textfile\n")
+	_T("      collector. The file is replaced atomically. Default: - (disabled)\n")
+	_T("    --metrics-interval <number>\n")
+	_T("      Time between two metrics file updates in seconds. Default: %u\n")
+	_T("    --once\n")
+	_T("      Outputs the first valid sample of each device and exits.\n")
+	_T("-o, --output <file>\n")
+	_T("      Appends the output to the given file. Devices with the same output file\n")
+	_T("      share it. Default: - (standard output)\n")
+	_T("    --output-format <format>\n")
+	_T("      Output file format. Possible values are:\n")
+	_T("      text     - formatted according to --format (default)\n")
+	_T("      binary   - fixed-width records with time, mean values, count and flags\n")
+	_T("      columnar - blocks of 256 records stored column-wise with min/max values\n")
+	_T("      influx   - InfluxDB line protocol with device path and channel as tags\n")
+	_T("      The binary formats need an output file or network sink. See src/record.h\n")
+	_T("      for details. Binary records sent to network sinks have no file header.\n")
 #ifdef UNICODE
 	_T("    --utf8\n")
-	_T("      Sets the encoding for error console to UTF-8.\n")
+	_T("      Sets the encoding for standard output and error console to UTF-8.\n")
 	_T("      The default is UTF-16.\n")
 #endif /* UNICODE */
+	_T("    --preallocate <number>\n")
+	_T("      Preallocates disk space of the given size in bytes for each output file\n")
+	_T("      to reduce fragmentation, e.g. on SD cards. The suffixes k, M and G stand\n")
+	_T("      for KiB, MiB and GiB. Unused space is released on rotation and exit.\n")
+	_T("-p, --protocol <ascii|binary>\n")
+	_T("      Selects the protocol requested from the device. The binary protocol\n")
+	_T("      falls back to ASCII if the device does not support it. Default: binary\n")
+	_T("    --queue-size <number>\n")
+	_T("      Number of samples queued between reading and output. Reading and output\n")
+	_T("      run on a single thread if set to 0. Default: %u\n")
+	_T("    --raw-tee <file>\n")
+	_T("      Records the data received from the device with its reception time to\n")
+	_T("      the given raw capture file. Each device needs its own file.\n")
+	_T("    --reconnect <number>\n")
+	_T("      Maximum time in seconds between two attempts to reconnect to a lost\n")
+	_T("      device. The delay starts at %u ms and doubles with each attempt. A new\n")
+	_T("      serial device triggers an attempt at once. The intervals and outputs\n")
+	_T("      are kept meanwhile. Exits on connection loss if 0. Default: %u\n")
+	_T("    --replay <file>\n")
+	_T("      Processes the given raw capture file as fast as possible instead of a\n")
+	_T("      device. The recorded reception time replaces the current time. The last\n")
+	_T("      interval is output even if incomplete.\n")
+	_T("    --rollup <number>\n")
+	_T("      Adds an output level with the given interval in seconds which is merged\n")
+	_T("      from the intervals of the previous level. The interval needs to be a\n")
+	_T("      multiple of the previous one. The following -f, -o, --compress, --crlf,\n")
+	_T("      --flush, --output-format, --preallocate, --rotate and --sink options\n")
+	_T("      apply to this level until the next device. At most %u levels are\n")
+	_T("      supported. The value 0 removes all levels.\n")
+	_T("    --rotate <policy>\n")
+	_T("      Starts a new output file once due. Possible policies are:\n")
+	_T("      none       - keep a single output file (default)\n")
+	_T("      size:N     - before a record once the file has N bytes (suffix k, M, G)\n")
+	_T("      interval:N - before the first record after each N seconds boundary\n")
+	_T("      Both can be combined with a comma. The time format codes of --format\n")
+	_T("      are replaced in the output file path at the start of each file, e.g.\n")
+	_T("      room-%%Y%%m%%d.txt. Backslashes are kept as path separators, e.g.\n")
+	_T("      C:\\logs\\new\\room-%%Y%%m%%d.txt. A number is inserted before the\n")
+	_T("      extension if the file or its compressed copy exists already.\n")
+	_T("    --shm <name>\n")
+	_T("      Publishes the latest sample and the current interval statistics of each\n")
+	_T("      device and sensor channel in the given shared memory segment, e.g.\n")
+	_T("      /thlog or Local\\thlog on Windows. Readers access it lock-free (see\n")
+	_T("      src/shm.h for the layout). Default: - (disabled)\n")
+	_T("    --sink <url>\n")
+	_T("      Sends the output to the given network collector instead of a file.\n")
+	_T("      Possible URLs are udp://host:port and tcp://host:port. TCP reconnects\n")
+	_T("      in the background while records are buffered. Devices with the same\n")
+	_T("      sink share it.\n")
+	_T("-t, --timeout <number>\n")
+	_T("      Time in milliseconds to wait for the device to signal readiness after\n")
+	_T("      connecting. Default: %u\n")
 	_T("-u\n")
 	_T("      Display time in UTC instead of local time.\n")
 	_T("-v\n")
@@ -326,8 +1210,15 @@ static void printHelp(void) {
 	_T("\n")
 	_T("thlog %u.%u.%u\n")
 	_T("https://github.com/daniel-starke/thlog\n")
+	, (unsigned)DEFAULT_BAUD
 	, DEFAULT_FORMAT
 	, DEFAULT_INTERVAL
+	, (unsigned)DEFAULT_METRICS_INTERVAL
+	, (unsigned)DEFAULT_QUEUE_SIZE
+	, (unsigned)RECONNECT_DELAY
+	, (unsigned)DEFAULT_RECONNECT_MAX
+	, (unsigned)MAX_ROLLUPS
+	, (unsigned)DEFAULT_READY_TIMEOUT
 	, PROGRAM_VERSION);
 }
 
@@ -341,309 +1232,2136 @@ static void handleSignal(int signum) {
 	PCF_UNUSED(signum)
 	if (signalReceived == 0 && verbose > 2) _ftprintf(ferr, MSGT(MSGT_INFO_SIGTERM));
 	signalReceived++;
+	queueAbort(sampleQueue);
+	ser_wakeup(wakeup);
 }
 
 
 /**
- * Processes the data from the serial device connected via ser. This function outputs the received
- * data with the format string provided on fout.
+ * Adds a new device with the given path and configuration to the passed device list.
+ * Errors are reported on ferr.
  *
- * @param[in,out] ser - serial device handle
- * @param[in,out] inBuf - input buffer to use
- * @param[in] inBufSize - size of inBuf in bytes
- * @param[in] cfg - data processing configuration
- * @return program exit code
- * @remarks Possible error codes are defined in arduino/DHT11.hpp and arduino/DHT22.hpp.
+ * @param[in,out] devs - device list
+ * @param[in,out] count - number of devices in devs
+ * @param[in] path - device path
+ * @param[in] cfg - data processing configuration for this device
+ * @param[in] rollups - output options of the rollup levels from fine to coarse
+ * @param[in] rollupCount - number of levels in rollups
+ * @return 1 on success, else 0
  */
-static int processData(tSerial * ser, uint8_t * inBuf, const size_t inBufSize, const tConfig * cfg) {
-	if (signalReceived == 0 && (ser == NULL || inBuf == NULL || inBufSize == 0 || cfg == NULL)) return EXIT_FAILURE;
-	enum {
-		ST_TEMP,
-		ST_RH,
-		ST_SUM
-	} pState;
-	float temp, rh, sum;
-	float tempSum, rhSum;
-	size_t valueCount;
-	tPFloatCtx pFloat;
-	tPErrCtx pErr;
-	time_t intvlStart, now;
-
-	pState = ST_TEMP;
-	temp = 0.0f;
-	rh = 0.0f;
-	tempSum = 0.0f;
-	rhSum = 0.0f;
-	valueCount = 0;
-	memset(&pFloat, 0, sizeof(pFloat));
-	memset(&pErr, 0, sizeof(pErr));
-	time(&intvlStart);
-
-	while (signalReceived == 0) {
-		errno = 0;
-		const ssize_t res = ser_read(ser, inBuf, inBufSize, TIMEOUT_RESOLUTION);
-		if (res == -1) {
-			if (verbose > 0 && errno != EINTR) _ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_READ));
-			signalReceived++;
-			return EXIT_FAILURE;
-		}
-		for (ssize_t i = 0; i < res; i++) {
-			const int c = (int)(inBuf[i]);
-			/* check if an error was returned */
-			parseErr(&pErr, c);
-			switch (pErr.state) {
-			case PES_STOP:
-				if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_VALUE), pErr.result);
-				/* fall-through */
-			case PES_ERROR_TOKEN:
-			case PES_ERROR_OVERFLOW:
-				memset(&pErr, 0, sizeof(pErr));
-				break;
-			default:
-				break;
-			}
-			/* check if a value was parsed */
-			int pOk = parseFloat(&pFloat, c);
-			switch (pFloat.state) {
-			case PFS_STOP:
-				switch (pState) {
-				case ST_TEMP:
-					temp = pFloat.result;
-					pState = ST_RH;
-					break;
-				case ST_RH:
-					rh = pFloat.result;
-					pState = ST_SUM;
-					break;
-				case ST_SUM:
-					sum = pFloat.result;
-					pState = ST_TEMP;
-					if (fabsf(temp + rh - sum) > 0.001f) {
-						if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_CHECKSUM));
-						break;
-					}
-					tempSum += temp;
-					rhSum += rh;
-					valueCount++;
-					break;
-				}
-				pOk = 1;
-				memset(&pFloat, 0, sizeof(pFloat));
-				memset(&pErr, 0, sizeof(pErr));
-				break;
-			case PFS_ERROR_TOKEN:
-			case PFS_ERROR_OVERFLOW:
-				pOk = 0; /* re-initialize value parser */
-				break;
-			default:
-				break;
-			}
-			/* re-initialize value parser */
-			if (pOk == 0) {
-				memset(&pFloat, 0, sizeof(pFloat));
-				pState = ST_TEMP;
-			}
-			/* re-initialize all parsers on line end */
-			if (c == '\r' || c == '\n') {
-				memset(&pFloat, 0, sizeof(pFloat));
-				memset(&pErr, 0, sizeof(pErr));
-				pState = ST_TEMP;
-			}
-		}
-		/* check update interval */
-		time(&now);
-		if (valueCount == 0) {
-			intvlStart = now;
-			continue;
-		}
-		if (difftime(now, intvlStart) >= (double)(cfg->intvl)) {
-			/* output values */
-			struct tm * timeInfo = (cfg->utc != 0) ? gmtime(&now) : localtime(&now);
-			if (printData(fout, cfg->fmt, timeInfo, tempSum / (float)valueCount, rhSum / (float)valueCount) < 0) {
-				if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_FMT_WRITE));
-				return EXIT_FAILURE;
-			}
-			fflush(fout);
-			/* reset values for next interval */
-			tempSum = 0.0f;
-			rhSum = 0.0f;
-			valueCount = 0;
-			intvlStart = now;
+static int addDevice(tDevice * devs, size_t * count, const TCHAR * path, const tConfig * cfg, const tConfig * rollups, const size_t rollupCount) {
+	if (devs == NULL || count == NULL || path == NULL || cfg == NULL || (rollups == NULL && rollupCount > 0)) return 0;
+	if (*count >= SER_WAIT_MAX) {
+		_ftprintf(ferr, MSGT(MSGT_ERR_OPT_MANY_DEVICES), (unsigned)SER_WAIT_MAX);
+		return 0;
+	}
+	tDevice * dev = devs + *count;
+	memset(dev, 0, sizeof(*dev));
+	dev->name = _ttoUtf8(path);
+	if (dev->name == NULL) {
+		_ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
+		return 0;
+	}
+	memcpy(&(dev->cfg), cfg, sizeof(*cfg));
+	dev->cfg.prog = NULL;
+	dev->met.name = dev->name;
+	*count = *count + 1;
+	if (rollupCount == 0) return 1;
+	dev->rollup = (tRollup *)calloc(rollupCount, sizeof(tRollup));
+	if (dev->rollup == NULL) {
+		_ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
+		return 0;
+	}
+	dev->rollupCount = rollupCount;
+	size_t prev = cfg->intvl;
+	for (size_t i = 0; i < rollupCount; i++) {
+		const tConfig * level = rollups + i;
+		if (level->intvl <= prev || (level->intvl % prev) != 0) {
+			_ftprintf(ferr, MSGT(MSGT_ERR_OPT_BAD_ROLLUP), (unsigned)(level->intvl), (unsigned)prev);
+			return 0;
 		}
+		prev = level->intvl;
+		/* only the interval and output options differ from the device configuration */
+		tConfig * rollupCfg = &(dev->rollup[i].cfg);
+		memcpy(rollupCfg, cfg, sizeof(*cfg));
+		rollupCfg->intvl = level->intvl;
+		rollupCfg->fmt = level->fmt;
+		rollupCfg->prog = NULL;
+		rollupCfg->output = level->output;
+		rollupCfg->flush = level->flush;
+		rollupCfg->flushParam = level->flushParam;
+		rollupCfg->flushLinger = level->flushLinger;
+		rollupCfg->outFormat = level->outFormat;
+		rollupCfg->rotateSize = level->rotateSize;
+		rollupCfg->rotateIntvl = level->rotateIntvl;
+		rollupCfg->prealloc = level->prealloc;
+		rollupCfg->compress = level->compress;
 	}
-	return EXIT_SUCCESS;
+	return 1;
 }
 
 
 /**
- * Outputs the given sensor data.
+ * Parses the given flush policy string into the passed configuration.
  *
- * @param[in,out] fd - file descriptor to write to
- * @param[in] fmt - format string
- * @param[in] timeInfo - time reference
- * @param[in] temp - temperature value in degrees Celsius
- * @param[in] rh - relative humidity in percent
- * @return number of bytes written or -1 on error
- * @remarks see strftime() for valid time related format codes
+ * @param[in,out] cfg - data processing configuration
+ * @param[in] str - flush policy string (line, interval:N, bytes:N or records:N[,T])
+ * @return 1 on success, else 0
  */
-static int printData(FILE * fd, const TCHAR * fmt, const struct tm * timeInfo, const float temp, const float rh) {
-	static const TCHAR * stateStr[] = {
-		_T("START"),
-		_T("STOP"),
-		_T("ERROR_TOKEN"),
-		_T("ERROR_OVERFLOW"),
-		_T("FLAG"),
-		_T("WIDTH"),
-		_T("PRECISION_START"),
-		_T("PRECISION"),
-		_T("TYPE"),
-		_T("SUBTYPE")
+static int parseFlush(tConfig * cfg, const TCHAR * str) {
+	static const struct {
+		const TCHAR * name;
+		tSinkFlush flush;
+	} policies[] = {
+		{_T("interval:"), SF_INTERVAL},
+		{_T("bytes:"),    SF_BYTES},
+		{_T("records:"),  SF_RECORDS}
 	};
-	if (fd == NULL || fmt == NULL || timeInfo == NULL) return -1;
-	int written, res;
-	TCHAR tFmt[4];
-	TCHAR buf[64];
-	const TCHAR * start, * ptr;
-	int last, esc;
-	tPFmtCtx pFmt;
-
-	res = 0;
-	start = fmt;
-	last = 0;
-	esc = 0;
-	memset(&pFmt, 0, sizeof(pFmt));
-
-	for (ptr = fmt; *ptr != 0; ptr++) {
-		const int c = *ptr;
-		if (verbose > 3) _ftprintf(ferr, _T("CHAR:%i '%c', STATE:%s, ESC:%i\n"), c, c, stateStr[pFmt.state], esc);
-		/* process character escape codes */
-		if (esc != 0) {
-			last = c;
-			esc = 0;
-			switch (c) {
-			case '\\': esc = '\\'; break;
-			case 'a': esc = 0x07; break;
-			case 'b': esc = 0x08; break;
-			case 'e': esc = 0x1B; break;
-			case 'f': esc = 0x0C; break;
-			case 'n': esc = 0x0A; break;
-			case 'r': esc = 0x0D; break;
-			case 't': esc = 0x09; break;
-			default: break;
-			}
-			if (esc != 0) {
-				written = _ftprintf(fd, _T("%c"), esc);
-				if (written < 0) return -1;
-				res += written;
-				start = ptr + 1;
-				esc = 0;
-				continue;
-			}
+	TCHAR * strNum;
+	if (cfg == NULL || str == NULL) return 0;
+	if (_tcscmp(str, _T("line")) == 0) {
+		cfg->flush = SF_LINE;
+		cfg->flushParam = 0;
+		cfg->flushLinger = 0;
+		return 1;
+	}
+	for (size_t i = 0; i < (sizeof(policies) / sizeof(*policies)); i++) {
+		const size_t len = _tcslen(policies[i].name);
+		if (_tcsncmp(str, policies[i].name, len) != 0) continue;
+		const long value = _tcstol(str + len, &strNum, 10);
+		if (value < 1 || strNum == NULL) return 0;
+		long linger = 0;
+		if (policies[i].flush == SF_RECORDS && *strNum == _T(',')) {
+			/* optional maximum time in milliseconds a record is buffered */
+			linger = _tcstol(strNum + 1, &strNum, 10);
+			if (linger < 1 || strNum == NULL) return 0;
 		}
-		/* process codes and literals */
-		if (pFmt.state == PFMTS_START) {
-			if (c == '%') {
-				/* format code start */
-				if (start != ptr) {
-					/* print string literal (i.e. string part without any format codes) */
-					written = _ftprintf(fd, _T("%.*s"), (int)(ptr - start), start);
-					if (written < 0) return -1;
-					res += written;
-					start = ptr;
-				}
-			} else if (c == '\\' && esc == 0) {
-				/* escape code start */
-				if (start != ptr) {
-					/* print string literal (i.e. string part without any format codes) */
-					written = _ftprintf(fd, _T("%.*s"), (int)(ptr - start), start);
-					if (written < 0) return -1;
-					res += written;
-					start = ptr;
-				}
-				esc = 1;
-				continue;
+		if (*strNum != 0) return 0;
+		cfg->flush = policies[i].flush;
+		cfg->flushParam = (size_t)value;
+		cfg->flushLinger = (size_t)linger;
+		return 1;
+	}
+	return 0;
+}
+
+
+/**
+ * Parses the given file rotation policy string into the passed configuration.
+ *
+ * @param[in,out] cfg - data processing configuration
+ * @param[in] str - rotation policy string (none or a comma separated list of size:N and interval:N)
+ * @return 1 on success, else 0
+ */
+static int parseRotate(tConfig * cfg, const TCHAR * str) {
+	TCHAR * strNum;
+	uint64_t size = 0;
+	size_t intvl = 0;
+	if (cfg == NULL || str == NULL || *str == 0) return 0;
+	if (_tcscmp(str, _T("none")) != 0) {
+		while (*str != 0) {
+			if (_tcsncmp(str, _T("size:"), 5) == 0) {
+				if (parseSize(str + 5, &strNum, &size) == 0 || size < 1) return 0;
+			} else if (_tcsncmp(str, _T("interval:"), 9) == 0) {
+				const long value = _tcstol(str + 9, &strNum, 10);
+				if (value < 1 || strNum == NULL) return 0;
+				intvl = (size_t)value;
 			} else {
-				/* string literal part */
-				last = c;
-				continue;
+				return 0;
 			}
-		}
-		/* process format codes */
-		if (parseFmt(&pFmt, c) != 1 && pFmt.state != PFMTS_STOP) {
-			/* invalid format code syntax */
-			if (verbose > 0) {
-				if (pFmt.state == PFMTS_ERROR_OVERFLOW) {
-					_ftprintf(ferr, MSGT(MSGT_ERR_FMT_OVERFLOW), (int)(ptr + 1 - fmt), fmt, ptr + 1);
-				} else {
-					_ftprintf(ferr, MSGT(MSGT_ERR_FMT_SYNTAX), (int)(ptr + 1 - fmt), fmt, ptr + 1);
-				}
+			if (*strNum == _T(',') && strNum[1] != 0) {
+				strNum++;
+			} else if (*strNum != 0) {
+				return 0;
 			}
-			return -1;
-		} else if (pFmt.state == PFMTS_STOP) {
-			if (pFmt.type == 'v') {
-				/* sensor value */
-				if ((sizeof(TCHAR) * (size_t)(ptr - fmt)) >= sizeof(buf)) {
-					if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_FMT_LENGTH), (int)(ptr + 1 - fmt), fmt, ptr + 1);
-					return -1;
-				}
-				memcpy(buf, start, sizeof(TCHAR) * (size_t)(ptr - start - 1));
-				buf[(size_t)(ptr - start - 1)] = 'f';
-				buf[(size_t)(ptr - start)] = 0;
-				switch (pFmt.subType) {
-				case 'C': written = _ftprintf(fd, buf, temp); break;
-				case 'F': written = _ftprintf(fd, buf, (temp * 1.8f) + 32.0f); break;
-				case 'H': written = _ftprintf(fd, buf, rh); break;
-				default:
-					if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_FMT_SYNTAX), (int)(ptr + 1 - fmt), fmt, ptr + 1);
-					return -1;
-				}
-			} else if (pFmt.type == '%' && last == '%') {
-				/* escaped % */
-				written = _ftprintf(fd, _T("%c"), '%');
-			} else if (last == '%' || last == '#') {
-				/* time value */
-				memcpy(tFmt, start, sizeof(TCHAR) * (size_t)(ptr + 1 - start));
-				tFmt[ptr + 1 - start] = 0;
-				written = (int)_tcsftime(buf, sizeof(buf) / sizeof(*buf), tFmt, timeInfo);
-				if (written <= 0) {
-					/* error reported by API */
-					if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_FMT_SYNTAX), (int)(ptr + 1 - fmt), fmt, ptr + 1);
-					return -1;
-				}
-				written = _ftprintf(fd, _T("%.*s"), written, buf);
-			} else {
-				/* invalid format code syntax */
-				if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_FMT_SYNTAX), (int)(ptr + 1 - fmt), fmt, ptr + 1);
-				return -1;
+			str = strNum;
+		}
+	}
+	cfg->rotateSize = size;
+	cfg->rotateIntvl = intvl;
+	return 1;
+}
+
+
+/**
+ * Parses the given number of bytes with an optional suffix. The suffixes k, M and G multiply the
+ * number by 1024, 1024^2 and 1024^3.
+ *
+ * @param[in] str - string to parse
+ * @param[out] end - set to the first character after the parsed number and suffix
+ * @param[out] size - set to the number of bytes
+ * @return 1 on success, else 0
+ */
+static int parseSize(const TCHAR * str, TCHAR ** end, uint64_t * size) {
+	if (str == NULL || end == NULL || size == NULL) return 0;
+	const long value = _tcstol(str, end, 10);
+	if (value < 0 || *end == NULL || *end == str) return 0;
+	unsigned int shift = 0;
+	switch (**end) {
+	case _T('k'):
+		shift = 10;
+		break;
+	case _T('M'):
+		shift = 20;
+		break;
+	case _T('G'):
+		shift = 30;
+		break;
+	default:
+		break;
+	}
+	if (shift > 0) *end = *end + 1;
+	*size = (uint64_t)value << shift;
+	return 1;
+}
+
+
+/**
+ * Returns the output for the given configuration. The output file is opened if it is not already
+ * in the passed output list. Devices sharing an output use the flush and rotation policy of the
+ * first device. The output file path of rotated outputs is formatted like the output format
+ * string, e.g. with the current date. New files with a binary output file format start with its
+ * file header. Errors are reported on ferr.
+ *
+ * @param[in,out] outs - output file list
+ * @param[in,out] count - number of output files in outs
+ * @param[in] cfg - data processing configuration with the output file path
+ * @return output file or NULL on error
+ */
+static tOutput * openOutput(tOutput * outs, size_t * count, const tConfig * cfg) {
+	if (outs == NULL || count == NULL || cfg == NULL) return NULL;
+	const TCHAR * path = cfg->output;
+	for (size_t i = 0; i < *count; i++) {
+		if (outs[i].path == path || (outs[i].path != NULL && path != NULL && _tcscmp(outs[i].path, path) == 0)) {
+			if (outs[i].format != cfg->outFormat) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_OPT_OUT_FORMAT_MIX), (path != NULL) ? path : _T("-"));
+				return NULL;
 			}
-			if (written < 0) return -1;
-			res += written;
-			start = ptr + 1;
-			memset(&pFmt, 0, sizeof(pFmt));
+			return outs + i;
 		}
-		last = c;
 	}
-	if (start != ptr) {
-		/* print string literal (i.e. string part without any format codes) */
-		written = _ftprintf(fd, _T("%.*s"), (int)(ptr - start), start);
-		if (written < 0) return -1;
-		res += written;
+	if (path == NULL && (cfg->outFormat == OF_BINARY || cfg->outFormat == OF_COLUMNAR)) {
+		_ftprintf(ferr, MSGT(MSGT_ERR_OPT_OUT_FORMAT_STDOUT));
+		return NULL;
 	}
-	return res;
+	if ((cfg->rotateSize > 0 || cfg->rotateIntvl > 0) && (path == NULL || sinkIsUrl(path) != 0)) {
+		_ftprintf(ferr, MSGT(MSGT_ERR_OPT_ROTATE_FILE));
+		return NULL;
+	}
+	const int64_t now = getTimeMs();
+	tOutput * out = outs + *count;
+	/* the output is released on exit from here on */
+	*count = *count + 1;
+	out->path = path;
+	out->format = cfg->outFormat;
+	out->block = NULL;
+	out->rotateSize = cfg->rotateSize;
+	out->rotateIntvl = cfg->rotateIntvl;
+	out->utc = cfg->utc;
+	out->prealloc = cfg->prealloc;
+	out->compress = cfg->compress;
+	if (cfg->rotateSize > 0 || cfg->rotateIntvl > 0) {
+		out->name = compileFormatString(path, FMTM_PATH);
+		if (out->name == NULL) return NULL;
+		/* continue an existing uncompressed file after a restart */
+		out->file = getOutputFile(out, now, 0);
+		if (out->file == NULL) {
+			_ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
+			return NULL;
+		}
+		out->rotateAt = getRotateTime(out, now);
+	}
+	const TCHAR * file = (out->file != NULL) ? out->file : path;
+	/* output files are always UTF-8 encoded */
+	out->sink = sinkOpen(file, (file != NULL) ? 1 : utf8Out, cfg->crlf, cfg->flush, cfg->flushParam, cfg->flushLinger);
+	if (out->sink == NULL) {
+		if (sinkIsUrl(file) != 0) {
+			_ftprintf(ferr, MSGT(MSGT_ERR_SINK_OPEN), file);
+		} else if (file != NULL) {
+			_ftprintf(ferr, MSGT(MSGT_ERR_FILE_OPEN), file);
+		} else {
+			_ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
+		}
+		return NULL;
+	}
+	preallocOutput(out);
+	if (writeHeader(out, now) == 0) {
+		_ftprintf(ferr, MSGT(MSGT_ERR_FILE_OPEN), file);
+		return NULL;
+	}
+	if (out->format == OF_COLUMNAR) {
+		out->block = (tRecBlock *)calloc(1, sizeof(tRecBlock));
+		if (out->block == NULL) {
+			_ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
+			return NULL;
+		}
+	}
+	return out;
 }
 
 
 /**
- * The function lets the current thread sleep for the number
- * of milliseconds passed to it.
+ * Writes the file header of the binary output file formats if the output file of the given
+ * output is empty.
  *
- * @param[in] duration - time duration to sleep
+ * @param[in,out] out - output file
+ * @param[in] now - current time in milliseconds since the epoch for the flush policy
+ * @return 1 on success, else 0
  */
-static void delay(const unsigned long duration) {
-	if (duration == 0) return;
-#if defined(PCF_IS_WIN)
-	Sleep((DWORD)duration);
-#elif defined(PCF_IS_LINUX)
-	usleep((useconds_t)duration * 1000);
-#endif
+static int writeHeader(tOutput * out, const int64_t now) {
+	if (out == NULL || out->sink == NULL) return 0;
+	if (out->format == OF_TEXT || out->format == OF_INFLUX) return 1;
+	int empty = sinkIsEmpty(out->sink);
+	if (empty > 0) {
+		uint8_t header[REC_HEADER_SIZE];
+		recHeader(header, (out->format == OF_COLUMNAR) ? RF_COLUMNAR : RF_BINARY);
+		if (sinkWriteRaw(out->sink, header, sizeof(header), now) == 0) empty = -1;
+	}
+	return (empty < 0) ? 0 : 1;
+}
+
+
+/**
+ * Preallocates the configured disk space for the current output file of the given output. A
+ * failure is only reported as warning because the output works without it.
+ *
+ * @param[in,out] out - output file
+ */
+static void preallocOutput(tOutput * out) {
+	if (out == NULL || out->prealloc == 0 || out->path == NULL || sinkIsUrl(out->path) != 0) return;
+	if (sinkPreallocate(out->sink, out->prealloc) == 0 && verbose > 1) {
+		_ftprintf(ferr, MSGT(MSGT_WARN_PREALLOC), (out->file != NULL) ? out->file : out->path);
+	}
+}
+
+
+/**
+ * Returns the output file path of the given rotated output for the passed time. The path
+ * pattern is formatted like the output format string. A unique path gets a sequence number
+ * inserted before the file extension if the formatted path or a compressed copy of it exists
+ * already (e.g. log.1.txt). The sequence number only increases until the formatted path changes.
+ * This keeps a compressed file from being replaced by a new one with the same path and the names
+ * independent of whether the compression of the previous file finished.
+ *
+ * @param[in,out] out - rotated output file
+ * @param[in] wall - current wall clock time in milliseconds since the epoch
+ * @param[in] unique - non-zero to return a path of a file which does not exist yet, zero to allow
+ * an existing uncompressed file
+ * @return output file path which needs to be freed or NULL if out of memory
+ */
+static TCHAR * getOutputFile(tOutput * out, const int64_t wall, const int unique) {
+	static const tStats empty = {0};
+	if (out == NULL || out->name == NULL) return NULL;
+	const int res = fmtRun(out->name, wall, out->utc, 0, &empty, &empty);
+	if (res < 0) return NULL;
+	/* the format program outputs UTF-8 */
+	TCHAR * name = _tfromUtf8(out->name->out);
+	if (name == NULL) return NULL;
+	const size_t len = _tcslen(name);
+	/* room for a dot, the sequence number and a compression extension */
+	const size_t size = len + 22 + COMPRESS_EXT_MAX;
+	TCHAR * file = (TCHAR *)malloc(size * sizeof(TCHAR));
+	if (file == NULL) goto onError;
+	memcpy(file, name, len * sizeof(TCHAR));
+	file[len] = 0;
+	if (unique == 0 && fileExists(file) != 0) goto onError;
+	if (outputFileExists(file, len) == 0) {
+		out->seq = 0;
+		goto onError;
+	}
+	/* the extension starts at the last dot of the file name unless it is its first character */
+	size_t ext = len;
+	for (size_t i = len; i > 1; i--) {
+		const TCHAR c = name[i - 1];
+#if defined(PCF_IS_WIN)
+		if (c == '/' || c == '\\' || c == ':') break;
+#else /* PCF_IS_LINUX */
+		if (c == '/') break;
+#endif
+		if (c == '.') {
+			const TCHAR prev = name[i - 2];
+#if defined(PCF_IS_WIN)
+			if (prev != '/' && prev != '\\' && prev != ':') ext = i - 1;
+#else /* PCF_IS_LINUX */
+			if (prev != '/') ext = i - 1;
+#endif
+			break;
+		}
+	}
+	int n;
+	do {
+		out->seq++;
+		n = _sntprintf(file + ext, size - ext, _T(".%lu%s"), out->seq, name + ext);
+		if (n < 0 || (size_t)n >= (size - ext)) {
+			free(file);
+			file = NULL;
+			break;
+		}
+	} while (outputFileExists(file, ext + (size_t)n) != 0);
+onError:
+	free(name);
+	return file;
+}
+
+
+/**
+ * Returns the wall clock time when the given output starts its next file. The rotation period
+ * is aligned to local time boundaries unless UTC output was selected. This way, a period of one
+ * day starts a new file each midnight.
+ *
+ * @param[in] out - rotated output file
+ * @param[in] wall - current wall clock time in milliseconds since the epoch
+ * @return rotation time in milliseconds since the epoch or INT64_MAX if not rotated by time
+ */
+static int64_t getRotateTime(const tOutput * out, const int64_t wall) {
+	const int64_t period = (int64_t)(out->rotateIntvl) * 1000;
+	if (period <= 0) return INT64_MAX;
+	const int64_t local = wall + ((out->utc != 0) ? 0 : getUtcOffsetMs((time_t)(wall / 1000)));
+	int64_t rem = local % period;
+	if (rem < 0) rem += period;
+	return wall + (period - rem);
+}
+
+
+/**
+ * Starts a new output file for the given output if its rotation policy is due. The incomplete
+ * columnar block and all buffered records are written to the previous file before. The previous
+ * file is compressed in the background if requested. Errors are reported on ferr.
+ *
+ * @param[in,out] out - output file
+ * @param[in] wall - current wall clock time in milliseconds since the epoch
+ * @return 1 on success, else 0
+ */
+static int rotateOutput(tOutput * out, const int64_t wall) {
+	if (out == NULL || out->name == NULL) return 1;
+	if (wall < out->rotateAt && (out->rotateSize == 0 || sinkFileSize(out->sink) < out->rotateSize)) return 1;
+	if (flushBlock(out, wall) == 0) {
+		if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_FMT_WRITE));
+		return 0;
+	}
+	TCHAR * file = getOutputFile(out, wall, 1);
+	if (file == NULL) {
+		if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
+		return 0;
+	}
+	if (sinkReopen(out->sink, file) == 0) {
+		if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_FILE_OPEN), file);
+		free(file);
+		return 0;
+	}
+	compressOutput(out, out->file);
+	out->file = file;
+	out->rotateAt = getRotateTime(out, wall);
+	preallocOutput(out);
+	if (writeHeader(out, wall) == 0) {
+		if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_FILE_OPEN), file);
+		return 0;
+	}
+	return 1;
+}
+
+
+/**
+ * Compresses the given rotated output file in the background with the compression command of
+ * the passed output. A previous compression of the same output is awaited first. The file is
+ * kept as is if no compression command was given.
+ *
+ * @param[in,out] out - output file
+ * @param[in] file - rotated output file path (ownership is passed)
+ */
+static void compressOutput(tOutput * out, TCHAR * file) {
+	if (out == NULL || file == NULL) return;
+	if (out->compress == NULL) {
+		free(file);
+		return;
+	}
+	finishCompress(out);
+	out->compressFile = file;
+	out->compressor = thr_create(runCompress, out);
+	if (out->compressor == NULL) {
+		if (verbose > 1) _ftprintf(ferr, MSGT(MSGT_WARN_COMPRESS), file);
+		free(out->compressFile);
+		out->compressFile = NULL;
+	}
+}
+
+
+/**
+ * Waits for the running compression of the given output to finish.
+ *
+ * @param[in,out] out - output file
+ */
+static void finishCompress(tOutput * out) {
+	if (out == NULL) return;
+	if (out->compressor != NULL) {
+		thr_join(out->compressor);
+		out->compressor = NULL;
+	}
+	if (out->compressFile != NULL) {
+		free(out->compressFile);
+		out->compressFile = NULL;
+	}
+}
+
+
+/**
+ * Compression thread entry point.
+ *
+ * @param[in,out] arg - output file (tOutput)
+ * @return 1 on success, else 0
+ */
+static int runCompress(void * arg) {
+	const tOutput * out = (const tOutput *)arg;
+	const int res = runCommand(out->compress, out->compressFile);
+	if (res == 0 && verbose > 1) _ftprintf(ferr, MSGT(MSGT_WARN_COMPRESS), out->compressFile);
+	return res;
+}
+
+
+/**
+ * Runs the given command with the passed file path as additional argument and waits for it to
+ * finish. The command is interpreted by the shell on Linux.
+ *
+ * @param[in] cmd - command line
+ * @param[in] file - file path to append
+ * @return 1 if the command succeeded, else 0
+ */
+static int runCommand(const TCHAR * cmd, const TCHAR * file) {
+	if (cmd == NULL || file == NULL) return 0;
+#if defined(PCF_IS_WIN)
+	const size_t size = _tcslen(cmd) + _tcslen(file) + 4;
+	TCHAR * line = (TCHAR *)malloc(size * sizeof(TCHAR));
+	if (line == NULL) return 0;
+	_sntprintf(line, size, _T("%s \"%s\""), cmd, file);
+	STARTUPINFO si;
+	PROCESS_INFORMATION pi;
+	memset(&si, 0, sizeof(si));
+	si.cb = sizeof(si);
+	const BOOL ok = CreateProcess(NULL, line, NULL, NULL, FALSE, CREATE_NO_WINDOW, NULL, NULL, &si, &pi);
+	free(line);
+	if (ok == 0) return 0;
+	DWORD code = 1;
+	WaitForSingleObject(pi.hProcess, INFINITE);
+	GetExitCodeProcess(pi.hProcess, &code);
+	CloseHandle(pi.hThread);
+	CloseHandle(pi.hProcess);
+	return (code == 0) ? 1 : 0;
+#else /* PCF_IS_LINUX */
+	/* the path is passed as positional parameter to avoid quoting it; system() would block SIGINT */
+	static const char args[] = " \"$1\"";
+	const size_t len = strlen(cmd);
+	char * line = (char *)malloc(len + sizeof(args));
+	if (line == NULL) return 0;
+	memcpy(line, cmd, len);
+	memcpy(line + len, args, sizeof(args));
+	char * argv[] = {(char *)"sh", (char *)"-c", line, (char *)"sh", (char *)file, NULL};
+	pid_t pid;
+	const int res = posix_spawn(&pid, "/bin/sh", NULL, NULL, argv, environ);
+	free(line);
+	if (res != 0) return 0;
+	int status;
+	while (waitpid(pid, &status, 0) < 0) {
+		if (errno != EINTR) return 0;
+	}
+	return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 1 : 0;
+#endif
+}
+
+
+/**
+ * Checks whether the given file exists.
+ *
+ * @param[in] path - file path
+ * @return non-zero if it exists, else 0
+ */
+static int fileExists(const TCHAR * path) {
+	if (path == NULL) return 0;
+#if defined(PCF_IS_WIN)
+	return (GetFileAttributes(path) != INVALID_FILE_ATTRIBUTES) ? 1 : 0;
+#else /* PCF_IS_LINUX */
+	return (access(path, F_OK) == 0) ? 1 : 0;
+#endif
+}
+
+
+/**
+ * Checks whether the given output file or a compressed copy of it exists. The path is temporarily
+ * extended by each extension of COMPRESS_EXTS for this.
+ *
+ * @param[in,out] path - file path with room for COMPRESS_EXT_MAX more characters
+ * @param[in] len - length of path in number of characters
+ * @return non-zero if it exists, else 0
+ */
+static int outputFileExists(TCHAR * path, const size_t len) {
+	static const TCHAR * const exts[] = COMPRESS_EXTS;
+	int res = fileExists(path);
+	for (size_t i = 0; res == 0 && i < (sizeof(exts) / sizeof(*exts)); i++) {
+		memcpy(path + len, exts[i], (_tcslen(exts[i]) + 1) * sizeof(TCHAR));
+		res = fileExists(path);
+	}
+	path[len] = 0;
+	return res;
+}
+
+
+/**
+ * Processes the data from the given serial devices. This function outputs the received data with
+ * the format string provided on the output file of each device. All devices are read by a single
+ * thread. The decoded samples are aggregated and output by a separate writer thread unless the
+ * queue size is 0. This keeps slow outputs from stalling the serial input. Lost devices are
+ * reconnected with exponential backoff while the other devices, the intervals and the outputs
+ * continue.
+ *
+ * @param[in,out] devs - list of devices
+ * @param[in] count - number of devices in devs
+ * @param[in,out] in - input buffer to use
+ * @return program exit code
+ * @remarks Possible error codes are defined in arduino/DHT11.hpp and arduino/DHT22.hpp.
+ */
+static int processData(tDevice * devs, const size_t count, tRing * in) {
+	if (signalReceived == 0 && (devs == NULL || count == 0 || count > SER_WAIT_MAX || in == NULL || in->size == 0)) return EXIT_FAILURE;
+	tSerial * ser[SER_WAIT_MAX];
+	uint8_t ready[SER_WAIT_MAX];
+	tWriter writer = {devs, count, 0, 0};
+	tThread * thread = NULL;
+	int ret = EXIT_FAILURE;
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		tDevice * dev = devs + i;
+		if (dev->ser == NULL || dev->out == NULL || dev->cfg.prog == NULL) return EXIT_FAILURE;
+		ser[i] = dev->ser;
+	}
+
+	/* start the writer thread */
+	if (queueSize > 0) {
+		sampleQueue = queueCreate(queueSize, sizeof(tSample), queuePolicy);
+		if (sampleQueue == NULL) {
+			if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
+			return EXIT_FAILURE;
+		}
+		thread = thr_create(runWriter, &writer);
+		if (thread == NULL) {
+			if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_THREAD));
+			queueDelete(sampleQueue);
+			sampleQueue = NULL;
+			return EXIT_FAILURE;
+		}
+	}
+
+	/* new serial devices trigger reconnection attempts; the backoff remains if not supported */
+	if (reconnectMax > 0) ser_watchHotplug(wakeup);
+
+	while (signalReceived == 0) {
+		size_t timeout;
+		int64_t mono = getMonoMs();
+		if (thread != NULL) {
+			/* the writer thread finishes if all devices are done or on error */
+			if (THR_LOAD(&(writer.finished)) != 0) break;
+			/* retry to move spilled samples back to the queue until none are left */
+			timeout = (queueService(sampleQueue) != 0) ? QUEUE_SERVICE_DELAY : SER_INFINITE;
+		} else {
+			/* check if all devices are done */
+			if (once != 0) {
+				for (i = 0; i < count && devs[i].done != 0; i++);
+				if (i >= count) break;
+			}
+			/* sleep until data arrives, a signal is received, the next interval ends or output is due */
+			timeout = getOutputTimeout(devs, count, mono);
+		}
+		for (i = 0; i < count; i++) {
+			/* lost devices are not waited for */
+			ser[i] = devs[i].ser;
+			if (ser[i] == NULL) {
+				timeout = PCF_MIN(timeout, (size_t)PCF_MAX(devs[i].retryAt - mono, INT64_C(0)));
+			} else if (devs[i].link != LS_IDLE) {
+				/* wake up for the next handshake step of reconnecting devices */
+				const int64_t due = PCF_MIN(devs[i].linkAt, devs[i].linkDeadline);
+				timeout = PCF_MIN(timeout, (size_t)PCF_MAX(due - mono, INT64_C(0)));
+			}
+		}
+		errno = 0;
+		const int res = ser_wait(ser, count, ready, wakeup, timeout);
+		if (res == -1) {
+			if (errno == EINTR) continue;
+			if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_WAIT));
+			goto onError;
+		}
+		MET_INC(&(loopMetrics.inputWakeups));
+		mono = getMonoMs();
+		const int64_t wall = getTimeMs();
+		/* complete the intervals which ended before the received data */
+		for (i = 0; thread == NULL && i < count; i++) {
+			if (processInterval(devs + i, mono, wall) == 0) goto onError;
+		}
+		for (i = 0; res > 0 && i < count; i++) {
+			if (ready[i] == 0) continue;
+			const uint64_t start = metClockUs();
+			errno = 0;
+			const ssize_t len = readInput(devs + i, in, 0);
+			if (len == -1) {
+				if (reconnectMax > 0 && errno != EINTR) {
+					disconnectDevice(devs + i, mono);
+					continue;
+				}
+				if (verbose > 0 && errno != EINTR) _ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_READ), devs[i].name);
+				goto onError;
+			}
+			if (len > 0) {
+				processRing(devs + i, in);
+				metHistAdd(&(devs[i].met.readTime), metClockUs() - start);
+			}
+		}
+		/* continue the connection handshake of reconnecting devices with the received data */
+		for (i = 0; i < count; i++) {
+			tDevice * dev = devs + i;
+			if (dev->ser == NULL || dev->link == LS_IDLE) continue;
+			if (continueLink(dev, getMonoMs()) == 0) disconnectDevice(dev, mono);
+		}
+		/* start reconnecting lost devices which are due */
+		const int hotplug = ser_hotplugPending(wakeup);
+		for (i = 0; i < count && signalReceived == 0; i++) {
+			tDevice * dev = devs + i;
+			if (dev->ser != NULL) continue;
+			if (hotplug != 0) {
+				dev->retryDelay = RECONNECT_DELAY;
+				dev->retryAt = PCF_MIN(dev->retryAt, mono + HOTPLUG_DELAY);
+			}
+			const int64_t now = getMonoMs();
+			if (now < dev->retryAt) continue;
+			if (reconnectDevice(dev, now) != 0) continue;
+			dev->retryDelay = PCF_MIN(dev->retryDelay * 2, reconnectMax * 1000);
+			dev->retryAt = now + (int64_t)(dev->retryDelay);
+		}
+		/* start new intervals, output the ones completed by the received data and write due output */
+		if (thread == NULL && processOutput(devs, count, mono, wall) == 0) goto onError;
+	}
+	ret = EXIT_SUCCESS;
+onError:
+	if (ret != EXIT_SUCCESS) signalReceived++;
+	if (thread != NULL) {
+		/* let the writer thread output the remaining samples */
+		THR_STORE(&(writer.stop), 1);
+		queueWake(sampleQueue);
+		if (thr_join(thread) != 1) ret = EXIT_FAILURE;
+		tQueueStats stats = {0, 0, 0, 0};
+		queueGetStats(sampleQueue, &stats);
+		if (stats.dropped > 0 && verbose > 1) _ftprintf(ferr, MSGT(MSGT_WARN_QUEUE_DROPPED), (unsigned)(stats.dropped));
+		if (verbose > 2) _ftprintf(ferr, MSGT(MSGT_INFO_QUEUE_STATS), (unsigned)(stats.highWater), (unsigned)(stats.capacity), (unsigned)(stats.spilled));
+		queueDelete(sampleQueue);
+		sampleQueue = NULL;
+	} else if (ret == EXIT_SUCCESS && flushOutput(devs, count) == 0) {
+		ret = EXIT_FAILURE;
+	}
+	return ret;
+}
+
+
+/**
+ * Aggregates the samples queued by processData() and outputs them once per interval. The writer
+ * thread runs this function until it is stopped or all devices are done (see option --once). The
+ * queued samples are processed with their reception time.
+ *
+ * @param[in,out] arg - shared state of the reader and writer thread (tWriter)
+ * @return 1 on success, else 0
+ */
+static int runWriter(void * arg) {
+	tWriter * writer = (tWriter *)arg;
+	tSample sample;
+	int res = 0;
+	size_t i;
+
+	for (;;) {
+		/* samples queued before the stop request are still processed */
+		const int stop = THR_LOAD(&(writer->stop));
+		while (queuePop(sampleQueue, &sample) != 0) {
+			tDevice * dev = sample.dev;
+			/* complete the interval which ended before the sample was received */
+			if (processInterval(dev, sample.mono, sample.wall) == 0) goto onError;
+			if (sample.summary != 0) {
+				applySummary(dev, sample.channel, sample.value, sample.wall);
+			} else {
+				applySample(dev, sample.channel, sample.temp, sample.rh, sample.wall);
+			}
+			if (processInterval(dev, sample.mono, sample.wall) == 0) goto onError;
+		}
+		const int64_t mono = getMonoMs();
+		if (processOutput(writer->devs, writer->count, mono, getTimeMs()) == 0) goto onError;
+		if (stop != 0) break;
+		/* check if all devices are done */
+		if (once != 0) {
+			for (i = 0; i < writer->count && writer->devs[i].done != 0; i++);
+			if (i >= writer->count) break;
+		}
+		/* sleep until samples arrive, the next interval ends or output is due */
+		if (queueWait(sampleQueue, getOutputTimeout(writer->devs, writer->count, mono)) < 0) goto onError;
+		MET_INC(&(loopMetrics.outputWakeups));
+	}
+	/* write remaining buffered output */
+	res = flushOutput(writer->devs, writer->count);
+onError:
+	THR_STORE(&(writer->finished), 1);
+	ser_wakeup(wakeup);
+	return res;
+}
+
+
+/**
+ * Outputs the intervals of the given devices which are due and writes buffered output and the
+ * metrics file if due.
+ *
+ * @param[in,out] devs - list of devices
+ * @param[in] count - number of devices in devs
+ * @param[in] mono - current monotonic time in milliseconds
+ * @param[in] wall - current wall clock time in milliseconds since the epoch
+ * @return 1 on success, else 0
+ */
+static int processOutput(tDevice * devs, const size_t count, const int64_t mono, const int64_t wall) {
+	size_t i;
+	for (i = 0; i < count; i++) {
+		if (processInterval(devs + i, mono, wall) == 0) return 0;
+	}
+	if (pollOutput(devs, count, wall) == 0) return 0;
+	if (metricsPath != NULL && mono >= metricsDue) {
+		writeMetrics(devs, count);
+		metricsDue = mono + ((int64_t)metricsIntvl * 1000);
+	}
+	return 1;
+}
+
+
+/**
+ * Writes the buffered output of the given devices which is due according to the flush policy.
+ *
+ * @param[in,out] devs - list of devices
+ * @param[in] count - number of devices in devs
+ * @param[in] wall - current wall clock time in milliseconds since the epoch
+ * @return 1 on success, else 0
+ */
+static int pollOutput(tDevice * devs, const size_t count, const int64_t wall) {
+	for (size_t i = 0; i < count; i++) {
+		int res = sinkPoll(devs[i].out->sink, wall);
+		for (size_t j = 0; j < devs[i].rollupCount && res != 0; j++) res = sinkPoll(devs[i].rollup[j].out->sink, wall);
+		if (res == 0) {
+			if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_FMT_WRITE));
+			return 0;
+		}
+	}
+	return 1;
+}
+
+
+/**
+ * Writes the remaining buffered output of the given devices.
+ *
+ * @param[in,out] devs - list of devices
+ * @param[in] count - number of devices in devs
+ * @return 1 on success, else 0
+ */
+static int flushOutput(tDevice * devs, const size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		int res = sinkFlush(devs[i].out->sink);
+		for (size_t j = 0; j < devs[i].rollupCount && res != 0; j++) res = sinkFlush(devs[i].rollup[j].out->sink);
+		if (res == 0) {
+			if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_FMT_WRITE));
+			return 0;
+		}
+	}
+	return 1;
+}
+
+
+/**
+ * Returns the time until the next interval of the given devices ends, buffered output is due or
+ * the metrics file needs to be updated.
+ *
+ * @param[in] devs - list of devices
+ * @param[in] count - number of devices in devs
+ * @param[in] mono - current monotonic time in milliseconds
+ * @return timeout in milliseconds or SER_INFINITE
+ */
+static size_t getOutputTimeout(const tDevice * devs, const size_t count, const int64_t mono) {
+	size_t timeout = SER_INFINITE;
+	if (metricsPath != NULL) timeout = (size_t)PCF_MAX(metricsDue - mono, INT64_C(0));
+	for (size_t i = 0; i < count; i++) {
+		const tDevice * dev = devs + i;
+		int64_t deadline;
+		if (sinkDeadline(dev->out->sink, &deadline) != 0) timeout = PCF_MIN(timeout, msUntil(deadline));
+		if (hasValues(dev->chan) != 0) {
+			const int64_t remaining = (once != 0) ? 0 : PCF_MAX(dev->intvlEnd - mono, INT64_C(0));
+			timeout = PCF_MIN(timeout, (size_t)remaining);
+		}
+		for (size_t j = 0; j < dev->rollupCount; j++) {
+			const tRollup * rollup = dev->rollup + j;
+			if (sinkDeadline(rollup->out->sink, &deadline) != 0) timeout = PCF_MIN(timeout, msUntil(deadline));
+			if (hasValues(rollup->chan) == 0) continue;
+			timeout = PCF_MIN(timeout, (size_t)PCF_MAX(rollup->intvlEnd - mono, INT64_C(0)));
+		}
+	}
+	return timeout;
+}
+
+
+/**
+ * Writes the counters of the given devices to the metrics file if enabled. Failures are reported
+ * as warning only.
+ *
+ * @param[in] devs - list of devices
+ * @param[in] count - number of devices in devs
+ */
+static void writeMetrics(const tDevice * devs, const size_t count) {
+	const tMetrics * met[SER_WAIT_MAX];
+	if (metricsPath == NULL || devs == NULL || count > SER_WAIT_MAX) return;
+	for (size_t i = 0; i < count; i++) met[i] = &(devs[i].met);
+	if (metWriteFile(metricsPath, met, count, &loopMetrics) == 0 && verbose > 1) {
+		_ftprintf(ferr, MSGT(MSGT_WARN_METRICS_WRITE), metricsPath);
+	}
+}
+
+
+/**
+ * Processes the data from the given replayed raw capture files as fast as possible. The reception
+ * time of the recorded data replaces the current time. Records of multiple files are processed in
+ * the order of their reception time. The last interval is output even if it is incomplete.
+ *
+ * @param[in,out] devs - list of replayed devices
+ * @param[in] count - number of devices in devs
+ * @return program exit code
+ */
+static int processReplay(tDevice * devs, const size_t count) {
+	if (devs == NULL || count == 0 || count > SER_WAIT_MAX) return EXIT_FAILURE;
+	tCapRecord rec[SER_WAIT_MAX];
+	int pending[SER_WAIT_MAX];
+	int64_t wall = 0;
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		if (devs[i].replay == NULL || devs[i].out == NULL || devs[i].cfg.prog == NULL) return EXIT_FAILURE;
+		pending[i] = capRead(devs[i].replay, rec + i);
+		if (pending[i] < 0) {
+			if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_CAP_READ), devs[i].name);
+			return EXIT_FAILURE;
+		}
+	}
+
+	while (signalReceived == 0) {
+		/* check if all devices are done */
+		if (once != 0) {
+			for (i = 0; i < count && devs[i].done != 0; i++);
+			if (i >= count) break;
+		}
+		/* process the oldest pending record */
+		size_t next = count;
+		for (i = 0; i < count; i++) {
+			if (pending[i] > 0 && (next >= count || rec[i].time < rec[next].time)) next = i;
+		}
+		if (next >= count) {
+			/* complete the last interval */
+			for (i = 0; i < count; i++) devs[i].intvlDue = 1;
+		} else {
+			wall = rec[next].time;
+		}
+		/* the recorded time serves as monotonic and wall clock time */
+		for (i = 0; i < count; i++) {
+			if (processInterval(devs + i, wall, wall) == 0) return EXIT_FAILURE;
+		}
+		if (next < count) {
+			tDevice * dev = devs + next;
+			processInput(dev, rec[next].data, rec[next].size);
+			pending[next] = capRead(dev->replay, rec + next);
+			if (pending[next] < 0) {
+				if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_CAP_READ), dev->name);
+				return EXIT_FAILURE;
+			}
+			if (processInterval(dev, wall, wall) == 0) return EXIT_FAILURE;
+		}
+		/* write buffered output which is due */
+		if (pollOutput(devs, count, wall) == 0) return EXIT_FAILURE;
+		if (next >= count) break;
+	}
+	/* write remaining buffered output */
+	return (flushOutput(devs, count) != 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/**
+ * Parses the given baud rate string.
+ *
+ * @param[in] str - baud rate string
+ * @param[out] baud - parsed baud rate
+ * @return 1 on success, else 0
+ */
+static int parseBaud(const TCHAR * str, size_t * baud) {
+	TCHAR * strNum;
+	const long value = _tcstol(str, &strNum, 10);
+	if (value < 1 || strNum == NULL || *strNum != 0) return 0;
+	*baud = (size_t)value;
+	return 1;
+}
+
+
+/**
+ * Parses the given serial interface framing string (e.g. 8N1).
+ *
+ * @param[in] str - framing string
+ * @param[out] framing - parsed framing
+ * @return 1 on success, else 0
+ */
+static int parseFraming(const TCHAR * str, tSerFraming * framing) {
+	static const struct {
+		const TCHAR * name;
+		tSerFraming framing;
+	} framings[] = {
+		{_T("7N1"), SFR_7N1},
+		{_T("8N1"), SFR_8N1},
+		{_T("7N2"), SFR_7N2},
+		{_T("8N2"), SFR_8N2},
+		{_T("7E1"), SFR_7E1},
+		{_T("8E1"), SFR_8E1},
+		{_T("7E2"), SFR_7E2},
+		{_T("8E2"), SFR_8E2},
+		{_T("7O1"), SFR_7O1},
+		{_T("8O1"), SFR_8O1},
+		{_T("7O2"), SFR_7O2},
+		{_T("8O2"), SFR_8O2}
+	};
+	for (size_t i = 0; i < (sizeof(framings) / sizeof(*framings)); i++) {
+		if (_tcsicmp(str, framings[i].name) == 0) {
+			*framing = framings[i].framing;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+
+/**
+ * Parses the given serial interface flow control string (none, sw or hw).
+ *
+ * @param[in] str - flow control string
+ * @param[out] flow - parsed flow control
+ * @return 1 on success, else 0
+ */
+static int parseFlow(const TCHAR * str, tSerFlowCtrl * flow) {
+	if (_tcscmp(str, _T("none")) == 0) {
+		*flow = SFC_NONE;
+	} else if (_tcscmp(str, _T("sw")) == 0) {
+		*flow = SFC_SW;
+	} else if (_tcscmp(str, _T("hw")) == 0) {
+		*flow = SFC_HW;
+	} else {
+		return 0;
+	}
+	return 1;
+}
+
+
+/**
+ * Parses the given output file format string (text, binary, columnar or influx).
+ *
+ * @param[in] str - output file format string
+ * @param[out] format - parsed output file format
+ * @return 1 on success, else 0
+ */
+static int parseOutFormat(const TCHAR * str, tOutFormat * format) {
+	if (_tcscmp(str, _T("text")) == 0) {
+		*format = OF_TEXT;
+	} else if (_tcscmp(str, _T("binary")) == 0) {
+		*format = OF_BINARY;
+	} else if (_tcscmp(str, _T("columnar")) == 0) {
+		*format = OF_COLUMNAR;
+	} else if (_tcscmp(str, _T("influx")) == 0) {
+		*format = OF_INFLUX;
+	} else {
+		return 0;
+	}
+	return 1;
+}
+
+
+/**
+ * Parses the given backpressure policy string (drop, block or spill).
+ *
+ * @param[in] str - backpressure policy string
+ * @param[out] policy - parsed backpressure policy
+ * @return 1 on success, else 0
+ */
+static int parseBackpressure(const TCHAR * str, tQueuePolicy * policy) {
+	if (_tcscmp(str, _T("drop")) == 0) {
+		*policy = QP_DROP;
+	} else if (_tcscmp(str, _T("block")) == 0) {
+		*policy = QP_BLOCK;
+	} else if (_tcscmp(str, _T("spill")) == 0) {
+		*policy = QP_SPILL;
+	} else {
+		return 0;
+	}
+	return 1;
+}
+
+
+/**
+ * Initializes the data processing state of the given device.
+ *
+ * @param[in,out] dev - device to initialize
+ */
+static void initDevice(tDevice * dev) {
+	resetValues(dev);
+	resetLink(dev);
+	dev->done = 0;
+	dev->intvlDue = 0;
+	dev->intvlEnd = INT64_MAX;
+	for (size_t i = 0; i < dev->rollupCount; i++) {
+		tRollup * rollup = dev->rollup + i;
+		for (size_t j = 0; j < PROTO_MAX_CHANNELS; j++) {
+			statsReset(&(rollup->chan[j].tempStats));
+			statsReset(&(rollup->chan[j].rhStats));
+			rollup->chan[j].summary = 0;
+			rollup->chan[j].intvlDue = 0;
+		}
+		rollup->intvlEnd = INT64_MAX;
+	}
+	dev->sampleCount = 0;
+	dev->lineCount = 0;
+}
+
+
+/**
+ * Resets the protocol state of the given device for a new connection. The statistics of the
+ * current interval are kept.
+ *
+ * @param[in,out] dev - device to reset
+ */
+static void resetLink(tDevice * dev) {
+	memset(&(dev->pLine), 0, sizeof(dev->pLine));
+	memset(&(dev->pFrame), 0, sizeof(dev->pFrame));
+	dev->binary = 0;
+	dev->seqValid = 0;
+	dev->expect = NULL;
+	dev->acked = 0;
+	dev->link = LS_IDLE;
+}
+
+
+/**
+ * Closes the serial interface of the given lost device and schedules the next reconnection
+ * attempt. A device which is lost during its connection handshake keeps its backoff.
+ *
+ * @param[in,out] dev - lost device
+ * @param[in] mono - current monotonic time in milliseconds
+ */
+static void disconnectDevice(tDevice * dev, const int64_t mono) {
+	if (dev->link == LS_IDLE) {
+		if (verbose > 1) _ftprintf(ferr, MSGT(MSGT_WARN_REMOTE_DISCONNECTED), dev->name);
+		dev->retryDelay = RECONNECT_DELAY;
+	} else {
+		/* failed reconnection attempt */
+		dev->retryDelay = PCF_MIN(dev->retryDelay * 2, reconnectMax * 1000);
+	}
+	ser_delete(dev->ser);
+	dev->ser = NULL;
+	resetLink(dev);
+	dev->retryAt = mono + (int64_t)(dev->retryDelay);
+}
+
+
+/**
+ * Reconnects to the given lost device and starts the connection handshake. The handshake is
+ * continued via continueLink() with the data received in the main loop. This way, the other
+ * devices are served meanwhile. The intervals and the output of the device are not affected.
+ * Values received during the handshake are kept. Handshake errors are reported on ferr.
+ *
+ * @param[in,out] dev - lost device
+ * @param[in] mono - current monotonic time in milliseconds
+ * @return 1 on success, else 0
+ */
+static int reconnectDevice(tDevice * dev, const int64_t mono) {
+	const tConfig * cfg = &(dev->cfg);
+	dev->ser = ser_create(dev->name, cfg->baud, cfg->framing, cfg->flow);
+	if (dev->ser == NULL) return 0;
+	ser_clear(dev->ser);
+	resetLink(dev);
+	dev->link = LS_READY;
+	dev->expect = PROTO_CMD_READY;
+	dev->linkAt = mono;
+	dev->linkDeadline = mono + (int64_t)(cfg->readyTimeout);
+	if (continueLink(dev, mono) == 0) {
+		ser_delete(dev->ser);
+		dev->ser = NULL;
+		resetLink(dev);
+		return 0;
+	}
+	return 1;
+}
+
+
+/**
+ * Continues the connection handshake of the given reconnecting device like waitReady(),
+ * switchBaud() and requestAggregation() do on start up. Each step ends once the expected control
+ * line was received or its timeout is reached. Errors are reported on ferr.
+ *
+ * @param[in,out] dev - reconnecting device
+ * @param[in] mono - current monotonic time in milliseconds
+ * @return 1 on success, else 0
+ */
+static int continueLink(tDevice * dev, const int64_t mono) {
+	const tConfig * cfg = &(dev->cfg);
+	if (dev->link == LS_READY) {
+		if (dev->acked == 0 && mono < dev->linkDeadline) {
+			/* the readiness is requested repeatedly to cover devices which are still starting up */
+			if (mono >= dev->linkAt) {
+				if (sendCommand(dev, PROTO_CMD_READY) == 0) return 0;
+				dev->linkAt = mono + READY_RETRY;
+			}
+			return 1;
+		}
+		if (dev->acked == 0 && verbose > 1) _ftprintf(ferr, MSGT(MSGT_WARN_REMOTE_NOT_READY), dev->name);
+		dev->expect = NULL;
+		dev->link = LS_BAUD;
+		if (cfg->baudSwitch != 0 && cfg->baudSwitch != cfg->baud) {
+			snprintf(dev->cmd, sizeof(dev->cmd), PROTO_CMD_BAUD " %u", (unsigned)(cfg->baudSwitch));
+			if (requestLinkAck(dev, LS_BAUD, mono) == 0) return 0;
+		}
+	}
+	if (dev->link == LS_BAUD) {
+		if (dev->expect != NULL) {
+			if (dev->acked == 0 && mono < dev->linkDeadline) return 1;
+			if (dev->acked == 0) {
+				/* the current speed is kept */
+				if (verbose > 1) _ftprintf(ferr, MSGT(MSGT_WARN_REMOTE_NO_ACK), dev->name, dev->cmd);
+			} else if (ser_setConfig(dev->ser, cfg->baudSwitch, cfg->framing, cfg->flow) == 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_CONFIG), dev->name);
+				return 0;
+			}
+		}
+		dev->expect = NULL;
+		dev->link = LS_AGGREGATE;
+		if (cfg->aggregate != 0 && cfg->binary != 0) {
+			snprintf(dev->cmd, sizeof(dev->cmd), PROTO_CMD_AGGREGATE " %u", (unsigned)PCF_MIN(cfg->intvl, (size_t)PROTO_AGGREGATE_MAX));
+			if (requestLinkAck(dev, LS_AGGREGATE, mono) == 0) return 0;
+		}
+	}
+	if (dev->link == LS_AGGREGATE) {
+		if (dev->expect != NULL) {
+			if (dev->acked == 0 && mono < dev->linkDeadline) return 1;
+			if (dev->acked == 0 && verbose > 1) _ftprintf(ferr, MSGT(MSGT_WARN_REMOTE_NO_ACK), dev->name, dev->cmd);
+		}
+		/* devices without support for the binary protocol keep sending ASCII lines */
+		if (cfg->binary != 0 && sendCommand(dev, PROTO_CMD_BINARY) == 0) return 0;
+		dev->expect = NULL;
+		dev->acked = 0;
+		dev->link = LS_IDLE;
+		MET_INC(&(dev->met.reconnects));
+		if (verbose > 2) _ftprintf(ferr, MSGT(MSGT_INFO_REMOTE_RECONNECTED), dev->name);
+	}
+	return 1;
+}
+
+
+/**
+ * Sends the command in the command buffer of the given reconnecting device and waits for its
+ * acknowledgement in the passed handshake step. Errors are reported on ferr.
+ *
+ * @param[in,out] dev - reconnecting device
+ * @param[in] link - handshake step which waits for the acknowledgement
+ * @param[in] mono - current monotonic time in milliseconds
+ * @return 1 on success, else 0
+ */
+static int requestLinkAck(tDevice * dev, const tLinkState link, const int64_t mono) {
+	if (sendCommand(dev, dev->cmd) == 0) return 0;
+	dev->link = link;
+	dev->expect = dev->cmd;
+	dev->acked = 0;
+	dev->linkAt = INT64_MAX;
+	dev->linkDeadline = mono + COMMAND_TIMEOUT;
+	return 1;
+}
+
+
+/**
+ * Waits until all given remote devices signal their readiness or their timeout is reached.
+ * The readiness is requested repeatedly to cover devices which are still starting up. Data
+ * received in the meantime is processed as usual. Errors are reported on ferr.
+ *
+ * @param[in,out] devs - list of devices
+ * @param[in] count - number of devices in devs
+ * @param[in,out] in - input buffer to use
+ * @return 1 on success, else 0
+ * @remarks Devices which do not signal readiness in time are used anyway.
+ */
+static int waitReady(tDevice * devs, const size_t count, tRing * in) {
+	tSerial * ser[SER_WAIT_MAX];
+	uint8_t ready[SER_WAIT_MAX];
+	int64_t deadline[SER_WAIT_MAX];
+	int64_t nextRequest[SER_WAIT_MAX];
+	size_t pending = 0;
+	size_t i;
+	if (devs == NULL || count > SER_WAIT_MAX) return 0;
+	const int64_t start = getMonoMs();
+	for (i = 0; i < count; i++) {
+		ser[i] = devs[i].ser;
+		deadline[i] = start + (int64_t)(devs[i].cfg.readyTimeout);
+		nextRequest[i] = start;
+		devs[i].expect = PROTO_CMD_READY;
+		devs[i].acked = 0;
+		pending++;
+	}
+	while (pending > 0 && signalReceived == 0) {
+		/* (re-)send readiness requests and find the next point in time to act */
+		const int64_t now = getMonoMs();
+		int64_t next = INT64_MAX;
+		for (i = 0; i < count; i++) {
+			tDevice * dev = devs + i;
+			if (dev->expect == NULL) continue;
+			if (dev->acked != 0 || now >= deadline[i]) {
+				if (dev->acked == 0 && verbose > 1) _ftprintf(ferr, MSGT(MSGT_WARN_REMOTE_NOT_READY), dev->name);
+				dev->expect = NULL;
+				pending--;
+				continue;
+			}
+			if (now >= nextRequest[i]) {
+				if (sendCommand(dev, PROTO_CMD_READY) == 0) return 0;
+				nextRequest[i] = now + READY_RETRY;
+			}
+			next = PCF_MIN(next, PCF_MIN(nextRequest[i], deadline[i]));
+		}
+		if (pending == 0) break;
+		errno = 0;
+		const int res = ser_wait(ser, count, ready, wakeup, (size_t)PCF_MAX(next - getMonoMs(), INT64_C(0)));
+		if (res == -1) {
+			if (errno == EINTR) continue;
+			_ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_WAIT));
+			return 0;
+		}
+		for (i = 0; res > 0 && i < count; i++) {
+			if (ready[i] == 0) continue;
+			errno = 0;
+			const ssize_t len = readInput(devs + i, in, 0);
+			if (len == -1) {
+				if (errno == EINTR) continue;
+				_ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_READ), devs[i].name);
+				return 0;
+			}
+			if (len > 0) processRing(devs + i, in);
+		}
+	}
+	for (i = 0; i < count; i++) {
+		devs[i].expect = NULL;
+		devs[i].acked = 0;
+	}
+	return 1;
+}
+
+
+/**
+ * Requests the remote device to switch to the configured serial interface speed. The local serial
+ * interface follows once the remote device acknowledged the request. The current speed is kept
+ * otherwise. Errors are reported on ferr.
+ *
+ * @param[in,out] dev - remote device
+ * @param[in,out] in - input buffer to use
+ * @return 1 on success, else 0
+ */
+static int switchBaud(tDevice * dev, tRing * in) {
+	char cmd[CTRL_LINE_SIZE];
+	const tConfig * cfg = &(dev->cfg);
+	if (cfg->baudSwitch == 0 || cfg->baudSwitch == cfg->baud) return 1;
+	snprintf(cmd, sizeof(cmd), PROTO_CMD_BAUD " %u", (unsigned)(cfg->baudSwitch));
+	if (sendCommand(dev, cmd) == 0) return 0;
+	switch (waitAck(dev, cmd, in, COMMAND_TIMEOUT)) {
+	case 1:
+		break;
+	case 0:
+		if (verbose > 1) _ftprintf(ferr, MSGT(MSGT_WARN_REMOTE_NO_ACK), dev->name, cmd);
+		return 1;
+	default:
+		return 0;
+	}
+	if (ser_setConfig(dev->ser, cfg->baudSwitch, cfg->framing, cfg->flow) == 0) {
+		_ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_CONFIG), dev->name);
+		return 0;
+	}
+	return 1;
+}
+
+
+/**
+ * Requests the remote device to aggregate its readings over the update interval. This is only
+ * done if the binary protocol is requested, because the summaries are sent as binary frames.
+ * The values are aggregated on the host as usual if the remote device does not acknowledge the
+ * request. Errors are reported on ferr.
+ *
+ * @param[in,out] dev - remote device
+ * @param[in,out] in - input buffer to use
+ * @return 1 on success, else 0
+ */
+static int requestAggregation(tDevice * dev, tRing * in) {
+	char cmd[CTRL_LINE_SIZE];
+	const tConfig * cfg = &(dev->cfg);
+	if (cfg->aggregate == 0 || cfg->binary == 0) return 1;
+	snprintf(cmd, sizeof(cmd), PROTO_CMD_AGGREGATE " %u", (unsigned)PCF_MIN(cfg->intvl, (size_t)PROTO_AGGREGATE_MAX));
+	if (sendCommand(dev, cmd) == 0) return 0;
+	switch (waitAck(dev, cmd, in, COMMAND_TIMEOUT)) {
+	case 1:
+		break;
+	case 0:
+		if (verbose > 1) _ftprintf(ferr, MSGT(MSGT_WARN_REMOTE_NO_ACK), dev->name, cmd);
+		break;
+	default:
+		return 0;
+	}
+	return 1;
+}
+
+
+/**
+ * Sends the given command line to the remote device. Errors are reported on ferr.
+ *
+ * @param[in,out] dev - remote device
+ * @param[in] cmd - command without line termination
+ * @return 1 on success, else 0
+ */
+static int sendCommand(tDevice * dev, const char * cmd) {
+	char buf[CTRL_LINE_SIZE + 2];
+	const size_t len = strlen(cmd);
+	if (len > CTRL_LINE_SIZE) return 0;
+	memcpy(buf, cmd, len);
+	buf[len] = '\n';
+	if (ser_write(dev->ser, (const uint8_t *)buf, len + 1, COMMAND_TIMEOUT) != (ssize_t)(len + 1)) {
+		_ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_WRITE), dev->name);
+		return 0;
+	}
+	return 1;
+}
+
+
+/**
+ * Waits until the remote device sends the given control line or the timeout is reached. Data
+ * received in the meantime is processed as usual. Errors are reported on ferr.
+ *
+ * @param[in,out] dev - remote device
+ * @param[in] ack - expected control line without line termination
+ * @param[in,out] in - input buffer to use
+ * @param[in] timeout - timeout in milliseconds
+ * @return 1 if the control line was received, 0 on timeout or signal, -1 on error
+ */
+static int waitAck(tDevice * dev, const char * ack, tRing * in, const size_t timeout) {
+	const int64_t deadline = getMonoMs() + (int64_t)timeout;
+	int res = 0;
+	dev->expect = ack;
+	dev->acked = 0;
+	while (dev->acked == 0 && signalReceived == 0) {
+		const int64_t remaining = deadline - getMonoMs();
+		if (remaining <= 0) break;
+		errno = 0;
+		const ssize_t len = readInput(dev, in, (size_t)remaining);
+		if (len == -1) {
+			if (errno == EINTR) continue;
+			_ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_READ), dev->name);
+			res = -1;
+			break;
+		}
+		if (len > 0) processRing(dev, in);
+	}
+	if (dev->acked != 0) res = 1;
+	dev->expect = NULL;
+	dev->acked = 0;
+	return res;
+}
+
+
+/**
+ * Reads all data available from the serial interface of the given device to the passed input
+ * buffer.
+ *
+ * @param[in,out] dev - device to read from
+ * @param[in,out] in - receives the input data
+ * @param[in] timeout - timeout in milliseconds
+ * @return number of bytes read or -1 on error (see ser_readRing())
+ */
+static ssize_t readInput(tDevice * dev, tRing * in, const size_t timeout) {
+	const ssize_t len = ser_readRing(dev->ser, in, timeout);
+	if (len > 0) MET_ADD(&(dev->met.bytes), (size_t)len);
+	return len;
+}
+
+
+/**
+ * Passes all data of the given input buffer in place to the sensor value parsers of the device
+ * and removes it from the buffer. The data is also recorded to the raw capture file of the
+ * device if given. Errors are reported on ferr.
+ *
+ * @param[in,out] dev - device which received the data
+ * @param[in,out] in - received data
+ */
+static void processRing(tDevice * dev, tRing * in) {
+	const uint8_t * ptr;
+	size_t len;
+	while ((len = ring_data(in, &ptr)) > 0) {
+		if (dev->tee != NULL && capWrite(dev->tee, getTimeMs(), ptr, len) == 0) {
+			/* keep logging without recording */
+			if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_CAP_WRITE), dev->name);
+			capCloseWriter(dev->tee);
+			dev->tee = NULL;
+		}
+		processInput(dev, ptr, len);
+		ring_consume(in, len);
+	}
+}
+
+
+/**
+ * Passes the given chunk of received data to the sensor value parsers of the device.
+ *
+ * @param[in,out] dev - device which received the data
+ * @param[in] buf - received data
+ * @param[in] len - number of bytes in buf
+ */
+static void processInput(tDevice * dev, const uint8_t * buf, const size_t len) {
+	const uint8_t * ptr = buf;
+	size_t rem = len;
+	/* the protocol may change after each ASCII line */
+	while (rem > 0 && dev->binary == 0) {
+		if (parseLine(&(dev->pLine), &ptr, &rem) <= 0) break;
+		processLine(dev);
+	}
+	if (dev->binary != 0) {
+		for (size_t i = 0; i < rem; i++) processFrame(dev, (int)(ptr[i]));
+	}
+}
+
+
+/**
+ * Handles the ASCII line last decoded by the line parser of the device.
+ * Lines starting with '#' are handled as control lines.
+ *
+ * @param[in,out] dev - device which received the line
+ */
+static void processLine(tDevice * dev) {
+	const tPLineCtx * ctx = &(dev->pLine);
+	char ctrl[CTRL_LINE_SIZE];
+	MET_INC(&(dev->met.lines));
+	switch (ctx->type) {
+	case PLT_SAMPLE:
+		addSample(dev, ctx->channel, ctx->temp, ctx->rh);
+		break;
+	case PLT_CHECKSUM:
+		MET_INC(&(dev->met.checksumErrors));
+		if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_CHECKSUM), dev->name);
+		break;
+	case PLT_ERROR:
+		metDeviceError(&(dev->met), ctx->error);
+		if (verbose > 0) {
+			if (ctx->channel != 0) {
+				_ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_CHANNEL_VALUE), dev->name, ctx->error, (unsigned)(ctx->channel));
+			} else {
+				_ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_VALUE), dev->name, ctx->error);
+			}
+		}
+		break;
+	case PLT_CONTROL:
+		{
+			const size_t length = PCF_MIN(ctx->length, CTRL_LINE_SIZE - 1);
+			memcpy(ctrl, ctx->line, length);
+			ctrl[length] = 0;
+			processControl(dev, ctrl);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+
+/**
+ * Handles a control line received from the remote device. Unknown control lines are ignored.
+ *
+ * @param[in,out] dev - device which received the control line
+ * @param[in] line - null-terminated control line without line termination
+ */
+static void processControl(tDevice * dev, const char * line) {
+	if (dev->expect != NULL && strcmp(line, dev->expect) == 0) dev->acked = 1;
+	if (strcmp(line, PROTO_CMD_BINARY) == 0) {
+		/* the remote device acknowledged the binary protocol */
+		memset(&(dev->pFrame), 0, sizeof(dev->pFrame));
+		dev->binary = 1;
+		dev->seqValid = 0;
+	}
+}
+
+
+/**
+ * Passes the given character to the binary frame parser of the device.
+ *
+ * @param[in,out] dev - device which received the data
+ * @param[in] c - received character
+ */
+static void processFrame(tDevice * dev, const int c) {
+	tPFrameCtx * ctx = &(dev->pFrame);
+	const tPFrameState lastState = ctx->state;
+	parseFrame(ctx, c);
+	switch (ctx->state) {
+	case PFRS_STOP:
+		MET_INC(&(dev->met.frames));
+		if (dev->seqValid != 0 && ctx->seq != (uint8_t)(dev->seq + 1)) {
+			const uint8_t lost = (uint8_t)(ctx->seq - dev->seq - 1);
+			MET_ADD(&(dev->met.lostFrames), (size_t)lost);
+			if (verbose > 1) _ftprintf(ferr, MSGT(MSGT_WARN_REMOTE_LOST), (unsigned)lost, dev->name);
+		}
+		dev->seq = ctx->seq;
+		dev->seqValid = 1;
+		if (ctx->status != 0) {
+			metDeviceError(&(dev->met), (unsigned)(ctx->status));
+			if (verbose > 0) {
+				if (ctx->channel != 0) {
+					_ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_CHANNEL_VALUE), dev->name, (unsigned)(ctx->status), (unsigned)(ctx->channel));
+				} else {
+					_ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_VALUE), dev->name, (unsigned)(ctx->status));
+				}
+			}
+		} else if (ctx->type == PROTO_FRAME_SAMPLE) {
+			addSample(dev, ctx->channel, (int32_t)(ctx->value[0]), (int32_t)(ctx->value[1]));
+		} else if (ctx->type == PROTO_FRAME_SUMMARY) {
+			addSummary(dev, ctx->channel, ctx->value);
+		}
+		memset(ctx, 0, sizeof(*ctx));
+		break;
+	case PFRS_ERROR_CHECKSUM:
+		MET_INC(&(dev->met.checksumErrors));
+		if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_REMOTE_CHECKSUM), dev->name);
+		memset(ctx, 0, sizeof(*ctx));
+		break;
+	case PFRS_ERROR_TOKEN:
+		memset(ctx, 0, sizeof(*ctx));
+		/* resynchronize on this character */
+		if (lastState != PFRS_START) processFrame(dev, c);
+		break;
+	default:
+		break;
+	}
+}
+
+
+/**
+ * Adds the given sensor values to the current interval of the device. The values are queued for
+ * the writer thread if it runs.
+ *
+ * @param[in,out] dev - device which received the values
+ * @param[in] channel - sensor channel number
+ * @param[in] temp - temperature in tenths of degrees Celsius
+ * @param[in] rh - relative humidity in tenths of percent
+ */
+static void addSample(tDevice * dev, const uint8_t channel, const int32_t temp, const int32_t rh) {
+	if (sampleQueue != NULL) {
+		tSample sample;
+		memset(&sample, 0, sizeof(sample));
+		sample.dev = dev;
+		sample.mono = getMonoMs();
+		sample.wall = getTimeMs();
+		sample.channel = channel;
+		sample.temp = temp;
+		sample.rh = rh;
+		queuePush(sampleQueue, &sample);
+		return;
+	}
+	/* the reception time is only needed for the publication */
+	applySample(dev, channel, temp, rh, (dev->shm != NULL) ? getTimeMs() : 0);
+}
+
+
+/**
+ * Adds the values of the given summary frame to the current interval of the device. The values
+ * are queued for the writer thread if it runs.
+ *
+ * @param[in,out] dev - device which received the values
+ * @param[in] channel - sensor channel number
+ * @param[in] v - values of the received summary frame
+ */
+static void addSummary(tDevice * dev, const uint8_t channel, const int16_t * v) {
+	if (sampleQueue != NULL) {
+		tSample sample;
+		memset(&sample, 0, sizeof(sample));
+		sample.dev = dev;
+		sample.mono = getMonoMs();
+		sample.wall = getTimeMs();
+		sample.summary = 1;
+		sample.channel = channel;
+		memcpy(sample.value, v, sizeof(sample.value));
+		queuePush(sampleQueue, &sample);
+		return;
+	}
+	applySummary(dev, channel, v, (dev->shm != NULL) ? getTimeMs() : 0);
+}
+
+
+/**
+ * Adds the given sensor values to the statistics of the current interval of the device.
+ *
+ * @param[in,out] dev - device which received the values
+ * @param[in] channel - sensor channel number
+ * @param[in] temp - temperature in tenths of degrees Celsius
+ * @param[in] rh - relative humidity in tenths of percent
+ */
+static void applySample(tDevice * dev, const uint8_t channel, const int32_t temp, const int32_t rh, const int64_t wall) {
+	if (dev->done != 0 || channel >= PROTO_MAX_CHANNELS) return;
+	tChannel * chan = dev->chan + channel;
+	statsAdd(&(chan->tempStats), (double)temp / 10.0);
+	statsAdd(&(chan->rhStats), (double)rh / 10.0);
+	dev->sampleCount++;
+	MET_INC(&(dev->met.samples));
+	if (dev->shm != NULL) {
+		shmPublishSample(dev->shm + channel, wall, (double)temp / 10.0, (double)rh / 10.0, 0, &(chan->tempStats), &(chan->rhStats));
+	}
+}
+
+
+/**
+ * Adds the values of the given summary frame to the statistics of the current interval of the
+ * device. The interval of the channel is completed with it.
+ *
+ * @param[in,out] dev - device which received the values
+ * @param[in] channel - sensor channel number
+ * @param[in] v - values of the received summary frame
+ */
+static void applySummary(tDevice * dev, const uint8_t channel, const int16_t * v, const int64_t wall) {
+	const size_t count = (size_t)((uint16_t)(v[PROTO_SUMMARY_COUNT]));
+	if (dev->done != 0 || count == 0 || channel >= PROTO_MAX_CHANNELS) return;
+	tChannel * chan = dev->chan + channel;
+	statsAddSummary(
+		&(chan->tempStats),
+		count,
+		(double)(v[PROTO_SUMMARY_TEMP]) / 10.0,
+		(double)(v[PROTO_SUMMARY_TEMP_SD]) / 10.0,
+		(double)(v[PROTO_SUMMARY_TEMP_MIN]) / 10.0,
+		(double)(v[PROTO_SUMMARY_TEMP_MAX]) / 10.0
+	);
+	statsAddSummary(
+		&(chan->rhStats),
+		count,
+		(double)(v[PROTO_SUMMARY_RH]) / 10.0,
+		(double)(v[PROTO_SUMMARY_RH_SD]) / 10.0,
+		(double)(v[PROTO_SUMMARY_RH_MIN]) / 10.0,
+		(double)(v[PROTO_SUMMARY_RH_MAX]) / 10.0
+	);
+	dev->sampleCount += count;
+	MET_ADD(&(dev->met.samples), count);
+	chan->summary = 1;
+	chan->intvlDue = 1;
+	if (dev->shm != NULL) {
+		const double temp = (double)(v[PROTO_SUMMARY_TEMP]) / 10.0;
+		const double rh = (double)(v[PROTO_SUMMARY_RH]) / 10.0;
+		shmPublishSample(dev->shm + channel, wall, temp, rh, 1, &(chan->tempStats), &(chan->rhStats));
+	}
+}
+
+
+/**
+ * Discards the values of all channels of the given device within the current interval.
+ *
+ * @param[in,out] dev - device to reset
+ */
+static void resetValues(tDevice * dev) {
+	for (size_t i = 0; i < PROTO_MAX_CHANNELS; i++) {
+		tChannel * chan = dev->chan + i;
+		statsReset(&(chan->tempStats));
+		statsReset(&(chan->rhStats));
+		chan->summary = 0;
+		chan->intvlDue = 0;
+		if (dev->shm != NULL) shmPublishInterval(dev->shm + i, &(chan->tempStats), &(chan->rhStats));
+	}
+}
+
+
+/**
+ * Checks if any of the given channels has values within the current interval.
+ *
+ * @param[in] chan - PROTO_MAX_CHANNELS channels to check
+ * @return 1 if values are pending, else 0
+ */
+static int hasValues(const tChannel * chan) {
+	for (size_t i = 0; i < PROTO_MAX_CHANNELS; i++) {
+		if (chan[i].tempStats.count > 0) return 1;
+	}
+	return 0;
+}
+
+
+/**
+ * Outputs the statistics of the values of the given device if its update interval has passed or the remote
+ * device completed it. The interval starts with its first value and ends at a monotonic deadline which
+ * advances by whole intervals. This avoids a drift of the output times. Each channel with values is
+ * output separately in ascending order of the channel number. The output values are merged into the
+ * first rollup level, which is checked afterwards like the following ones.
+ *
+ * @param[in,out] dev - device to check
+ * @param[in] mono - current monotonic time in milliseconds
+ * @param[in] wall - current wall clock time in milliseconds since the epoch
+ * @return 1 on success, else 0
+ */
+static int processInterval(tDevice * dev, const int64_t mono, const int64_t wall) {
+	size_t i;
+	if (dev->intvlEnd == INT64_MAX) {
+		if (hasValues(dev->chan) == 0) return 1;
+		/* the intervals of all levels start together to end at common boundaries */
+		dev->intvlEnd = getFirstDeadline(&(dev->cfg), mono, wall);
+		for (i = 0; i < dev->rollupCount; i++) dev->rollup[i].intvlEnd = getFirstDeadline(&(dev->rollup[i].cfg), mono, wall);
+	}
+	/* output the first valid sample at once if only a single output is needed */
+	const int expired = (once != 0 || dev->intvlDue != 0 || mono >= dev->intvlEnd) ? 1 : 0;
+	int due = expired;
+	for (i = 0; i < PROTO_MAX_CHANNELS && due == 0; i++) due = dev->chan[i].intvlDue;
+	if (due != 0) {
+		tChannel * next = (dev->rollupCount > 0) ? dev->rollup[0].chan : NULL;
+		int written = 0;
+		for (i = 0; i < PROTO_MAX_CHANNELS; i++) {
+			tChannel * chan = dev->chan + i;
+			if (expired == 0 && chan->intvlDue == 0) continue;
+			chan->intvlDue = 0;
+			if (chan->tempStats.count == 0) continue;
+			if (outputChannel(dev, dev->out, &(dev->cfg), i, chan, (next != NULL) ? next + i : NULL, wall) == 0) return 0;
+			if (dev->shm != NULL) shmPublishInterval(dev->shm + i, &(chan->tempStats), &(chan->rhStats));
+			written = 1;
+		}
+		if (once != 0 && written != 0) dev->done = 1;
+		/* advance the deadline by whole intervals to keep the phase */
+		const int64_t period = (int64_t)(dev->cfg.intvl) * 1000;
+		if (period <= 0) {
+			dev->intvlEnd = mono;
+		} else if (mono >= dev->intvlEnd) {
+			dev->intvlEnd += (((mono - dev->intvlEnd) / period) + 1) * period;
+		}
+	}
+	for (i = 0; i < dev->rollupCount; i++) {
+		if (processRollup(dev, i, mono, wall) == 0) return 0;
+	}
+	dev->intvlDue = 0;
+	return 1;
+}
+
+
+/**
+ * Outputs the merged statistics of the given rollup level of the passed device if its interval has
+ * passed. The output values are merged into the next coarser level.
+ *
+ * @param[in,out] dev - device to check
+ * @param[in] level - index of the rollup level
+ * @param[in] mono - current monotonic time in milliseconds
+ * @param[in] wall - current wall clock time in milliseconds since the epoch
+ * @return 1 on success, else 0
+ */
+static int processRollup(tDevice * dev, const size_t level, const int64_t mono, const int64_t wall) {
+	tRollup * rollup = dev->rollup + level;
+	if (rollup->intvlEnd == INT64_MAX) return 1;
+	if (once == 0 && dev->intvlDue == 0 && mono < rollup->intvlEnd) return 1;
+	tChannel * next = ((level + 1) < dev->rollupCount) ? dev->rollup[level + 1].chan : NULL;
+	for (size_t i = 0; i < PROTO_MAX_CHANNELS; i++) {
+		tChannel * chan = rollup->chan + i;
+		if (chan->tempStats.count == 0) continue;
+		if (outputChannel(dev, rollup->out, &(rollup->cfg), i, chan, (next != NULL) ? next + i : NULL, wall) == 0) return 0;
+	}
+	const int64_t period = (int64_t)(rollup->cfg.intvl) * 1000;
+	if (mono >= rollup->intvlEnd) rollup->intvlEnd += (((mono - rollup->intvlEnd) / period) + 1) * period;
+	return 1;
+}
+
+
+/**
+ * Outputs the statistics of the given channel and starts its next interval. The statistics are
+ * merged into the passed channel of the next coarser level before.
+ *
+ * @param[in,out] dev - device of the channel
+ * @param[in,out] out - output file
+ * @param[in] cfg - data processing configuration of the level
+ * @param[in] channel - sensor channel number
+ * @param[in,out] chan - channel values to output
+ * @param[in,out] next - channel values of the next coarser level or NULL
+ * @param[in] wall - current wall clock time in milliseconds since the epoch
+ * @return 1 on success, else 0
+ */
+static int outputChannel(tDevice * dev, tOutput * out, const tConfig * cfg, const size_t channel, tChannel * chan, tChannel * next, const int64_t wall) {
+	/* the record belongs to the next file if the rotation is due */
+	if (rotateOutput(out, wall) == 0) return 0;
+	const uint64_t start = metClockUs();
+	int res;
+	if (out->format == OF_TEXT || out->format == OF_INFLUX) {
+		res = (printData(out->sink, cfg->prog, wall, cfg->utc, (unsigned int)channel, &(chan->tempStats), &(chan->rhStats)) < 0) ? 0 : 1;
+	} else {
+		const uint16_t flags = (uint16_t)(((chan->summary != 0) ? REC_FLAG_SUMMARY : 0) | REC_FLAG_CHANNEL(channel));
+		res = printRecord(out, wall, &(chan->tempStats), &(chan->rhStats), flags);
+	}
+	if (res == 0) {
+		if (verbose > 0) _ftprintf(ferr, MSGT(MSGT_ERR_FMT_WRITE));
+		return 0;
+	}
+	metHistAdd(&(dev->met.writeTime), metClockUs() - start);
+	MET_INC(&(dev->met.outputs));
+	dev->lineCount++;
+	if (next != NULL) {
+		statsMerge(&(next->tempStats), &(chan->tempStats));
+		statsMerge(&(next->rhStats), &(chan->rhStats));
+		if (chan->summary != 0) next->summary = 1;
+	}
+	/* reset values for next interval */
+	statsReset(&(chan->tempStats));
+	statsReset(&(chan->rhStats));
+	chan->summary = 0;
+	return 1;
+}
+
+
+/**
+ * Returns the monotonic end time of the first interval of the given level. The interval ends one
+ * period after the first value or at the next wall clock boundary which is a multiple of the period
+ * if the intervals are aligned. The boundaries are calculated in local time unless UTC output was
+ * selected. This way, an interval of 60 seconds ends at each full minute.
+ *
+ * @param[in] cfg - data processing configuration with the interval
+ * @param[in] mono - current monotonic time in milliseconds
+ * @param[in] wall - current wall clock time in milliseconds since the epoch
+ * @return monotonic end time in milliseconds
+ */
+static int64_t getFirstDeadline(const tConfig * cfg, const int64_t mono, const int64_t wall) {
+	const int64_t period = (int64_t)(cfg->intvl) * 1000;
+	if (period <= 0) return mono;
+	if (cfg->align == 0) return mono + period;
+	const int64_t local = wall + ((cfg->utc != 0) ? 0 : getUtcOffsetMs((time_t)(wall / 1000)));
+	int64_t rem = local % period;
+	if (rem < 0) rem += period;
+	return mono + (period - rem);
+}
+
+
+/**
+ * Replaces the output format string of the given configuration by one for the InfluxDB line
+ * protocol with the device path as tag. Spaces, commas and equal signs in the path are escaped for
+ * the line protocol and the result for the format string syntax.
+ *
+ * @param[in] name - UTF-8 encoded device path
+ * @param[in,out] cfg - data processing configuration to update
+ * @param[out] influxFmt - set to the generated format string which needs to be freed
+ * @return 1 on success, else 0
+ */
+static int setInfluxFormat(const char * name, tConfig * cfg, TCHAR ** influxFmt) {
+	if (name == NULL || cfg == NULL || influxFmt == NULL) return 0;
+	/* each character needs at most 4 characters after escaping */
+	char * tag = (char *)malloc((4 * strlen(name)) + 1);
+	if (tag == NULL) goto onNoMem;
+	char * out = tag;
+	for (const char * in = name; *in != 0; in++) {
+		switch (*in) {
+		case ' ':
+		case ',':
+		case '=':
+			*out++ = '\\';
+			*out++ = '\\';
+			break;
+		case '\\':
+			/* escaped for the line protocol and the format string */
+			*out++ = '\\';
+			*out++ = '\\';
+			*out++ = '\\';
+			break;
+		case '%':
+			*out++ = '%';
+			break;
+		default:
+			break;
+		}
+		*out++ = *in;
+	}
+	*out = 0;
+	TCHAR * ttag = _tfromUtf8(tag);
+	free(tag);
+	if (ttag == NULL) goto onNoMem;
+	const size_t size = _tcslen(INFLUX_FORMAT) + _tcslen(ttag) + 1;
+	*influxFmt = (TCHAR *)malloc(size * sizeof(TCHAR));
+	if (*influxFmt != NULL) _sntprintf(*influxFmt, size, INFLUX_FORMAT, ttag);
+	free(ttag);
+	if (*influxFmt == NULL) goto onNoMem;
+	cfg->fmt = *influxFmt;
+	return 1;
+onNoMem:
+	_ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
+	return 0;
+}
+
+
+/**
+ * Compiles the output format string of the given configuration. Errors are reported on ferr.
+ *
+ * @param[in,out] cfg - data processing configuration
+ * @return 1 on success, else 0
+ */
+static int compileFormat(tConfig * cfg) {
+	if (cfg == NULL) return 0;
+	cfg->prog = compileFormatString(cfg->fmt, FMTM_RECORD);
+	return (cfg->prog != NULL) ? 1 : 0;
+}
+
+
+/**
+ * Compiles the given format string. Errors are reported on ferr.
+ *
+ * @param[in] fmt - format string
+ * @param[in] mode - FMTM_RECORD for output records or FMTM_PATH for output file paths
+ * @return compiled format string or NULL on error
+ */
+static tFmtProg * compileFormatString(const TCHAR * fmt, const tFmtMode mode) {
+	tFmtError err;
+	size_t errPos;
+	tFmtProg * prog = fmtCompile(fmt, mode, &err, &errPos);
+	if (prog != NULL) return prog;
+	switch (err) {
+	case FMTE_NO_MEM:
+		_ftprintf(ferr, MSGT(MSGT_ERR_NO_MEM));
+		break;
+	case FMTE_OVERFLOW:
+		_ftprintf(ferr, MSGT(MSGT_ERR_FMT_OVERFLOW), (int)errPos, fmt, fmt + errPos);
+		break;
+	case FMTE_API:
+		_ftprintf(ferr, MSGT(MSGT_ERR_FMT_API), (int)errPos, fmt, fmt + errPos);
+		break;
+	case FMTE_VALUE:
+		_ftprintf(ferr, MSGT(MSGT_ERR_FMT_VALUE), (int)errPos, fmt, fmt + errPos);
+		break;
+	default:
+		_ftprintf(ferr, MSGT(MSGT_ERR_FMT_SYNTAX), (int)errPos, fmt, fmt + errPos);
+		break;
+	}
+	return NULL;
+}
+
+
+/**
+ * Outputs the given sensor data.
+ *
+ * @param[in,out] sink - output sink to write to
+ * @param[in,out] prog - compiled format string
+ * @param[in] timeMs - time reference in milliseconds since the epoch; also used for the flush policy
+ * @param[in] utc - non-zero to output the time in UTC, zero for local time
+ * @param[in] channel - sensor channel number
+ * @param[in] temp - temperature values in degrees Celsius
+ * @param[in] rh - relative humidity values in percent
+ * @return number of characters written or -1 on error
+ * @remarks see strftime() for valid time related format codes
+ */
+static int printData(tSink * sink, tFmtProg * prog, const int64_t timeMs, const int utc, const unsigned int channel, const tStats * temp, const tStats * rh) {
+	if (sink == NULL || prog == NULL) return -1;
+	const int res = fmtRun(prog, timeMs, utc, channel, temp, rh);
+	if (res <= 0) return res;
+	if (sinkWrite(sink, prog->out, (size_t)res, timeMs) == 0) return -1;
+	return res;
+}
+
+
+/**
+ * Outputs the given sensor data as binary record according to the output file format.
+ *
+ * @param[in,out] out - output file with a binary output file format
+ * @param[in] timeMs - end of the interval in milliseconds since the epoch; also used for the flush policy
+ * @param[in] temp - temperature values in degrees Celsius
+ * @param[in] rh - relative humidity values in percent
+ * @param[in] flags - record flags (REC_FLAG_*)
+ * @return 1 on success, else 0
+ */
+static int printRecord(tOutput * out, const int64_t timeMs, const tStats * temp, const tStats * rh, const uint16_t flags) {
+	if (out == NULL || out->sink == NULL) return 0;
+	tRecord rec;
+	recFromStats(&rec, timeMs, temp, rh, flags);
+	if (out->format == OF_BINARY) {
+		uint8_t buf[REC_SIZE];
+		recEncode(buf, &rec);
+		return sinkWriteRaw(out->sink, buf, sizeof(buf), timeMs);
+	}
+	if (out->block == NULL) return 0;
+	/* columnar blocks are written once complete */
+	if (recBlockAdd(out->block, &rec) == 0) return 1;
+	return flushBlock(out, timeMs);
+}
+
+
+/**
+ * Writes the columnar block of the given output file even if incomplete. Nothing is written if
+ * the block is empty.
+ *
+ * @param[in,out] out - output file
+ * @param[in] now - current time in milliseconds since the epoch for the flush policy
+ * @return 1 on success, else 0
+ */
+static int flushBlock(tOutput * out, const int64_t now) {
+	static uint8_t buf[REC_BLOCK_SIZE];
+	if (out == NULL || out->block == NULL || out->block->count == 0) return 1;
+	recBlockEncode(buf, out->block);
+	out->block->count = 0;
+	return sinkWriteRaw(out->sink, buf, sizeof(buf), now);
+}
+
+
+/**
+ * Returns the current time in milliseconds since 1970-01-01.
+ *
+ * @return current time in milliseconds
+ */
+static int64_t getTimeMs(void) {
+#if defined(PCF_IS_WIN)
+	FILETIME ft;
+	GetSystemTimeAsFileTime(&ft);
+	/* convert from 100 ns since 1601-01-01 to ms since 1970-01-01 */
+	return (int64_t)(((((uint64_t)ft.dwHighDateTime) << 32) | (uint64_t)ft.dwLowDateTime) / 10000) - INT64_C(11644473600000);
+#elif defined(PCF_IS_LINUX)
+	struct timespec ts;
+	if (clock_gettime(CLOCK_REALTIME, &ts) != 0) return (int64_t)time(NULL) * 1000;
+	return ((int64_t)(ts.tv_sec) * 1000) + (int64_t)(ts.tv_nsec / 1000000);
+#endif
+}
+
+
+/**
+ * Returns the current time of a monotonic clock in milliseconds. The clock is not affected by
+ * changes of the wall clock time and is only useful to measure time differences.
+ *
+ * @return current monotonic time in milliseconds
+ */
+static int64_t getMonoMs(void) {
+#if defined(PCF_IS_WIN)
+	static LARGE_INTEGER freq = {0};
+	LARGE_INTEGER count;
+	if (freq.QuadPart == 0 && QueryPerformanceFrequency(&freq) == 0) return (int64_t)GetTickCount64();
+	QueryPerformanceCounter(&count);
+	return (int64_t)((count.QuadPart / freq.QuadPart) * 1000 + ((count.QuadPart % freq.QuadPart) * 1000) / freq.QuadPart);
+#elif defined(PCF_IS_LINUX)
+	struct timespec ts;
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) return getTimeMs();
+	return ((int64_t)(ts.tv_sec) * 1000) + (int64_t)(ts.tv_nsec / 1000000);
+#endif
+}
+
+
+/**
+ * Returns the offset of the local time zone to UTC at the given time.
+ *
+ * @param[in] now - time to check
+ * @return offset in milliseconds which is added to UTC to get the local time
+ */
+static int64_t getUtcOffsetMs(const time_t now) {
+	struct tm * timeInfo = gmtime(&now);
+	if (timeInfo == NULL) return 0;
+	struct tm utc = *timeInfo;
+	/* let mktime() decide whether daylight saving time applies */
+	utc.tm_isdst = -1;
+	const time_t asLocal = mktime(&utc);
+	if (asLocal == (time_t)-1) return 0;
+	return (int64_t)difftime(now, asLocal) * 1000;
+}
+
+
+/**
+ * Returns the number of milliseconds until the given point in time.
+ *
+ * @param[in] deadline - point in time in milliseconds since the epoch
+ * @return milliseconds until deadline or 0 if it has already passed
+ */
+static size_t msUntil(const int64_t deadline) {
+	const int64_t diff = deadline - getTimeMs();
+	return (diff > 0) ? (size_t)diff : 0;
 }
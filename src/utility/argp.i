@@ -69,11 +69,13 @@
  * 
  * @param[in] p - prefix
  * @param[in] s - string
+ * @param[out] exact - set to non-zero if the prefix matches the whole string
  * @return pointer to the end of the prefix (after '=') or NULL on mismatch
  */
-static const CHAR_T * matchPrefixStr(const CHAR_T * p, const CHAR_T * s) {
+static const CHAR_T * matchPrefixStr(const CHAR_T * p, const CHAR_T * s, int * exact) {
 	if (*p == 0 || *p != *s) return NULL;
 	for (; *p == *s && *p != 0 && *p != '=' && *s != 0; p++, s++);
+	*exact = (*s == 0) ? 1 : 0;
 	if (*p == '=') return ++p;
 	if (*p == 0) return p;
 	return NULL;
@@ -300,13 +302,19 @@ onEndOfShortFlags:;
 			argType = no_argument;
 			sopt = NULL;
 			for (lopt = o->longOpts; lopt->name != NULL; lopt++) {
-				sopt = matchPrefixStr(opt, lopt->name);
+				int exact = 0;
+				sopt = matchPrefixStr(opt, lopt->name, &exact);
 				if (sopt != NULL) {
+					/* an exact match takes precedence over abbreviations of longer options */
+					if (exact != 0) {
+						result = -1;
+						o->arg = NULL;
+					}
 					o->opt = lopt->val;
 					o->longMatch = (int)(lopt - o->longOpts);
 					if (result != -1) {
 						found = -1;
-						break;
+						continue;
 					}
 					result = o->opt;
 					if (lopt->flag != NULL) {
@@ -316,6 +324,7 @@ onEndOfShortFlags:;
 					argType = lopt->has_arg;
 					if (*sopt != 0) o->arg = sopt;
 					found = 1;
+					if (exact != 0) break;
 				}
 			}
 			if (found == 1) {
@@ -0,0 +1,89 @@
+/**
+ * @file ring.c
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#include "ring.h"
+#include "target.h"
+
+
+/**
+ * Initializes the given ring buffer on the passed memory.
+ *
+ * @param[out] ring - ring buffer to initialize
+ * @param[in] buf - buffer memory (owned by the caller)
+ * @param[in] size - size of buf in bytes
+ */
+void ring_init(tRing * ring, uint8_t * buf, const size_t size) {
+	if (ring == NULL) return;
+	ring->buf = buf;
+	ring->size = (buf != NULL) ? size : 0;
+	ring->start = 0;
+	ring->used = 0;
+}
+
+
+/**
+ * Returns the next contiguous span of free space in the given ring buffer. A second span may
+ * follow at the start of the buffer after ring_commit().
+ *
+ * @param[in] ring - ring buffer
+ * @param[out] ptr - set to the start of the free span
+ * @return number of bytes in the free span (0 if full)
+ */
+size_t ring_space(const tRing * ring, uint8_t ** ptr) {
+	if (ring == NULL || ptr == NULL) return 0;
+	const size_t end = ring->start + ring->used;
+	if (end >= ring->size) {
+		*ptr = ring->buf + (end - ring->size);
+		return ring->size - ring->used;
+	}
+	*ptr = ring->buf + end;
+	return ring->size - end;
+}
+
+
+/**
+ * Marks the given number of bytes of the free span returned by ring_space() as written.
+ *
+ * @param[in,out] ring - ring buffer
+ * @param[in] size - number of bytes written
+ */
+void ring_commit(tRing * ring, const size_t size) {
+	if (ring == NULL) return;
+	ring->used += PCF_MIN(size, ring->size - ring->used);
+}
+
+
+/**
+ * Returns the next contiguous span of unread data in the given ring buffer. A second span may
+ * follow at the start of the buffer after ring_consume().
+ *
+ * @param[in] ring - ring buffer
+ * @param[out] ptr - set to the start of the data span
+ * @return number of bytes in the data span (0 if empty)
+ */
+size_t ring_data(const tRing * ring, const uint8_t ** ptr) {
+	if (ring == NULL || ptr == NULL) return 0;
+	*ptr = ring->buf + ring->start;
+	return PCF_MIN(ring->used, ring->size - ring->start);
+}
+
+
+/**
+ * Marks the given number of bytes of the data span returned by ring_data() as read. The buffer
+ * restarts at its beginning once empty to keep the free span as large as possible.
+ *
+ * @param[in,out] ring - ring buffer
+ * @param[in] size - number of bytes read
+ */
+void ring_consume(tRing * ring, const size_t size) {
+	if (ring == NULL) return;
+	const size_t len = PCF_MIN(size, ring->used);
+	ring->used -= len;
+	ring->start += len;
+	if (ring->start >= ring->size) ring->start -= ring->size;
+	if (ring->used == 0) ring->start = 0;
+}
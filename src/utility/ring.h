@@ -0,0 +1,44 @@
+/**
+ * @file ring.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ *
+ * Byte ring buffer on caller-owned memory. Data is written and read in place via contiguous
+ * spans of the buffer without copying.
+ */
+#ifndef __LIBPCF_RING_H__
+#define __LIBPCF_RING_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/** Byte ring buffer. */
+typedef struct tRing {
+	uint8_t * buf; /**< caller-owned buffer memory */
+	size_t size; /**< size of buf in bytes */
+	size_t start; /**< offset of the first unread byte within buf */
+	size_t used; /**< number of unread bytes */
+} tRing;
+
+
+void ring_init(tRing * ring, uint8_t * buf, const size_t size);
+size_t ring_space(const tRing * ring, uint8_t ** ptr);
+void ring_commit(tRing * ring, const size_t size);
+size_t ring_data(const tRing * ring, const uint8_t ** ptr);
+void ring_consume(tRing * ring, const size_t size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* __LIBPCF_RING_H__ */
@@ -3,7 +3,7 @@
  * @author Daniel Starke
  * @copyright Copyright 2019-2019 Daniel Starke
  * @date 2019-03-26
- * @version 2019-06-28
+ * @version 2026-10-14
  */
 #include <stdio.h>
 #include <string.h>
@@ -13,10 +13,15 @@
 #if defined(PCF_IS_WIN)
 #undef WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#include <dbt.h>
 
 
-/** Check of the serial interface device was removed every given milliseconds. */
-#define SER_CHECK_INTERVAL 100
+/** Window class name of the hidden window which receives the hot-plug notifications. */
+#define SER_HOTPLUG_CLASS "pcfSerHotplug"
+
+
+/** Device interface class of serial ports (GUID_DEVINTERFACE_COMPORT). */
+static const GUID ser_comPortGuid = {0x86E0D1E0, 0x8089, 0x11D0, {0x9C, 0xE4, 0x08, 0x00, 0x3E, 0x30, 0x1F, 0x73}};
 
 
 /**
@@ -30,10 +35,22 @@ struct tSerial {
 	tSerStatusLine status;
 	OVERLAPPED recvStruct[1];
 	OVERLAPPED sendStruct[1];
-	char * devPath;
-	HANDLE termEvent;
-	HANDLE checkThread;
-	volatile int removed;
+	DWORD commEvent; /**< event mask set by the asynchronous WaitCommEvent() */
+	int waitPending; /**< non-zero if WaitCommEvent() on recvStruct is still pending */
+	int rxLeft; /**< non-zero if the driver may still hold data which raised no new event */
+};
+
+
+/**
+ * Internal wakeup handle.
+ */
+struct tSerWakeup {
+	HANDLE event;
+	HANDLE thread; /**< thread receiving the hot-plug notifications or NULL */
+	DWORD threadId;
+	HANDLE ready; /**< set once the hot-plug thread registered for notifications */
+	int watching; /**< non-zero if the hot-plug thread registered successfully */
+	volatile LONG hotplug; /**< non-zero if a serial interface device was added */
 };
 
 
@@ -92,29 +109,68 @@ static int ser_fillConfig(DCB * config, const size_t speed, const tSerFraming fr
 
 
 /**
- * Background thread which checks if the serial interface device was removed.
+ * Window procedure of the hidden hot-plug notification window. Wakes up ser_wait() if a serial
+ * interface device was added.
  * 
- * @param[in] lpParam - lpParam - user data
- * @return 1 on success, else 0
+ * @param[in] hWnd - window handle
+ * @param[in] msg - message
+ * @param[in] wParam - message parameter
+ * @param[in] lParam - message parameter
+ * @return message result
  */
-static DWORD WINAPI ser_checkThread(LPVOID lpParam) {
-	tSerial * ser = (tSerial *)lpParam;
-	for (;;) {
-		SetLastError(0);
-		const HANDLE hnd = CreateFileA(ser->devPath, GENERIC_READ | GENERIC_WRITE, 0, 0, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, 0);
-		const DWORD err = GetLastError();
-		if (hnd != INVALID_HANDLE_VALUE) CloseHandle(hnd);
-		if (err == ERROR_FILE_NOT_FOUND) {
-			ser->removed = 1;
-			return 1;
-		}
-		switch (WaitForSingleObject(ser->termEvent, (DWORD)(SER_CHECK_INTERVAL))) {
-		case WAIT_OBJECT_0: return 1;
-		case WAIT_TIMEOUT: break;
-		default: return 0;
+static LRESULT CALLBACK ser_hotplugProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+	if (msg == WM_DEVICECHANGE && wParam == DBT_DEVICEARRIVAL) {
+		tSerWakeup * wakeup = (tSerWakeup *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
+		if (wakeup != NULL) {
+			InterlockedExchange(&(wakeup->hotplug), 1);
+			SetEvent(wakeup->event);
 		}
+		return TRUE;
 	}
-	return 0;
+	return DefWindowProcA(hWnd, msg, wParam, lParam);
+}
+
+
+/**
+ * Background thread which receives the serial interface device notifications. It blocks in
+ * GetMessage() until notifications arrive or ser_deleteWakeup() stops it.
+ * 
+ * @param[in,out] lpParam - wakeup handle
+ * @return 1 on success, else 0
+ */
+static DWORD WINAPI ser_hotplugThread(LPVOID lpParam) {
+	tSerWakeup * wakeup = (tSerWakeup *)lpParam;
+	const HINSTANCE instance = GetModuleHandle(NULL);
+	DEV_BROADCAST_DEVICEINTERFACE_A filter;
+	WNDCLASSA wc;
+	HDEVNOTIFY notify = NULL;
+	HWND hWnd = NULL;
+	MSG msg;
+	
+	memset(&wc, 0, sizeof(wc));
+	wc.lpfnWndProc = ser_hotplugProc;
+	wc.hInstance = instance;
+	wc.lpszClassName = SER_HOTPLUG_CLASS;
+	if (RegisterClassA(&wc) != 0 || GetLastError() == ERROR_CLASS_ALREADY_EXISTS) {
+		/* message-only windows receive registered device notifications but no broadcasts */
+		hWnd = CreateWindowExA(0, SER_HOTPLUG_CLASS, NULL, 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, instance, NULL);
+	}
+	if (hWnd != NULL) {
+		SetWindowLongPtr(hWnd, GWLP_USERDATA, (LONG_PTR)wakeup);
+		memset(&filter, 0, sizeof(filter));
+		filter.dbcc_size = sizeof(filter);
+		filter.dbcc_devicetype = DBT_DEVTYP_DEVICEINTERFACE;
+		filter.dbcc_classguid = ser_comPortGuid;
+		notify = RegisterDeviceNotificationA(hWnd, &filter, DEVICE_NOTIFY_WINDOW_HANDLE);
+	}
+	wakeup->watching = (notify != NULL) ? 1 : 0;
+	SetEvent(wakeup->ready);
+	if (notify != NULL) {
+		while (GetMessageA(&msg, NULL, 0, 0) > 0) DispatchMessageA(&msg);
+		UnregisterDeviceNotification(notify);
+	}
+	if (hWnd != NULL) DestroyWindow(hWnd);
+	return (notify != NULL) ? 1 : 0;
 }
 
 
@@ -129,6 +185,7 @@ static DWORD WINAPI ser_checkThread(LPVOID lpParam) {
  */
 tSerial * ser_create(const char * device, const size_t speed, const tSerFraming framing, const tSerFlowCtrl flow) {
 	size_t devPathLen;
+	char * devPath;
 	DCB params = { 0 };
 	COMMTIMEOUTS tout = { 0 };
 	if (device == NULL) return NULL;
@@ -138,11 +195,12 @@ tSerial * ser_create(const char * device, const size_t speed, const tSerFraming
 	res->port = INVALID_HANDLE_VALUE;
 	
 	devPathLen = strlen(device) + 5;
-	res->devPath = (char *)malloc(devPathLen * sizeof(char));
-	if (res->devPath == NULL) goto onError;
-	snprintf(res->devPath, devPathLen, "\\\\.\\%s", device);
+	devPath = (char *)malloc(devPathLen * sizeof(char));
+	if (devPath == NULL) goto onError;
+	snprintf(devPath, devPathLen, "\\\\.\\%s", device);
 	
-	res->port = CreateFileA(res->devPath, GENERIC_READ | GENERIC_WRITE, 0, 0, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, 0);
+	res->port = CreateFileA(devPath, GENERIC_READ | GENERIC_WRITE, 0, 0, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, 0);
+	free(devPath);
 	if (res->port == INVALID_HANDLE_VALUE) goto onError;
 	
 	if (ser_fillConfig(&params, speed, framing, flow) == 0) goto onError;
@@ -154,20 +212,19 @@ tSerial * ser_create(const char * device, const size_t speed, const tSerFraming
 	tout.WriteTotalTimeoutConstant = 0;
 	tout.WriteTotalTimeoutMultiplier = 0;
 	if (SetCommTimeouts(res->port, &tout) == 0) goto onError;
+	/* the event mask persists; setting it again would cancel a pending WaitCommEvent() */
+	if (SetCommMask(res->port, EV_RXCHAR) == 0) goto onError;
 	
 	res->speed = speed;
 	res->framing = framing;
 	res->flow = flow;
 	res->status = (tSerStatusLine)(SL_RTS | SL_DTR);
+	res->rxLeft = 1; /* data may have been received before the event mask was set */
 	ser_getLines(res);
 	res->recvStruct->hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
 	if (res->recvStruct->hEvent == NULL) goto onError;
 	res->sendStruct->hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
 	if (res->sendStruct->hEvent == NULL) goto onError;
-	res->termEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
-	if (res->termEvent == NULL) goto onError;
-	res->checkThread = CreateThread(NULL, 0, ser_checkThread, (LPVOID)res, 0, NULL);
-	if (res->checkThread == NULL) goto onError;
 	
 	return res;
 onError:
@@ -186,7 +243,7 @@ onError:
  * @return 1 on success, else 0
  */
 int ser_setConfig(tSerial * ser, const size_t speed, const tSerFraming framing, const tSerFlowCtrl flow) {
-	if (ser == NULL || ser->removed != 0) return 0;
+	if (ser == NULL) return 0;
 	if (ser->speed == speed && ser->framing == framing && ser->flow == flow) return 1;
 	DCB params = { 0 };
 	int res = 0;
@@ -214,7 +271,7 @@ onError:
  */
 tSerStatusLine ser_getLines(tSerial * ser) {
 	DWORD status;
-	if (ser == NULL || ser->removed != 0) return (tSerStatusLine)0;
+	if (ser == NULL) return (tSerStatusLine)0;
 	ser->status = (tSerStatusLine)(ser->status & (SL_RTS | SL_DTR));
 	if (GetCommModemStatus(ser->port, &status) != 0) {
 		if ((status & MS_CTS_ON)  != 0) ser->status |= SL_CTS;
@@ -236,7 +293,7 @@ tSerStatusLine ser_getLines(tSerial * ser) {
  * @return 1 on success, else 0
  */
 int ser_setLines(tSerial * ser, const tSerStatusLine status) {
-	if (ser == NULL || ser->removed != 0) return 0;
+	if (ser == NULL) return 0;
 	
 	/* update RTS on change */
 	if (((ser->status ^ status) & SL_RTS) != 0) {
@@ -255,76 +312,162 @@ int ser_setLines(tSerial * ser, const tSerStatusLine status) {
 
 
 /**
- * Reads a chunk of data from the given serial interface to the passed buffer.
+ * Reads the data available without waiting to the given buffer.
  * 
  * @param[in,out] ser - serial interface context
  * @param[out] buf - received serial data chunk
- * @param[in] size - received serial data chunk size
- * @param[in] timeout - timeout in milliseconds
- * @return number of bytes written, -1 on error, -2 on timeout
+ * @param[in] size - size of buf in bytes
+ * @return number of bytes read or -1 on error
  */
-ssize_t ser_read(tSerial * ser, uint8_t * buf, const size_t size, const size_t timeout) {
-	if (ser == NULL || ser->removed != 0 || buf == NULL) return -1;
-	if (size == 0) return 0;
-	COMSTAT comStat = { 0 };
-	DWORD dwErrorFlags = 0;
-	DWORD dwCommEvent = 0;
+static ssize_t ser_readAvailable(tSerial * ser, uint8_t * buf, const size_t size) {
 	DWORD dwRead = 0;
+	ResetEvent(ser->recvStruct->hEvent);
+	if (ReadFile(ser->port, buf, (DWORD)PCF_MIN(size, (size_t)MAXDWORD), &dwRead, ser->recvStruct) == 0) {
+		if (GetLastError() != ERROR_IO_PENDING) return -1; /* abort */
+		/* completes at once due to the read timeouts set in ser_create() */
+		if (GetOverlappedResult(ser->port, ser->recvStruct, &dwRead, TRUE) == 0) {
+			return -1; /* overlapping error */
+		}
+	}
+	return (ssize_t)dwRead;
+}
+
+
+/**
+ * Reads all data available from the given serial interface to the free space of the passed
+ * ring buffer. Waits for new data up to the given timeout if none is available. The OVERLAPPED
+ * structure and a pending WaitCommEvent() from ser_wait() are reused across calls.
+ * 
+ * @param[in,out] ser - serial interface context
+ * @param[in,out] ring - receives the serial data
+ * @param[in] timeout - timeout in milliseconds
+ * @return number of bytes added to ring (0 if ring is full), -1 on error, -2 on timeout
+ */
+ssize_t ser_readRing(tSerial * ser, tRing * ring, const size_t timeout) {
+	if (ser == NULL || ring == NULL) return -1;
 	const DWORD start = timeGetTime();
-	size_t diff;
-	size_t tout = timeout;
+	ssize_t total = 0;
+	uint8_t * ptr;
+	size_t space, diff;
 	
-	do {
-		ResetEvent(ser->recvStruct->hEvent);
-		ClearCommError(ser->port, &dwErrorFlags, &comStat);
-		/* we need to set the mask before every wait */
-		if (SetCommMask(ser->port, EV_RXCHAR) == 0) return -1;
-		if (comStat.cbInQue <= 0) {
-			/* wait for serial data */
-			if (WaitCommEvent(ser->port, &dwCommEvent, ser->recvStruct) == 0) {
-				if (GetLastError() != ERROR_IO_PENDING) return -1; /* abort */
-				switch (WaitForSingleObject(ser->recvStruct->hEvent, (DWORD)tout)) {
-				case WAIT_OBJECT_0:
-					break;
-				case WAIT_TIMEOUT:
-					goto onTimeout;
-				default:
-					return -1;
-				}
-				if (GetOverlappedResult(ser->port, ser->recvStruct, &dwCommEvent, TRUE) == 0) {
-					return -1; /* overlapping error */
-				}
-			}
-			if ((dwCommEvent & EV_RXCHAR) == 0) {
-				/* an event different from our event mask triggered -> try again */
-				goto onNoEvent;
-			}
-		}
-   	 
-		/* read serial data */
-		ResetEvent(ser->recvStruct->hEvent);
-		if (ReadFile(ser->port, buf, (DWORD)size, &dwRead, ser->recvStruct) == 0) {
-			if (GetLastError() != ERROR_IO_PENDING) return -1; /* abort */
-			switch (WaitForSingleObject(ser->recvStruct->hEvent, (DWORD)tout)) {
+	for (;;) {
+		if (ser->waitPending != 0) {
+			diff = (size_t)(timeGetTime() - start);
+			switch (WaitForSingleObject(ser->recvStruct->hEvent, (DWORD)((diff < timeout) ? (timeout - diff) : 0))) {
 			case WAIT_OBJECT_0:
 				break;
 			case WAIT_TIMEOUT:
-				goto onTimeout;
+				/* keep the pending wait for the next call */
+				return -2;
 			default:
 				return -1;
 			}
-			if (GetOverlappedResult(ser->port, ser->recvStruct, &dwRead, TRUE) == 0) {
+			ser->waitPending = 0;
+			if (GetOverlappedResult(ser->port, ser->recvStruct, &(ser->commEvent), TRUE) == 0) {
 				return -1; /* overlapping error */
 			}
 		}
-onNoEvent:
+		
+		/* drain the receive buffer of the driver */
+		while ((space = ring_space(ring, &ptr)) > 0) {
+			const ssize_t len = ser_readAvailable(ser, ptr, space);
+			if (len < 0) return (total > 0) ? total : -1;
+			ring_commit(ring, (size_t)len);
+			total += len;
+			if ((size_t)len < space) break;
+		}
+		/* a full ring may leave data in the driver whose event was already consumed */
+		ser->rxLeft = (space == 0);
+		if (total > 0 || space == 0) return total;
+		
 		diff = (size_t)(timeGetTime() - start);
-		tout = (diff < timeout) ? (size_t)(timeout - diff) : 0;
-	} while (dwRead <= 0 && tout > 0);
+		if (diff >= timeout) return -2; /* timeout */
+		/* wait for serial data; events from already read data only cause another read attempt */
+		ResetEvent(ser->recvStruct->hEvent);
+		if (WaitCommEvent(ser->port, &(ser->commEvent), ser->recvStruct) == 0) {
+			if (GetLastError() != ERROR_IO_PENDING) return -1; /* abort */
+			ser->waitPending = 1;
+		}
+	}
+}
+
+
+/**
+ * Waits until at least one of the given serial interfaces has data available for reading.
+ * Interfaces with pending data are marked with a non-zero value in ready. Subsequent calls to
+ * ser_read() for these return without blocking.
+ * 
+ * @param[in,out] ser - list of serial interface contexts (NULL entries are ignored)
+ * @param[in] count - number of elements in ser (at most SER_WAIT_MAX)
+ * @param[out] ready - set to non-zero for each ready serial interface (count elements)
+ * @param[in,out] wakeup - returns early if ser_wakeup() was called for this handle or a serial
+ * interface device was added after ser_watchHotplug() (optional)
+ * @param[in] timeout - timeout in milliseconds or SER_INFINITE
+ * @return number of ready serial interfaces (0 if woken up), -1 on error, -2 on timeout
+ * @remarks An infinite wait without any serial interface and wakeup handle fails at once.
+ */
+int ser_wait(tSerial ** ser, const size_t count, uint8_t * ready, tSerWakeup * wakeup, const size_t timeout) {
+	if (ser == NULL || ready == NULL || count > SER_WAIT_MAX) return -1;
+	HANDLE events[SER_WAIT_MAX + 1];
+	size_t index[SER_WAIT_MAX];
+	const DWORD tout = (timeout == SER_INFINITE) ? INFINITE : (DWORD)PCF_MIN(timeout, (size_t)(INFINITE - 1));
+	DWORD res;
+	size_t i, n = 0;
+	int found = 0;
+	
+	/*
+	 * Start asynchronous waits for all interfaces without pending data. EV_RXCHAR is also raised
+	 * for data received after the last WaitCommEvent() completed, so the queue length only needs
+	 * to be considered if the last read stopped early.
+	 */
+	for (i = 0; i < count; i++) {
+		tSerial * s = ser[i];
+		ready[i] = 0;
+		if (s == NULL) continue;
+		if (s->waitPending == 0) {
+			if (s->rxLeft != 0) {
+				ready[i] = 1;
+				found++;
+				continue;
+			}
+			ResetEvent(s->recvStruct->hEvent);
+			if (WaitCommEvent(s->port, &(s->commEvent), s->recvStruct) != 0) {
+				ready[i] = 1;
+				found++;
+				continue;
+			}
+			if (GetLastError() != ERROR_IO_PENDING) return -1; /* abort */
+			s->waitPending = 1;
+		}
+		events[n] = s->recvStruct->hEvent;
+		index[n] = i;
+		n++;
+	}
+	if (found > 0) return found;
+	if (wakeup != NULL) events[n] = wakeup->event;
+	if (n == 0 && wakeup == NULL) {
+		/* nothing could end an infinite wait */
+		if (tout == INFINITE) return -1;
+		Sleep(tout);
+		return -2; /* timeout */
+	}
 	
-onTimeout:
-	if (dwRead > 0) return (ssize_t)dwRead;
-	return -2; /* timeout */
+	/* wait for any of the pending events */
+	res = WaitForMultipleObjects((DWORD)((wakeup != NULL) ? n + 1 : n), events, FALSE, tout);
+	if (res == WAIT_TIMEOUT) return -2; /* timeout */
+	if (res == (WAIT_OBJECT_0 + n) && wakeup != NULL) return 0; /* woken up */
+	if (res >= (WAIT_OBJECT_0 + n)) return -1;
+	
+	/* collect all completed events */
+	for (i = 0; i < n; i++) {
+		tSerial * s = ser[index[i]];
+		if (WaitForSingleObject(events[i], 0) != WAIT_OBJECT_0) continue;
+		s->waitPending = 0;
+		if (GetOverlappedResult(s->port, s->recvStruct, &(s->commEvent), TRUE) == 0) return -1;
+		ready[index[i]] = 1;
+		found++;
+	}
+	return (found > 0) ? found : -2;
 }
 
 
@@ -338,7 +481,7 @@ onTimeout:
  * @return number of bytes written, -1 on error, -2 on timeout
  */
 ssize_t ser_write(tSerial * ser, const uint8_t * buf, const size_t size, const size_t timeout) {
-	if (ser == NULL || ser->removed != 0 || buf == NULL) return -1;
+	if (ser == NULL || buf == NULL) return -1;
 	if (size == 0) return 0;
 	size_t rem = size;
 	DWORD dwWritten;
@@ -380,7 +523,7 @@ onError:
  * @return 1 on success, else 0
  */
 int ser_clear(tSerial * ser) {
-	if (ser == NULL || ser->removed != 0) return 0;
+	if (ser == NULL) return 0;
 	ClearCommError(ser->port, NULL, NULL);
 	return (PurgeComm(ser->port, PURGE_RXCLEAR | PURGE_TXCLEAR) != 0) ? 1 : 0;
 }
@@ -393,29 +536,128 @@ int ser_clear(tSerial * ser) {
  */
 void ser_delete(tSerial * ser) {
 	if (ser == NULL) return;
-	if (ser->checkThread != NULL) {
-		if (ser->termEvent != NULL) SetEvent(ser->termEvent);
-		WaitForSingleObject(ser->checkThread, INFINITE);
-		CloseHandle(ser->checkThread);
+	if (ser->port != INVALID_HANDLE_VALUE) {
+		/* complete a pending WaitCommEvent() before its OVERLAPPED structure is freed */
+		if (ser->waitPending != 0) {
+			CancelIo(ser->port);
+			GetOverlappedResult(ser->port, ser->recvStruct, &(ser->commEvent), TRUE);
+		}
+		CloseHandle(ser->port);
 	}
-	if (ser->port != INVALID_HANDLE_VALUE) CloseHandle(ser->port);
 	if (ser->recvStruct->hEvent != NULL) CloseHandle(ser->recvStruct->hEvent);
 	if (ser->sendStruct->hEvent != NULL) CloseHandle(ser->sendStruct->hEvent);
-	if (ser->devPath != NULL) free(ser->devPath);
-	if (ser->termEvent != NULL) CloseHandle(ser->termEvent);
 	free(ser);
 }
 
 
+/**
+ * Creates a new wakeup handle which can be passed to ser_wait().
+ * 
+ * @return Handle on success, else NULL.
+ */
+tSerWakeup * ser_createWakeup(void) {
+	tSerWakeup * res = (tSerWakeup *)calloc(1, sizeof(tSerWakeup));
+	if (res == NULL) return NULL;
+	/* auto-reset to consume the wakeup within ser_wait() */
+	res->event = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (res->event == NULL) {
+		free(res);
+		return NULL;
+	}
+	return res;
+}
+
+
+/**
+ * Wakes up the ser_wait() call which uses the given handle. A call without a waiting ser_wait()
+ * lets the next ser_wait() call return immediately. This function may be called from a signal
+ * handler.
+ * 
+ * @param[in,out] wakeup - wakeup handle
+ * @return 1 on success, else 0
+ */
+int ser_wakeup(tSerWakeup * wakeup) {
+	if (wakeup == NULL) return 0;
+	return (SetEvent(wakeup->event) != 0) ? 1 : 0;
+}
+
+
+/**
+ * Frees the given wakeup handle. The handle is invalid after this call.
+ * 
+ * @param[in,out] wakeup - handle to free
+ */
+void ser_deleteWakeup(tSerWakeup * wakeup) {
+	if (wakeup == NULL) return;
+	if (wakeup->thread != NULL) {
+		PostThreadMessageA(wakeup->threadId, WM_QUIT, 0, 0);
+		WaitForSingleObject(wakeup->thread, INFINITE);
+		CloseHandle(wakeup->thread);
+	}
+	if (wakeup->ready != NULL) CloseHandle(wakeup->ready);
+	if (wakeup->event != NULL) CloseHandle(wakeup->event);
+	free(wakeup);
+}
+
+
+/**
+ * Enables the serial interface device notifications for the given wakeup handle. ser_wait()
+ * returns as woken up if a serial interface device was added. The notifications are received
+ * via RegisterDeviceNotification() by a thread which blocks until one arrives.
+ * 
+ * @param[in,out] wakeup - wakeup handle
+ * @return 1 on success, else 0
+ */
+int ser_watchHotplug(tSerWakeup * wakeup) {
+	if (wakeup == NULL) return 0;
+	if (wakeup->thread != NULL) return wakeup->watching;
+	wakeup->ready = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (wakeup->ready == NULL) return 0;
+	wakeup->thread = CreateThread(NULL, 0, ser_hotplugThread, (LPVOID)wakeup, 0, &(wakeup->threadId));
+	if (wakeup->thread == NULL) return 0;
+	WaitForSingleObject(wakeup->ready, INFINITE);
+	if (wakeup->watching == 0) {
+		WaitForSingleObject(wakeup->thread, INFINITE);
+		CloseHandle(wakeup->thread);
+		wakeup->thread = NULL;
+	}
+	return wakeup->watching;
+}
+
+
+/**
+ * Checks whether a serial interface device was added since the last call. Needs
+ * ser_watchHotplug() to be called first.
+ * 
+ * @param[in,out] wakeup - wakeup handle
+ * @return 1 if a serial interface device was added, else 0
+ */
+int ser_hotplugPending(tSerWakeup * wakeup) {
+	if (wakeup == NULL) return 0;
+	return (InterlockedExchange(&(wakeup->hotplug), 0) != 0) ? 1 : 0;
+}
+
+
 #elif defined(PCF_IS_LINUX) /**********************************************************************/
+#include <errno.h>
 #include <fcntl.h> 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <termios.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <poll.h>
 #include <sys/time.h>
 #include <sys/select.h>
+#ifdef __linux__
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#endif /* __linux__ */
+
+
+/** Receive buffer size for a single kernel device event message in bytes. */
+#define SER_UEVENT_SIZE 4096
 
 
 /**
@@ -431,6 +673,40 @@ struct tSerial {
 };
 
 
+/**
+ * Internal wakeup handle.
+ */
+struct tSerWakeup {
+	int pipe[2]; /**< self-pipe with non-blocking read and write end */
+	int uevent; /**< non-blocking kernel device event socket or -1 */
+	int hotplug; /**< non-zero if a serial interface device was added */
+};
+
+
+#ifdef __linux__
+/**
+ * Receives all pending kernel device events of the given wakeup handle. The hot-plug flag is set
+ * if a tty device was added.
+ * 
+ * @param[in,out] wakeup - wakeup handle with kernel device event socket
+ */
+static void ser_receiveUevents(tSerWakeup * wakeup) {
+	char buf[SER_UEVENT_SIZE];
+	ssize_t len;
+	while ((len = recv(wakeup->uevent, buf, sizeof(buf) - 1, 0)) > 0) {
+		int added = 0, tty = 0;
+		buf[len] = 0;
+		/* the message consists of null-terminated KEY=value strings after the header */
+		for (size_t i = 0; i < (size_t)len; i += strlen(buf + i) + 1) {
+			if (strcmp(buf + i, "ACTION=add") == 0) added = 1;
+			if (strcmp(buf + i, "SUBSYSTEM=tty") == 0) tty = 1;
+		}
+		if (added != 0 && tty != 0) wakeup->hotplug = 1;
+	}
+}
+#endif /* __linux__ */
+
+
 /**
  * Fills the given termios structure with the passed configuration settings.
  * 
@@ -449,7 +725,9 @@ static int ser_fillConfig(struct termios * config, const size_t speed, const tSe
 	config->c_iflag = IGNBRK | INPCK;
 	config->c_lflag = 0;
 	config->c_oflag = 0;
-	config->c_cc[VMIN] = 0;
+	/* read() returns the available bytes at once on the non-blocking descriptor; VMIN 1 lets it
+	 * fail with EAGAIN if there are none and return 0 only if the device was closed */
+	config->c_cc[VMIN] = 1;
 	config->c_cc[VTIME] = 0;
 	config->c_cflag = HUPCL | CREAD | data[framing] | parity[framing] | stop[framing];
 	
@@ -618,10 +896,14 @@ int ser_setConfig(tSerial * ser, const size_t speed, const tSerFraming framing,
 	if (ser == NULL) return 0;
 	if (ser->speed == speed && ser->framing == framing && ser->flow == flow) return 1;
 	
+	if (tcgetattr(ser->port, &settings) != 0) return 0;
 	if (ser_fillConfig(&settings, speed, framing, flow) != 1) return 0;
 	tcflush(ser->port, TCIFLUSH);
 	if (tcsetattr(ser->port, TCSANOW, &settings) != 0) return 0;
 	
+	ser->speed = speed;
+	ser->framing = framing;
+	ser->flow = flow;
 	return 1;
 }
 
@@ -675,39 +957,125 @@ int ser_setLines(tSerial * ser, const tSerStatusLine status) {
 
 
 /**
- * Reads a chunk of data from the given serial interface to the passed buffer.
+ * Reads all data available from the given serial interface to the free space of the passed
+ * ring buffer. Waits for new data up to the given timeout if none is available.
  * 
  * @param[in,out] ser - serial interface context
- * @param[out] buf - received serial data chunk
- * @param[in] size - received serial data chunk size
+ * @param[in,out] ring - receives the serial data
  * @param[in] timeout - timeout in milliseconds
- * @return number of bytes written, -1 on error, -2 on timeout
+ * @return number of bytes added to ring (0 if ring is full), -1 on error, -2 on timeout
  */
-ssize_t ser_read(tSerial * ser, uint8_t * buf, const size_t size, const size_t timeout) {
-	if (ser == NULL || buf == NULL) return -1;
-	if (size == 0) return 0;
-	ssize_t received = 0;
-	struct timeval tout;
-	fd_set fds;
-	int sRes;
+ssize_t ser_readRing(tSerial * ser, tRing * ring, const size_t timeout) {
+	if (ser == NULL || ring == NULL) return -1;
+	struct pollfd pfd;
+	ssize_t total = 0;
+	uint8_t * ptr;
+	size_t space;
+	int waited = 0;
 	
-	FD_ZERO(&fds);
-	FD_SET(ser->port, &fds);
-	tout.tv_sec = (time_t)(timeout / 1000);
-	tout.tv_usec = (suseconds_t)((timeout % 1000) * 1000);
+	for (;;) {
+		/* drain the receive buffer of the driver */
+		while ((space = ring_space(ring, &ptr)) > 0) {
+			const ssize_t len = read(ser->port, ptr, space);
+			if (len < 0) {
+				if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+				return (total > 0) ? total : -1;
+			}
+			/* device was closed */
+			if (len == 0) return (total > 0) ? total : -1;
+			ring_commit(ring, (size_t)len);
+			total += len;
+			if ((size_t)len < space) break;
+		}
+		if (total > 0 || space == 0) return total;
+		if (waited != 0) return -2; /* timeout */
+		
+		/* wait for serial data */
+		pfd.fd = ser->port;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		const int pRes = poll(&pfd, 1, (int)PCF_MIN(timeout, (size_t)INT_MAX));
+		if (pRes < 0) return -1;
+		if (pRes == 0) return -2; /* timeout */
+		waited = 1;
+	}
+}
+
+
+/**
+ * Waits until at least one of the given serial interfaces has data available for reading.
+ * Interfaces with pending data are marked with a non-zero value in ready. Subsequent calls to
+ * ser_read() for these return without blocking.
+ * 
+ * @param[in,out] ser - list of serial interface contexts (NULL entries are ignored)
+ * @param[in] count - number of elements in ser (at most SER_WAIT_MAX)
+ * @param[out] ready - set to non-zero for each ready serial interface (count elements)
+ * @param[in,out] wakeup - returns early if ser_wakeup() was called for this handle or a serial
+ * interface device was added after ser_watchHotplug() (optional)
+ * @param[in] timeout - timeout in milliseconds or SER_INFINITE
+ * @return number of ready serial interfaces (0 if woken up), -1 on error, -2 on timeout
+ * @remarks An infinite wait without any serial interface and wakeup handle fails at once.
+ */
+int ser_wait(tSerial ** ser, const size_t count, uint8_t * ready, tSerWakeup * wakeup, const size_t timeout) {
+	if (ser == NULL || ready == NULL || count > SER_WAIT_MAX) return -1;
+	struct pollfd fds[SER_WAIT_MAX + 1];
+	size_t index[SER_WAIT_MAX];
+	const int tout = (timeout == SER_INFINITE) ? -1 : (int)PCF_MIN(timeout, (size_t)INT_MAX);
+	nfds_t n = 0;
+	int found = 0;
+	int pRes;
+	
+	for (size_t i = 0; i < count; i++) {
+		ready[i] = 0;
+		if (ser[i] == NULL) continue;
+		fds[n].fd = ser[i]->port;
+		fds[n].events = POLLIN;
+		fds[n].revents = 0;
+		index[n] = i;
+		n++;
+	}
+	
+	nfds_t extra = 0;
+	if (wakeup != NULL) {
+		fds[n].fd = wakeup->pipe[0];
+		fds[n].events = POLLIN;
+		fds[n].revents = 0;
+		extra++;
+		if (wakeup->uevent >= 0) {
+			fds[n + 1].fd = wakeup->uevent;
+			fds[n + 1].events = POLLIN;
+			fds[n + 1].revents = 0;
+			extra++;
+		}
+	}
+	
+	/* nothing could end an infinite wait */
+	if ((n + extra) == 0 && tout < 0) return -1;
 	
 	/* wait for serial data */
-	sRes = select(ser->port + 1, &fds, NULL, NULL, &tout);
-	if (sRes < 0) {
+	pRes = poll(fds, n + extra, tout);
+	if (pRes < 0) {
 		return -1;
-	} else if (sRes == 0 || FD_ISSET(ser->port, &fds) == 0) {
+	} else if (pRes == 0) {
 		return -2;
 	}
-   	
-	/* read serial data */
-	received = read(ser->port, buf, size);
-	if (received <= 0) return -1;
-	return received;
+	
+	/* consume all pending wakeups */
+	if (wakeup != NULL && fds[n].revents != 0) {
+		char buf[16];
+		while (read(wakeup->pipe[0], buf, sizeof(buf)) > 0);
+	}
+#ifdef __linux__
+	if (extra > 1 && fds[n + 1].revents != 0) ser_receiveUevents(wakeup);
+#endif /* __linux__ */
+	
+	/* errors and hang-ups are reported as ready to fail in ser_read() */
+	for (nfds_t i = 0; i < n; i++) {
+		if (fds[i].revents == 0) continue;
+		ready[index[i]] = 1;
+		found++;
+	}
+	return found;
 }
 
 
@@ -781,6 +1149,129 @@ void ser_delete(tSerial * ser) {
 	}
 	free(ser);
 }
+
+
+/**
+ * Creates a new wakeup handle which can be passed to ser_wait().
+ * 
+ * @return Handle on success, else NULL.
+ */
+tSerWakeup * ser_createWakeup(void) {
+	tSerWakeup * res = (tSerWakeup *)calloc(1, sizeof(tSerWakeup));
+	if (res == NULL) return NULL;
+	res->pipe[0] = -1;
+	res->pipe[1] = -1;
+	res->uevent = -1;
+	if (pipe(res->pipe) != 0) goto onError;
+	for (int i = 0; i < 2; i++) {
+		const int flags = fcntl(res->pipe[i], F_GETFL);
+		if (flags == -1 || fcntl(res->pipe[i], F_SETFL, flags | O_NONBLOCK) == -1) goto onError;
+		if (fcntl(res->pipe[i], F_SETFD, FD_CLOEXEC) == -1) goto onError;
+	}
+	return res;
+onError:
+	ser_deleteWakeup(res);
+	return NULL;
+}
+
+
+/**
+ * Wakes up the ser_wait() call which uses the given handle. A call without a waiting ser_wait()
+ * lets the next ser_wait() call return immediately. This function may be called from a signal
+ * handler.
+ * 
+ * @param[in,out] wakeup - wakeup handle
+ * @return 1 on success, else 0
+ */
+int ser_wakeup(tSerWakeup * wakeup) {
+	if (wakeup == NULL) return 0;
+	const int oldErrno = errno;
+	const char c = 0;
+	int res = 1;
+	/* a full pipe already guarantees a wakeup */
+	if (write(wakeup->pipe[1], &c, 1) != 1 && errno != EAGAIN && errno != EWOULDBLOCK) res = 0;
+	errno = oldErrno;
+	return res;
+}
+
+
+/**
+ * Frees the given wakeup handle. The handle is invalid after this call.
+ * 
+ * @param[in,out] wakeup - handle to free
+ */
+void ser_deleteWakeup(tSerWakeup * wakeup) {
+	if (wakeup == NULL) return;
+	if (wakeup->pipe[0] >= 0) close(wakeup->pipe[0]);
+	if (wakeup->pipe[1] >= 0) close(wakeup->pipe[1]);
+	if (wakeup->uevent >= 0) close(wakeup->uevent);
+	free(wakeup);
+}
+
+
+/**
+ * Enables the serial interface device notifications for the given wakeup handle. ser_wait()
+ * returns as woken up if a serial interface device was added. The kernel device events are
+ * received via netlink. Only supported on Linux.
+ * 
+ * @param[in,out] wakeup - wakeup handle
+ * @return 1 on success, else 0
+ */
+int ser_watchHotplug(tSerWakeup * wakeup) {
+	if (wakeup == NULL) return 0;
+	if (wakeup->uevent >= 0) return 1;
+#ifdef __linux__
+	struct sockaddr_nl addr;
+	const int fd = socket(AF_NETLINK, SOCK_DGRAM, NETLINK_KOBJECT_UEVENT);
+	if (fd < 0) return 0;
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_pid = 0;
+	addr.nl_groups = 1; /* kernel events; does not depend on udev */
+	const int flags = fcntl(fd, F_GETFL);
+	if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1 || fcntl(fd, F_SETFD, FD_CLOEXEC) == -1 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		close(fd);
+		return 0;
+	}
+	wakeup->uevent = fd;
+	return 1;
+#else /* not __linux__ */
+	return 0;
+#endif /* __linux__ */
+}
+
+
+/**
+ * Checks whether a serial interface device was added since the last call. Needs
+ * ser_watchHotplug() to be called first.
+ * 
+ * @param[in,out] wakeup - wakeup handle
+ * @return 1 if a serial interface device was added, else 0
+ */
+int ser_hotplugPending(tSerWakeup * wakeup) {
+	if (wakeup == NULL || wakeup->hotplug == 0) return 0;
+	wakeup->hotplug = 0;
+	return 1;
+}
 #else /* not PCF_IS_WIN and not PCF_IS_LINUX */
 #error Unsupported target OS.
 #endif
+
+
+/**
+ * Reads a chunk of data from the given serial interface to the passed buffer.
+ * 
+ * @param[in,out] ser - serial interface context
+ * @param[out] buf - received serial data chunk
+ * @param[in] size - received serial data chunk size
+ * @param[in] timeout - timeout in milliseconds
+ * @return number of bytes written, -1 on error, -2 on timeout
+ * @see ser_readRing()
+ */
+ssize_t ser_read(tSerial * ser, uint8_t * buf, const size_t size, const size_t timeout) {
+	tRing ring;
+	if (ser == NULL || buf == NULL) return -1;
+	if (size == 0) return 0;
+	ring_init(&ring, buf, size);
+	return ser_readRing(ser, &ring, timeout);
+}
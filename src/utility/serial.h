@@ -3,13 +3,14 @@
  * @author Daniel Starke
  * @copyright Copyright 2019-2019 Daniel Starke
  * @date 2019-03-26
- * @version 2019-03-31
+ * @version 2026-10-14
  */
 #ifndef __LIBPCF_SERIAL_H__
 #define __LIBPCF_SERIAL_H__
 
 #include <stddef.h>
 #include <stdint.h>
+#include "ring.h"
 #include "target.h"
 #ifdef PCF_IS_LINUX
 #include <sys/types.h>
@@ -63,20 +64,41 @@ typedef enum {
 } tSerStatusLine;
 
 
+/** Maximum number of serial interfaces which can be passed to ser_wait(). */
+#define SER_WAIT_MAX 63
+
+
+/** Timeout value for ser_wait() to wait without time limit. */
+#define SER_INFINITE ((size_t)-1)
+
+
 /**
  * @internal target specific
  */
 typedef struct tSerial tSerial;
 
 
+/**
+ * @internal target specific
+ */
+typedef struct tSerWakeup tSerWakeup;
+
+
 tSerial * ser_create(const char * device, const size_t speed, const tSerFraming framing, const tSerFlowCtrl flow);
 int ser_setConfig(tSerial * ser, const size_t speed, const tSerFraming framing, const tSerFlowCtrl flow);
 tSerStatusLine ser_getLines(tSerial * ser);
 int ser_setLines(tSerial * ser, const tSerStatusLine status);
 ssize_t ser_read(tSerial * ser, uint8_t * buf, const size_t size, const size_t timeout);
+ssize_t ser_readRing(tSerial * ser, tRing * ring, const size_t timeout);
+int ser_wait(tSerial ** ser, const size_t count, uint8_t * ready, tSerWakeup * wakeup, const size_t timeout);
 ssize_t ser_write(tSerial * ser, const uint8_t * buf, const size_t size, const size_t timeout);
 int ser_clear(tSerial * ser);
 void ser_delete(tSerial * ser);
+tSerWakeup * ser_createWakeup(void);
+int ser_wakeup(tSerWakeup * wakeup);
+void ser_deleteWakeup(tSerWakeup * wakeup);
+int ser_watchHotplug(tSerWakeup * wakeup);
+int ser_hotplugPending(tSerWakeup * wakeup);
 
 
 #ifdef __cplusplus
@@ -0,0 +1,334 @@
+/**
+ * @file thread.c
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#include <stdlib.h>
+#include "thread.h"
+#include "target.h"
+
+#if defined(PCF_IS_WIN)
+#undef WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+
+/**
+ * Internal thread handle.
+ */
+struct tThread {
+	HANDLE handle;
+	tThrFunc func;
+	void * arg;
+	int result;
+};
+
+
+/**
+ * Internal event handle.
+ */
+struct tThrEvent {
+	HANDLE event;
+};
+
+
+/**
+ * Calls the thread entry point of the given thread handle.
+ *
+ * @param[in,out] param - thread handle
+ * @return always 0
+ */
+static DWORD WINAPI thr_main(LPVOID param) {
+	tThread * thread = (tThread *)param;
+	thread->result = thread->func(thread->arg);
+	return 0;
+}
+
+
+/**
+ * Creates and starts a new thread.
+ *
+ * @param[in] func - thread entry point
+ * @param[in] arg - argument passed to func
+ * @return Handle on success, else NULL.
+ */
+tThread * thr_create(tThrFunc func, void * arg) {
+	if (func == NULL) return NULL;
+	tThread * res = (tThread *)calloc(1, sizeof(tThread));
+	if (res == NULL) return NULL;
+	res->func = func;
+	res->arg = arg;
+	res->handle = CreateThread(NULL, 0, thr_main, res, 0, NULL);
+	if (res->handle == NULL) {
+		free(res);
+		return NULL;
+	}
+	return res;
+}
+
+
+/**
+ * Waits for the given thread to finish and frees its handle. The handle is invalid after this
+ * call.
+ *
+ * @param[in,out] thread - thread handle
+ * @return result of the thread entry point or -1 on error
+ */
+int thr_join(tThread * thread) {
+	if (thread == NULL) return -1;
+	const int res = (WaitForSingleObject(thread->handle, INFINITE) == WAIT_OBJECT_0) ? thread->result : -1;
+	CloseHandle(thread->handle);
+	free(thread);
+	return res;
+}
+
+
+/**
+ * Suspends the calling thread for the given time.
+ *
+ * @param[in] ms - time to sleep in milliseconds
+ */
+void thr_sleep(const size_t ms) {
+	Sleep((DWORD)ms);
+}
+
+
+/**
+ * Creates a new auto-reset event.
+ *
+ * @return Handle on success, else NULL.
+ */
+tThrEvent * thr_createEvent(void) {
+	tThrEvent * res = (tThrEvent *)calloc(1, sizeof(tThrEvent));
+	if (res == NULL) return NULL;
+	res->event = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (res->event == NULL) {
+		free(res);
+		return NULL;
+	}
+	return res;
+}
+
+
+/**
+ * Sets the given event. A call without a waiting thr_wait() lets the next thr_wait() call return
+ * immediately.
+ *
+ * @param[in,out] event - event handle
+ * @return 1 on success, else 0
+ */
+int thr_signal(tThrEvent * event) {
+	if (event == NULL) return 0;
+	return (SetEvent(event->event) != 0) ? 1 : 0;
+}
+
+
+/**
+ * Waits until the given event is set or the timeout elapsed. The event is reset afterwards.
+ *
+ * @param[in,out] event - event handle
+ * @param[in] timeout - timeout in milliseconds or THR_INFINITE
+ * @return 1 if the event was set, 0 on timeout or -1 on error
+ */
+int thr_wait(tThrEvent * event, const size_t timeout) {
+	if (event == NULL) return -1;
+	const DWORD ms = (timeout == THR_INFINITE) ? INFINITE : (DWORD)PCF_MIN(timeout, (size_t)(INFINITE - 1));
+	switch (WaitForSingleObject(event->event, ms)) {
+	case WAIT_OBJECT_0: return 1;
+	case WAIT_TIMEOUT: return 0;
+	default: return -1;
+	}
+}
+
+
+/**
+ * Frees the given event handle. The handle is invalid after this call.
+ *
+ * @param[in,out] event - handle to free
+ */
+void thr_deleteEvent(tThrEvent * event) {
+	if (event == NULL) return;
+	if (event->event != NULL) CloseHandle(event->event);
+	free(event);
+}
+
+
+#elif defined(PCF_IS_LINUX) /**********************************************************************/
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+
+/**
+ * Internal thread handle.
+ */
+struct tThread {
+	pthread_t handle;
+	tThrFunc func;
+	void * arg;
+	int result;
+};
+
+
+/**
+ * Internal event handle.
+ */
+struct tThrEvent {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond; /**< uses CLOCK_MONOTONIC for timeouts */
+	int set; /**< non-zero if the event is set */
+};
+
+
+/**
+ * Calls the thread entry point of the given thread handle.
+ *
+ * @param[in,out] param - thread handle
+ * @return always NULL
+ */
+static void * thr_main(void * param) {
+	tThread * thread = (tThread *)param;
+	thread->result = thread->func(thread->arg);
+	return NULL;
+}
+
+
+/**
+ * Creates and starts a new thread.
+ *
+ * @param[in] func - thread entry point
+ * @param[in] arg - argument passed to func
+ * @return Handle on success, else NULL.
+ */
+tThread * thr_create(tThrFunc func, void * arg) {
+	if (func == NULL) return NULL;
+	tThread * res = (tThread *)calloc(1, sizeof(tThread));
+	if (res == NULL) return NULL;
+	res->func = func;
+	res->arg = arg;
+	if (pthread_create(&(res->handle), NULL, thr_main, res) != 0) {
+		free(res);
+		return NULL;
+	}
+	return res;
+}
+
+
+/**
+ * Waits for the given thread to finish and frees its handle. The handle is invalid after this
+ * call.
+ *
+ * @param[in,out] thread - thread handle
+ * @return result of the thread entry point or -1 on error
+ */
+int thr_join(tThread * thread) {
+	if (thread == NULL) return -1;
+	const int res = (pthread_join(thread->handle, NULL) == 0) ? thread->result : -1;
+	free(thread);
+	return res;
+}
+
+
+/**
+ * Suspends the calling thread for the given time.
+ *
+ * @param[in] ms - time to sleep in milliseconds
+ */
+void thr_sleep(const size_t ms) {
+	struct timespec ts;
+	ts.tv_sec = (time_t)(ms / 1000);
+	ts.tv_nsec = (long)((ms % 1000) * 1000000);
+	while (nanosleep(&ts, &ts) != 0 && errno == EINTR);
+}
+
+
+/**
+ * Creates a new auto-reset event.
+ *
+ * @return Handle on success, else NULL.
+ */
+tThrEvent * thr_createEvent(void) {
+	pthread_condattr_t attr;
+	tThrEvent * res = (tThrEvent *)calloc(1, sizeof(tThrEvent));
+	if (res == NULL) return NULL;
+	if (pthread_condattr_init(&attr) != 0) goto onError;
+	const int ok = (pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0 && pthread_cond_init(&(res->cond), &attr) == 0) ? 1 : 0;
+	pthread_condattr_destroy(&attr);
+	if (ok == 0) goto onError;
+	if (pthread_mutex_init(&(res->mutex), NULL) != 0) {
+		pthread_cond_destroy(&(res->cond));
+		goto onError;
+	}
+	return res;
+onError:
+	free(res);
+	return NULL;
+}
+
+
+/**
+ * Sets the given event. A call without a waiting thr_wait() lets the next thr_wait() call return
+ * immediately.
+ *
+ * @param[in,out] event - event handle
+ * @return 1 on success, else 0
+ */
+int thr_signal(tThrEvent * event) {
+	if (event == NULL || pthread_mutex_lock(&(event->mutex)) != 0) return 0;
+	event->set = 1;
+	pthread_cond_signal(&(event->cond));
+	pthread_mutex_unlock(&(event->mutex));
+	return 1;
+}
+
+
+/**
+ * Waits until the given event is set or the timeout elapsed. The event is reset afterwards.
+ *
+ * @param[in,out] event - event handle
+ * @param[in] timeout - timeout in milliseconds or THR_INFINITE
+ * @return 1 if the event was set, 0 on timeout or -1 on error
+ */
+int thr_wait(tThrEvent * event, const size_t timeout) {
+	struct timespec ts;
+	int res = 0;
+	if (event == NULL) return -1;
+	if (timeout != THR_INFINITE) {
+		if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) return -1;
+		const size_t ms = PCF_MIN(timeout, (size_t)86400000);
+		ts.tv_sec += (time_t)(ms / 1000);
+		ts.tv_nsec += (long)((ms % 1000) * 1000000);
+		if (ts.tv_nsec >= 1000000000) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000;
+		}
+	}
+	if (pthread_mutex_lock(&(event->mutex)) != 0) return -1;
+	while (event->set == 0 && res == 0) {
+		res = (timeout == THR_INFINITE) ? pthread_cond_wait(&(event->cond), &(event->mutex)) : pthread_cond_timedwait(&(event->cond), &(event->mutex), &ts);
+	}
+	const int set = event->set;
+	event->set = 0;
+	pthread_mutex_unlock(&(event->mutex));
+	if (set != 0) return 1;
+	return (res == ETIMEDOUT) ? 0 : -1;
+}
+
+
+/**
+ * Frees the given event handle. The handle is invalid after this call.
+ *
+ * @param[in,out] event - handle to free
+ */
+void thr_deleteEvent(tThrEvent * event) {
+	if (event == NULL) return;
+	pthread_cond_destroy(&(event->cond));
+	pthread_mutex_destroy(&(event->mutex));
+	free(event);
+}
+
+
+#else /* not PCF_IS_WIN and not PCF_IS_LINUX */
+#error Unsupported target OS.
+#endif
@@ -0,0 +1,77 @@
+/**
+ * @file thread.h
+ * @author Daniel Starke
+ * @copyright Copyright 2026 Daniel Starke
+ * @date 2026-10-14
+ * @version 2026-10-14
+ */
+#ifndef __LIBPCF_THREAD_H__
+#define __LIBPCF_THREAD_H__
+
+#include <stddef.h>
+#include "target.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/** Timeout value for thr_wait() to wait without time limit. */
+#define THR_INFINITE ((size_t)-1)
+
+
+/** Atomically loads the given value with acquire semantics. */
+#define THR_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+
+
+/** Atomically stores the given value with release semantics. */
+#define THR_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+
+/**
+ * Atomically replaces the value at p with v if it equals *e. *e is set to the current value
+ * otherwise. Evaluates to non-zero on success.
+ */
+#define THR_CAS(p, e, v) __atomic_compare_exchange_n((p), (e), (v), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+
+
+/** Atomically adds v to the value at p. */
+#define THR_ADD(p, v) __atomic_add_fetch((p), (v), __ATOMIC_RELAXED)
+
+
+/** Full memory barrier between preceding and following loads and stores. */
+#define THR_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+
+/** Thread entry point. */
+typedef int (* tThrFunc)(void * arg);
+
+
+/**
+ * @internal target specific
+ */
+typedef struct tThread tThread;
+
+
+/**
+ * @internal target specific
+ */
+typedef struct tThrEvent tThrEvent;
+
+
+tThread * thr_create(tThrFunc func, void * arg);
+int thr_join(tThread * thread);
+void thr_sleep(const size_t ms);
+tThrEvent * thr_createEvent(void);
+int thr_signal(tThrEvent * event);
+int thr_wait(tThrEvent * event, const size_t timeout);
+void thr_deleteEvent(tThrEvent * event);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* __LIBPCF_THREAD_H__ */